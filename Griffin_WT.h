@@ -9,16 +9,24 @@
 #include <atomic>
 #include <mutex>
 
-#include "src/griffinwave5/BaseVoiceState.cpp"
 #include "src/griffinwave5/BaseVoiceState.h"
 #include "src/griffinwave5/rspl.hpp"
-#include "src/griffinwave5/InterpPack.cpp"
 #include "src/griffinwave5/InterpPack.h"
 #include "src/griffinwave5/MipMapFlt.hpp"
-#include "src/griffinwave5/ResamplerFlt.cpp"
 #include "src/griffinwave5/ResamplerFlt.h"
 #include "src/griffinwave5/Wave.h"
 #include "src/griffinwave5/AsyncMipBuilder.h"
+#include "src/griffinwave5/SvfBank.h"
+#include "src/griffinwave5/VoiceEngine.h"
+#include "src/griffinwave5/VoicePool.h"
+#include "src/griffinwave5/VoiceBudget.h"
+#include "src/griffinwave5/CpuGovernor.h"
+#include "src/griffinwave5/Denormals.h"
+#include "src/griffinwave5/Trace.h"
+
+#if !defined(GW5_CORE_LIBRARY)
+#include "src/griffinwave5/CoreUnity.cpp"
+#endif
 
 namespace project
 {
@@ -45,32 +53,10 @@ namespace project
     /*  SHARED DEFAULT WAVE  ONE PER PROCESS                                */
     /* --------------------------------------------------------------------- */
 
-    namespace
-    {
-        inline const std::shared_ptr<const gw5::MipMapFlt>& builtinMip()
-        {
-            static std::shared_ptr<const gw5::MipMapFlt> s = [] {
-                constexpr int FRAME_SIZE = 2048;
-                constexpr int MAX_FRAMES = 256;
-                constexpr int PADDED = FRAME_SIZE * 3;
-                constexpr int TOTAL_LEN = MAX_FRAMES * PADDED;
-
-                auto mp = std::make_shared<gw5::MipMapFlt>();
-                mp->init_sample(TOTAL_LEN,
-                    gw5::InterpPack::get_len_pre(),
-                    gw5::InterpPack::get_len_post(),
-                    12,
-                    gw5::ResamplerFlt::_fir_mip_map_coef_arr,
-                    gw5::ResamplerFlt::MIP_MAP_FIR_LEN);
-                mp->fill_sample(wavetable, TOTAL_LEN);
-                return mp;
-                }();
-            return s;
-        }
-    }
+    using gw5::builtinMip;
 
     /* --------------------------------------------------------------------- */
-    /*  ONE RESAMPLER LANE                                                   */
+    /*  ONE RESAMPLER LANE (lent to a voice by the node's VoicePool)         */
     /* --------------------------------------------------------------------- */
 
     struct Lane
@@ -80,12 +66,24 @@ namespace project
         bool              active = false;
     };
 
+    /* --------------------------------------------------------------------- */
+    /*  GLOBAL CABLES                                                        */
+    /* --------------------------------------------------------------------- */
+
+    // HISE cannot take a latency from a scriptnode node: the project script
+    // forwards this cable to Engine.setLatencySamples()
+    enum class WtCables
+    {
+        cbl_wt_latency = 0  // lookahead latency out (samples)
+    };
+    using wt_cable_manager_t = routing::global_cable_cpp_manager<SN_GLOBAL_CABLE(1840014638)>;
+
     /* --------------------------------------------------------------------- */
     /*  MAIN NODE                                                            */
     /* --------------------------------------------------------------------- */
 
     template <int NV>
-    struct Griffin_WT : public data::base
+    struct Griffin_WT : public data::base, public wt_cable_manager_t
     {
         SNEX_NODE(Griffin_WT);
         struct MetadataClass { SN_NODE_ID("Griffin_WT"); };
@@ -94,10 +92,16 @@ namespace project
         static constexpr int FRAME_SIZE = 2048;
         static constexpr int PADDED = FRAME_SIZE * 3;
         static constexpr int SLICE = 8;
+        static constexpr int LONG_SLICE = 32;      // control slice under CPU pressure
+        static constexpr int STEAL_LEN = 64;       // fade-out of a stolen voice
+        static constexpr int ENGINE_BLOCK = 256;   // samples per VoiceEngine batch
         static constexpr int FADE_LEN = gw5::BaseVoiceState::FADE_LEN;
         static constexpr int BITS_OCT = gw5::BaseVoiceState::NBR_BITS_PER_OCT;
         static constexpr double TARGET_ROOT_HZ = 32.703195;
         static constexpr double SEMI2BITS = double(1 << BITS_OCT) / 12.0;
+        static constexpr int MAX_LANES = NV * 4;       // every voice crossfading both oscillators
+        static constexpr int DEFAULT_LANES = NV * 2;   // every voice crossfading one oscillator,
+                                                       // or playing both; voices stay at NV
 
         static constexpr bool isModNode() { return false; }
         static constexpr bool isPolyphonic() { return NV > 1; }
@@ -117,7 +121,10 @@ namespace project
 
         struct VoicePack
         {
-            Lane   A, B;
+            Lane*  A = nullptr;                  // from the pool, held only while needed
+            Lane*  B = nullptr;
+            Lane*  A2 = nullptr;                 // second oscillator, paired with A / B
+            Lane*  B2 = nullptr;
             int    pitchBits = 0;
             double semiOff = 0.0;
             double multOff = 1.0;
@@ -130,6 +137,9 @@ namespace project
             int    midi = -1;
             float  vel = 1.0f;
             bool   active = false;
+            float  level = 0.0f;                 // output peak of the last block
+            float  stealGain = 0.0f;             // > 0 while a stolen voice fades out
+            int    ticket = gw5::VoiceBudget::NO_TICKET;   // place in the shared budget
 
             // glide state
             double glideCurBits = 0.0;
@@ -138,11 +148,15 @@ namespace project
 
             static constexpr float fadeDelta() { return 1.0f / float(FADE_LEN); }
 
+            /* the lanes stay held; the node returns them on its next block */
             void clear()
             {
-                A.active = B.active = active = false;
+                for (Lane* l : { A, B, A2, B2 })
+                    if (l != nullptr) l->active = false;
+                active = false;
                 fading = toggle = pendFlag = false;
                 fadeAlpha = 1.0f;
+                level = stealGain = 0.0f;
                 glideCurBits = 0.0;
                 glideStepBitsPerSample = 0.0;
                 glideSamplesRemaining = 0;
@@ -166,7 +180,31 @@ namespace project
         /*  PUBLIC API                                                       */
         /* ----------------------------------------------------------------- */
 
-        void reset() { for (auto& v : voices) v.clear(); }
+        void reset()
+        {
+            gw5::VoiceEngine::instance().finish(ahead);
+            aheadN = 0;
+            for (auto& v : voices) v.clear();
+        }
+
+        /* bytes owned by this instance (resampler lanes); tables are shared */
+        int64 getMemoryBytes() const
+        {
+            int64 bytes = 0;
+            lanes.forEach([&](const Lane& l) { bytes += l.res.get_mem_bytes(); });
+            bytes += slots.getMemBytes() + ahead.slots.getMemBytes()
+                + int64((aheadL.capacity() + aheadR.capacity()) * sizeof(float));
+            return bytes;
+        }
+
+        /* the process-wide default table, shared by every instance */
+        static int64 getBuiltinTableBytes() { return builtinMip()->get_mem_bytes(); }
+
+        ~Griffin_WT()
+        {
+            gw5::VoiceEngine::instance().detach(ahead);
+            for (auto& v : voices) releaseVoice(v);
+        }
 
         Griffin_WT()
             : globalVolume(0.8f),
@@ -184,12 +222,29 @@ namespace project
             sr = spec.sampleRate;
             lastSpecs = spec;
             haveSpecs = true;
+            perVoice = (NV > 1 && spec.voiceIndex != nullptr);
 
             rootOffSemis = 12.0 * std::log2(TARGET_ROOT_HZ / (sr / double(FRAME_SIZE)));
+            fmIn.assign(size_t(jmax(spec.blockSize, SLICE)), 0.0f);
+            svf.setSampleRate(sr);
+            governor.prepare(sr);
+            GW5_TRACE_RESERVE(1);           // for the host's audio thread, which never registers
+            gw5::VoiceEngine::instance().prepare(slots, NV, ENGINE_BLOCK);
+            gw5::VoiceEngine::instance().finish(ahead);
+            aheadL.assign(size_t(spec.blockSize), 0.0f);
+            aheadR.assign(size_t(spec.blockSize), 0.0f);
+            aheadN = 0;
+            attachAhead();                  // always: the Lookahead switch must not allocate
+            sendLatency();
 
             for (int f = 0; f < MAX_FRAMES; ++f)
                 frameStart[f] = gw5::Int64(f) * PADDED + FRAME_SIZE;
 
+            interp.set_kernel_set(lowLatency ? gw5::InterpPack::KernelSet_SHORT
+                                             : gw5::InterpPack::KernelSet_LINEAR);
+            for (auto& v : voices) releaseVoice(v);
+            lanes.prepare(laneCeiling);
+            lanes.forEach([this](Lane& l) { initLane(l); });
             voices.prepare(lastSpecs);
             for (auto& v : voices) initVoice(v);
 
@@ -199,20 +254,34 @@ namespace project
         void handleHiseEvent(HiseEvent& e)
         {
             if (!ready) return;
+            gw5::VoiceEngine::instance().finish(ahead);
 
             if (e.isNoteOn())
             {
                 auto& vp = voices.get();
+                releaseVoice(vp);               // slot reused before the last block returned it
                 vp.reset(e.getNoteNumber(),
                     e.getFloatVelocity(),
                     globalFrame,
                     paramSemi,
                     paramMult);
 
-                vp.A.res.set_sample_sp(_activeMip); vp.A.res.clear_buffers();
-                vp.B.res.set_sample_sp(_activeMip); vp.B.res.clear_buffers();
+                // the lane pool at its ceiling, or refused by the shared
+                // budget: the note is dropped (counted in the stats). The
+                // lane comes first, so a budget steal only ever makes room
+                // for a note that will play
+                vp.A = acquireLane();
+                if (vp.A != nullptr && budgetVoices > 0)
+                    vp.ticket = gw5::VoiceBudget::instance().acquire(this, budgetPriority);
+                if (vp.A == nullptr || vp.ticket == gw5::VoiceBudget::REFUSED)
+                {
+                    vp.clear();
+                    releaseVoice(vp);
+                    return;
+                }
 
                 updatePitch(vp);
+                svf.resetVoice(voices.getVoiceIndexForData(vp));
 
                 if (paramGlideOn)
                 {
@@ -241,29 +310,42 @@ namespace project
                 gw5::Int64 randIp = gw5::Int64(rand32) % maxR;
                 gw5::Int64 pos = ((frameStart[vp.frameParam] + randIp) << 32) | gw5::Int64(rand32);
 
-                vp.A.res.set_playback_pos(pos);
-                vp.A.frameIdx = vp.frameParam;
-                vp.A.active = true;
+                vp.A->res.set_playback_pos(pos);
+                vp.A->res.set_sync_reset_pos(frameStart[vp.frameParam] << 32);
+                vp.A->res.set_sync_phase(0);
+                vp.A->res.set_fm_cycle(frameStart[vp.frameParam] << 32, cycle);
+                vp.A->frameIdx = vp.frameParam;
+                vp.A->active = true;
+
+                if (osc2Level > 0.0f && (vp.A2 = acquireLane()) != nullptr)
+                    startLane(*vp.A2, *vp.A, osc2FrameOf(vp.frameParam), vp.pitchBits);
             }
         }
 
         template <typename PD>
         void process(PD& d)
         {
+            GW5_TRACE_SCOPE("Griffin_WT::process");
+            gw5::ScopedNoDenormals noDenormals;
+            gw5::JobPool::instance().noteAudioCore();
+            gw5::VoiceEngine::instance().noteAudioThread();
+
+            auto& engine = gw5::VoiceEngine::instance();
+            if (engine.isPending(ahead)) engine.finish(ahead);
+
             if (auto mp = gw5::AsyncMipBuilder::instance().current();
                 mp && mp->is_ready() && mp.get() != _activeMip.get())
             {
                 _activeMip = mp;
+                lanes.forEach([this](Lane& l)       // idle lanes too: none keeps the old table alive
+                    {
+                        l.res.set_sample_sp(_activeMip);
+                        l.res.clear_buffers();
+                    });
                 for (auto& v : voices)
-                {
-                    v.A.res.set_sample_sp(_activeMip); v.A.res.clear_buffers();
-                    v.B.res.set_sample_sp(_activeMip); v.B.res.clear_buffers();
                     if (v.active)
-                    {
-                        v.A.res.set_pitch(v.pitchBits);
-                        v.B.res.set_pitch(v.pitchBits);
-                    }
-                }
+                        for (Lane* l : { v.A, v.B, v.A2, v.B2 })
+                            if (l != nullptr) l->res.set_pitch(v.pitchBits);
             }
 
             if (!ready) return;
@@ -272,84 +354,53 @@ namespace project
             float* L = blk.getChannelPointer(0);
             float* R = blk.getChannelPointer(1);
             const int N = d.getNumSamples();
-            std::fill(L, L + N, 0.0f);
 
-            for (int base = 0; base < N; base += SLICE)
-            {
-                const int len = jmin(SLICE, N - base);
-                std::fill(mixBuf, mixBuf + len, 0.0f);
+            beginBlock(L, N);
 
-                for (auto& vp : voices)
+            // lookahead: this call plays the block rendered during the last
+            // one and leaves the next to a helper until the next callback
+            if (isAhead() && N <= int(aheadL.size()))
+            {
+                if (aheadN == N)
                 {
-                    if (!vp.active) continue;
-                    if (vp.pendFlag) switchFrame(vp);
-
-                    if (paramGlideOn)
-                    {
-                        if (vp.glideSamplesRemaining > 0)
-                        {
-                            int adv = jmin(vp.glideSamplesRemaining, len);
-                            vp.glideCurBits += vp.glideStepBitsPerSample * adv;
-                            vp.glideSamplesRemaining -= adv;
-                            if (vp.glideSamplesRemaining <= 0)
-                            {
-                                const double glideSemis = std::log2(paramGlideTarget) * 12.0;
-                                vp.glideCurBits = glideSemis * SEMI2BITS;
-                                vp.glideSamplesRemaining = 0;
-                            }
-                        }
-                    }
-                    else if (vp.glideCurBits != 0.0)
-                    {
-                        vp.glideCurBits = 0.0;
-                        vp.glideSamplesRemaining = 0;
-                    }
+                    std::copy(aheadL.begin(), aheadL.begin() + N, L);
+                    std::copy(aheadR.begin(), aheadR.begin() + N, R);
+                }
+                else
+                {
+                    std::fill(L, L + N, 0.0f);
+                    std::fill(R, R + N, 0.0f);
+                }
+                aheadN = N;
+                engine.post(ahead);
+                return;
+            }
 
-                    int offsetBits = int(std::lround(vp.glideCurBits));
-                    Lane& cur = vp.toggle ? vp.B : vp.A;
-                    cur.res.set_pitch(vp.pitchBits + offsetBits);
-                    cur.res.set_playback_pos(wrap(vp.frameParam, cur.res.get_playback_pos()));
-                    cur.res.interpolate_block(laneBuf, len);
+            aheadN = 0;
+            renderBlock(L, R, N, slots);
+        }
 
-                    if (vp.fading)
-                    {
-                        Lane& prev = vp.toggle ? vp.A : vp.B;
-                        prev.res.set_pitch(vp.pitchBits + offsetBits);
-                        prev.res.set_playback_pos(
-                            wrap(vp.frameParam, prev.res.get_playback_pos()));
-                        prev.res.interpolate_block(prevBuf, len);
-
-                        float a = vp.fadeAlpha;
-                        FloatVectorOperations::multiply(laneBuf, a, len);
-                        FloatVectorOperations::addWithMultiply(
-                            laneBuf, prevBuf, 1.0f - a, len);
-                    }
+        /* load, level, overloads and steals of the CPU governor; any thread */
+        gw5::CpuGovernor::Stats getGovernorStats() const noexcept { return governor.getStats(); }
 
-                    FloatVectorOperations::add(mixBuf, laneBuf, len);
+        /* ceiling, use and refusals of the lane pool; audio thread, or while
+           the node is not processing */
+        gw5::VoicePool<Lane>::Stats getLanePoolStats() const noexcept { return lanes.getStats(); }
 
-                    if (vp.fading)
-                    {
-                        vp.fadeAlpha += VoicePack::fadeDelta() * len;
-                        if (vp.fadeAlpha >= 1.0f)
-                        {
-                            vp.fading = false;
-                            (vp.toggle ? vp.A : vp.B).active = false;
-                        }
-                    }
-                }
+        /* the process-wide voice budget, all instances together; any thread */
+        static gw5::VoiceBudget::Stats getBudgetStats() noexcept { return gw5::VoiceBudget::instance().getStats(); }
 
-                FloatVectorOperations::add(L + base, mixBuf, len);
-            }
-
-            FloatVectorOperations::multiply(L, globalVolume, N);
-            FloatVectorOperations::copy(R, L, N);
-        }
+        /* latency added by the lookahead mode: one prepared block; also sent
+           on cbl_wt_latency */
+        int getLatencySamples() const noexcept { return isAhead() ? lastSpecs.blockSize : 0; }
 
         /* ===== parameters ===== */
 
         template <int P>
         void setParameter(double v)
         {
+            gw5::VoiceEngine::instance().finish(ahead);
+
             if constexpr (P == 1) // Frame select
             {
                 globalFrame = jlimit(0, MAX_FRAMES - 1, int(v));
@@ -454,6 +505,86 @@ namespace project
                     }
                 }
             }
+            else if constexpr (P == 8) // Sync
+            {
+                syncBits = int(std::lround(jmax(0.0, v) * SEMI2BITS));
+            }
+            else if constexpr (P == 9) // FM Depth
+            {
+                fmDepth = float(v);
+            }
+            else if constexpr (P == 10) // Osc2 Level
+            {
+                osc2Level = float(jlimit(0.0, 1.0, v));
+                if (osc2Level == 0.0f)
+                    for (auto& vp : voices)
+                    {
+                        releaseLane(vp.A2);
+                        releaseLane(vp.B2);
+                    }
+            }
+            else if constexpr (P == 11) // Osc2 Frame (offset from the scanned frame)
+            {
+                osc2Frame = jlimit(-(MAX_FRAMES - 1), MAX_FRAMES - 1, int(std::lround(v)));
+                for (auto& vp : voices)
+                    if (vp.active && !vp.pendFlag)
+                    {
+                        vp.pendFrame = vp.frameParam;
+                        vp.pendFlag = true;
+                    }
+            }
+            else if constexpr (P == 12) // Osc2 Octave
+            {
+                osc2Oct = jlimit(-3, 3, int(std::lround(v)));
+                osc2Bits = (osc2Oct << BITS_OCT) + int(std::lround(centsToSemis(osc2Cents) * SEMI2BITS));
+            }
+            else if constexpr (P == 13) // Osc2 Detune (cents)
+            {
+                osc2Cents = v;
+                osc2Bits = (osc2Oct << BITS_OCT) + int(std::lround(centsToSemis(osc2Cents) * SEMI2BITS));
+            }
+            else if constexpr (P == 14) // Filter (Off / LP / BP / HP)
+            {
+                filterMode = int(v);
+                svf.setMode(filterMode, filterRes);
+            }
+            else if constexpr (P == 15) { filterCutoff = jmax(1.0, v); }
+            else if constexpr (P == 16) // Resonance
+            {
+                filterRes = float(v);
+                svf.setMode(filterMode, filterRes);
+            }
+            else if constexpr (P == 17) { filterTrack = v; }   // Key Track, 1 = follows the note
+            else if constexpr (P == 19) { governor.setEnabled(v >= 0.5); }            // Governor
+            else if constexpr (P == 20) { governor.setBudget(float(v)); }             // CPU Budget, share of the block
+            else if constexpr (P == 21) { governor.setMaxLevel(int(std::lround(v))); } // Max Degrade
+            else if constexpr (P == 18) // Lookahead (adds one block of latency; off when rendered per voice)
+            {
+                lookahead = (v >= 0.5);
+                aheadN = 0;
+                if (haveSpecs) sendLatency();
+            }
+            else if constexpr (P == 22) // Low Latency (short kernels and downsampler)
+            {
+                lowLatency = (v >= 0.5);
+                if (haveSpecs) applyKernelSet();
+            }
+            else if constexpr (P == 23) // Lane Cap (lane memory; voices stay capped at NV)
+            {
+                laneCeiling = jlimit(1, MAX_LANES, int(std::lround(v)));
+                lanes.limit(laneCeiling);   // lowering is immediate, raising waits for prepare
+            }
+            else if constexpr (P == 24) // Voice Budget (0 = this instance stays out)
+            {
+                budgetVoices = jlimit(0, gw5::VoiceBudget::MAX_VOICES, int(std::lround(v)));
+                applyBudget();
+            }
+            else if constexpr (P == 25) // Budget Steal (Quietest / Oldest)
+            {
+                budgetPolicy = int(std::lround(v));
+                applyBudget();
+            }
+            else if constexpr (P == 26) { budgetPriority = jlimit(0, 7, int(std::lround(v))); }   // Budget Priority, higher survives
         }
 
         void createParameters(ParameterDataList& ps)
@@ -465,6 +596,25 @@ namespace project
             { parameter::data p("Glide On", { 0.0, 1.0,             1.0 });   p.setDefaultValue(0.0); registerCallback<5>(p); ps.add(std::move(p)); }
             { parameter::data p("Glide Time", { 0.0, 5.0,             0.001 }); p.setDefaultValue(0.1); registerCallback<6>(p); ps.add(std::move(p)); }
             { parameter::data p("Glide-Mult", { 0.25, 4.0,            0.001 }); p.setDefaultValue(1.0); registerCallback<7>(p); ps.add(std::move(p)); }
+            { parameter::data p("Sync", { 0.0, 48.0,            0.01 });  p.setDefaultValue(0.0); registerCallback<8>(p); ps.add(std::move(p)); }
+            { parameter::data p("FM Depth", { 0.0, 8.0,             0.001 }); p.setDefaultValue(0.0); registerCallback<9>(p); ps.add(std::move(p)); }
+            { parameter::data p("Osc2 Level", { 0.0, 1.0,             0.001 }); p.setDefaultValue(0.0); registerCallback<10>(p); ps.add(std::move(p)); }
+            { parameter::data p("Osc2 Frame", { -255.0, 255.0,        1.0 });   p.setDefaultValue(0.0); registerCallback<11>(p); ps.add(std::move(p)); }
+            { parameter::data p("Osc2 Octave", { -3.0, 3.0,            1.0 });   p.setDefaultValue(0.0); registerCallback<12>(p); ps.add(std::move(p)); }
+            { parameter::data p("Osc2 Detune", { -100.0, 100.0,        0.1 });   p.setDefaultValue(0.0); registerCallback<13>(p); ps.add(std::move(p)); }
+            { parameter::data p("Filter", { 0.0, 3.0,             1.0 });   p.setDefaultValue(0.0); registerCallback<14>(p); ps.add(std::move(p)); }
+            { parameter::data p("Cutoff", { 20.0, 20000.0,        1.0 });   p.setDefaultValue(2000.0); registerCallback<15>(p); ps.add(std::move(p)); }
+            { parameter::data p("Resonance", { 0.0, 1.0,             0.001 }); p.setDefaultValue(0.0); registerCallback<16>(p); ps.add(std::move(p)); }
+            { parameter::data p("Key Track", { 0.0, 1.0,             0.001 }); p.setDefaultValue(0.0); registerCallback<17>(p); ps.add(std::move(p)); }
+            { parameter::data p("Lookahead", { 0.0, 1.0,             1.0 });   p.setDefaultValue(0.0); registerCallback<18>(p); ps.add(std::move(p)); }
+            { parameter::data p("Governor", { 0.0, 1.0,             1.0 });   p.setDefaultValue(0.0); registerCallback<19>(p); ps.add(std::move(p)); }
+            { parameter::data p("CPU Budget", { 0.05, 1.0,            0.01 });  p.setDefaultValue(0.5); registerCallback<20>(p); ps.add(std::move(p)); }
+            { parameter::data p("Max Degrade", { 0.0, 4.0,             1.0 });   p.setDefaultValue(4.0); registerCallback<21>(p); ps.add(std::move(p)); }
+            { parameter::data p("Low Latency", { 0.0, 1.0,             1.0 });   p.setDefaultValue(0.0); registerCallback<22>(p); ps.add(std::move(p)); }
+            { parameter::data p("Lane Cap", { 1.0, double(MAX_LANES),    1.0 });   p.setDefaultValue(double(DEFAULT_LANES)); registerCallback<23>(p); ps.add(std::move(p)); }
+            { parameter::data p("Voice Budget", { 0.0, double(gw5::VoiceBudget::MAX_VOICES), 1.0 }); p.setDefaultValue(0.0); registerCallback<24>(p); ps.add(std::move(p)); }
+            { parameter::data p("Budget Steal", { 0.0, 1.0,             1.0 });   p.setDefaultValue(0.0); registerCallback<25>(p); ps.add(std::move(p)); }
+            { parameter::data p("Budget Priority", { 0.0, 7.0,          1.0 });   p.setDefaultValue(0.0); registerCallback<26>(p); ps.add(std::move(p)); }
         }
 
         SN_EMPTY_PROCESS_FRAME;
@@ -479,20 +629,74 @@ namespace project
         double paramGlideTime = 0.1;     // seconds
         double paramGlideTarget = 1.0;   // multiplier
 
+        int    syncBits = 0;             // slave above master, 0 = no sync
+        float  fmDepth = 0.0f;           // linear FM index, 0 = off
+        std::vector<float> fmIn;         // modulator of the current block
+
+        float  osc2Level = 0.0f;         // 0 = second oscillator off
+        int    osc2Frame = 0;            // frame offset from the scanned frame
+        int    osc2Oct = 0;
+        double osc2Cents = 0.0;
+        int    osc2Bits = 0;             // octave + detune in pitch bits
+
+        int    filterMode = 0;
+        double filterCutoff = 2000.0;    // Hz at middle C
+        float  filterRes = 0.0f;
+        double filterTrack = 0.0;
+        gw5::SvfBank<NV> svf;
+        std::array<float, SLICE * NV> voiceBuf{};      // [sample][voice], filter stage
+        std::array<float, SLICE * NV> voiceBufR{};
+
         int    cycle = FRAME_SIZE;
         double sr = 0.0;
         double rootOffSemis = 0.0;
 
         std::array<gw5::Int64, MAX_FRAMES> frameStart;
         gw5::InterpPack  interp;
+        bool             lowLatency = false;     // short kernel set, picked at prepare
 
         bool  ready = false;
         bool  haveSpecs = false;
         PrepareSpecs lastSpecs;
 
-        float laneBuf[SLICE]{};
-        float prevBuf[SLICE]{};
-        float mixBuf[SLICE]{};
+        // current block, read by the engine jobs
+        std::array<VoicePack*, NV> jobVoice{};
+        std::array<int, NV> jobIndex{};
+        int          nbrJobs = 0;
+        int          blockOffset = 0;
+        bool         blockStereo = false;
+        bool         blockFilt = false;
+        const float* blockMod = nullptr;
+        std::array<int, (ENGINE_BLOCK / SLICE) * NV> sliceBits{};   // [slice][job] note + glide
+
+        // CPU governor and the degradation it currently asks for
+        gw5::CpuGovernor governor;
+        int    ctrlSlice = SLICE;
+        bool   lowQuality = false;
+        bool   dropOsc2 = false;
+
+        // this node's VoiceEngine output, one slot per voice
+        gw5::VoiceEngine::Slots  slots;
+
+        // lookahead mode: block rendered by a helper, played on the next call.
+        // The buffers hold one block of the node, so the mode is refused when
+        // HISE calls process() once per voice (perVoice)
+        bool                     lookahead = false;
+        bool                     perVoice = false;
+        gw5::VoiceEngine::Ahead  ahead;
+        std::vector<float>       aheadL, aheadR;
+        int                      aheadN = 0;
+
+        // resampler lanes, lent to the voices as they need them; the cap
+        // bounds lane memory, not the number of voices
+        gw5::VoicePool<Lane> lanes;
+        int    laneCeiling = DEFAULT_LANES;
+
+        // shared voice budget: ceiling and steal order are process-wide,
+        // the instances that take part set them
+        int    budgetVoices = 0;
+        int    budgetPolicy = gw5::VoiceBudget::Policy_QUIETEST;
+        int    budgetPriority = 0;
 
         std::shared_ptr<const gw5::MipMapFlt> _activeMip;
 
@@ -505,14 +709,96 @@ namespace project
             l.frameIdx = -1;
         }
 
+        /* a clean lane from the pool, nullptr at the ceiling */
+        Lane* acquireLane()
+        {
+            Lane* l = lanes.acquire();
+            if (l != nullptr) initLane(*l);
+            return l;
+        }
+
+        void releaseLane(Lane*& l)
+        {
+            if (l == nullptr) return;
+            l->active = false;
+            lanes.release(l);
+            l = nullptr;
+        }
+
+        void releaseLanes(VoicePack& vp)
+        {
+            releaseLane(vp.A); releaseLane(vp.B);
+            releaseLane(vp.A2); releaseLane(vp.B2);
+        }
+
+        /* lanes and budget place back, from a voice that ended or a slot
+           about to be reused */
+        void releaseVoice(VoicePack& vp)
+        {
+            releaseLanes(vp);
+            gw5::VoiceBudget::instance().release(vp.ticket);
+            vp.ticket = gw5::VoiceBudget::NO_TICKET;
+        }
+
+        void applyBudget()
+        {
+            if (budgetVoices == 0) return;
+            auto& budget = gw5::VoiceBudget::instance();
+            budget.setPolicy(budgetPolicy);
+            budget.setLimit(budgetVoices);
+        }
+
+        /* publishes the voice's level and starts the fade-out once a voice
+           of any instance has taken its place */
+        void followBudget(VoicePack& vp)
+        {
+            auto& budget = gw5::VoiceBudget::instance();
+            budget.setLevel(vp.ticket, vp.level);
+            if (vp.stealGain == 0.0f && budget.isStolen(vp.ticket))
+                vp.stealGain = 1.0f;
+        }
+
+        void holdLane(Lane*& l, bool wanted)
+        {
+            if (wanted && l == nullptr) l = acquireLane();
+            else if (!wanted)           releaseLane(l);
+        }
+
+        /* before each block, on the audio thread: a voice keeps its current
+           lane, the partner only around a frame switch and the second
+           oscillator only while it is on; the rest goes back to the pool */
+        void balanceLanes(VoicePack& vp)
+        {
+            if (!vp.active)
+            {
+                releaseVoice(vp);
+                return;
+            }
+
+            const bool fade = vp.fading || vp.pendFlag;
+            const bool two = (osc2Level > 0.0f);
+            holdLane(vp.toggle ? vp.A : vp.B, fade);
+            holdLane(vp.toggle ? vp.B2 : vp.A2, two);
+            holdLane(vp.toggle ? vp.A2 : vp.B2, two && fade);
+        }
+
+        /* kernel set changed after prepare: the lanes re-read it so their
+           downsamplers follow (their state is cleared, a brief click at most) */
+        void applyKernelSet()
+        {
+            const auto set = lowLatency ? gw5::InterpPack::KernelSet_SHORT
+                                        : gw5::InterpPack::KernelSet_LINEAR;
+            if (interp.get_kernel_set() == set)
+                return;
+
+            interp.set_kernel_set(set);
+            lanes.forEach([this](Lane& l) { l.res.set_interp(interp); });
+        }
+
         void initVoice(VoicePack& vp)
         {
-            initLane(vp.A); initLane(vp.B);
             vp.clear();
-            int startF = globalFrame;
-            vp.frameParam = vp.pendFrame = startF;
-            vp.A.res.set_playback_pos(frameStart[startF] << 32);
-            vp.A.frameIdx = startF;
+            vp.frameParam = vp.pendFrame = globalFrame;
             vp.semiOff = paramSemi;
             vp.multOff = paramMult;
         }
@@ -526,8 +812,411 @@ namespace project
             double sem = rootOffSemis + vp.semiOff + semMul
                 + (vp.midi - 24) + centsToSemis(getVoiceDetune(vIdx));
             vp.pitchBits = int(std::lround(sem * SEMI2BITS));
-            vp.A.res.set_pitch(vp.pitchBits);
-            vp.B.res.set_pitch(vp.pitchBits);
+            for (Lane* l : { vp.A, vp.B })
+                if (l != nullptr) l->res.set_pitch(vp.pitchBits);
+        }
+
+        /* cutoff for a voice at 'bits' (note + glide); middle C plays the
+           Cutoff parameter */
+        float trackedCutoff(int bits) const noexcept
+        {
+            if (filterTrack == 0.0)
+                return float(filterCutoff);
+            const double octs = (double(bits) / SEMI2BITS - rootOffSemis - 36.0) / 12.0;
+            return float(filterCutoff * std::exp2(filterTrack * octs));
+        }
+
+        static void sumLanes(float* dst, const float* lanes, int len, int nbrLanes) noexcept
+        {
+            for (int s = 0; s < len; ++s)
+            {
+                const float* row = lanes + s * NV;
+                float acc = 0.0f;
+                for (int v = 0; v < nbrLanes; ++v) acc += row[v];
+                dst[s] += acc;
+            }
+        }
+
+        /* block setup on the audio thread: FM input, flags, active voices */
+        void beginBlock(const float* in, int N)
+        {
+            // through-zero FM: the incoming left channel is the modulator
+            const bool fm = (fmDepth != 0.0f) && N <= int(fmIn.size());
+            if (fm) std::copy(in, in + N, fmIn.begin());
+
+            // stereo tables are interleaved: one interpolation pass per lane
+            // yields both channels; mono tables render L and copy it
+            blockStereo = (_activeMip->get_nbr_chn() == 2);
+            blockMod = fm ? fmIn.data() : nullptr;
+            blockFilt = (svf.getMode() != gw5::SvfBank<NV>::Mode_OFF);
+
+            nbrJobs = 0;
+            for (auto& vp : voices)
+            {
+                balanceLanes(vp);
+                if (vp.active)
+                {
+                    if (vp.ticket >= 0) followBudget(vp);
+                    jobVoice[nbrJobs] = &vp;
+                    jobIndex[nbrJobs] = voices.getVoiceIndexForData(vp);
+                    ++nbrJobs;
+                }
+            }
+        }
+
+        /* voices are rendered by the process-wide engine, one job per voice
+           and ENGINE_BLOCK samples, each into its own slot */
+        void renderBlock(float* L, float* R, int N, gw5::VoiceEngine::Slots& slots)
+        {
+            const auto t0 = governor.beginBlock();
+            applyGovernor();
+
+            const bool stereo = blockStereo;
+            std::fill(L, L + N, 0.0f);
+            if (stereo) std::fill(R, R + N, 0.0f);
+
+            auto& engine = gw5::VoiceEngine::instance();
+            for (int off = 0; off < N && nbrJobs > 0; off += ENGINE_BLOCK)
+            {
+                const int n = jmin(ENGINE_BLOCK, N - off);
+                blockOffset = off;
+                engine.render(this, &renderJob, nbrJobs, n, stereo, slots);
+
+                if (blockFilt)
+                    filterAndMix(slots, L + off, stereo ? R + off : nullptr, n);
+                else
+                    for (int j = 0; j < nbrJobs; ++j)
+                    {
+                        FloatVectorOperations::add(L + off, slots.l(j), n);
+                        if (stereo) FloatVectorOperations::add(R + off, slots.r(j), n);
+                    }
+            }
+
+            FloatVectorOperations::multiply(L, globalVolume, N);
+            if (stereo) FloatVectorOperations::multiply(R, globalVolume, N);
+            else        FloatVectorOperations::copy(R, L, N);
+
+            governor.endBlock(t0, N);
+        }
+
+        /* degradation for this block, from the governor's level; runs with
+           the render, on whichever thread renders */
+        void applyGovernor()
+        {
+            const int lvl = governor.isEnabled() ? governor.getLevel() : int(gw5::CpuGovernor::Level_FULL);
+            ctrlSlice = (lvl >= gw5::CpuGovernor::Level_SLICE) ? LONG_SLICE : SLICE;
+            lowQuality = (lvl >= gw5::CpuGovernor::Level_KERNEL);
+            dropOsc2 = (lvl >= gw5::CpuGovernor::Level_OSC2);
+
+            if (governor.wantsSteal())
+            {
+                VoicePack* quietest = nullptr;
+                for (int j = 0; j < nbrJobs; ++j)
+                    if (jobVoice[j]->stealGain == 0.0f
+                        && (quietest == nullptr || jobVoice[j]->level < quietest->level))
+                        quietest = jobVoice[j];
+                if (quietest != nullptr)
+                {
+                    quietest->stealGain = 1.0f;
+                    governor.noteSteal();
+                }
+            }
+        }
+
+        /* longest slice that keeps the lane inside the padded frame between
+           two wraps */
+        int sliceFor(const VoicePack& vp) const noexcept
+        {
+            if (ctrlSlice == SLICE)
+                return SLICE;
+            const int bits = vp.pitchBits + int(vp.glideCurBits) + syncBits + jmax(0, osc2Bits);
+            const int octs = jmax(0, (bits >> BITS_OCT) + 1);
+            return jlimit(SLICE, ctrlSlice, octs < 30 ? (FRAME_SIZE >> octs) : 0);
+        }
+
+        bool isAhead() const noexcept { return lookahead && !perVoice; }
+
+        static void renderAhead(void* ctx)
+        {
+            auto& self = *static_cast<Griffin_WT*>(ctx);
+            GW5_TRACE_SCOPE("Griffin_WT::ahead");
+            self.renderBlock(self.aheadL.data(), self.aheadR.data(), self.aheadN, self.ahead.slots);
+        }
+
+        void attachAhead()
+        {
+            ahead.ctx = this;
+            ahead.fn = &renderAhead;
+            gw5::VoiceEngine::instance().attach(ahead, NV, ENGINE_BLOCK);
+        }
+
+        void sendLatency()
+        {
+            setGlobalCableValue<WtCables::cbl_wt_latency>(double(getLatencySamples()));
+        }
+
+        static void renderJob(void* ctx, int job, float l[], float r[], int nbrSpl)
+        {
+            auto& self = *static_cast<Griffin_WT*>(ctx);
+            self.renderVoiceBlock(*self.jobVoice[job], job, l, r, nbrSpl);
+        }
+
+        /* one voice over nbrSpl samples, in SLICE steps; runs on any engine
+           thread, so it only touches its own voice and its own output */
+        void renderVoiceBlock(VoicePack& vp, int job, float* outL, float* outR, int nbrSpl)
+        {
+            GW5_TRACE_SCOPE("Griffin_WT::voice");
+
+            for (Lane* l : { vp.A, vp.B, vp.A2, vp.B2 })
+                if (l != nullptr && l->res.is_low_quality() != lowQuality)
+                    l->res.set_low_quality(lowQuality);
+            if (dropOsc2)
+                for (Lane* l : { vp.A2, vp.B2 })
+                    if (l != nullptr) l->active = false;
+
+            for (int base = 0, len = 0; base < nbrSpl; base += len)
+            {
+                len = jmin(sliceFor(vp), nbrSpl - base);
+                float* laneBuf = outL + base;
+                float* laneBufR = blockStereo ? outR + base : nullptr;
+                const bool stereo = blockStereo;
+
+                if (vp.pendFlag) switchFrame(vp);
+
+                if (paramGlideOn)
+                {
+                    if (vp.glideSamplesRemaining > 0)
+                    {
+                        int adv = jmin(vp.glideSamplesRemaining, len);
+                        vp.glideCurBits += vp.glideStepBitsPerSample * adv;
+                        vp.glideSamplesRemaining -= adv;
+                        if (vp.glideSamplesRemaining <= 0)
+                        {
+                            const double glideSemis = std::log2(paramGlideTarget) * 12.0;
+                            vp.glideCurBits = glideSemis * SEMI2BITS;
+                            vp.glideSamplesRemaining = 0;
+                        }
+                    }
+                }
+                else if (vp.glideCurBits != 0.0)
+                {
+                    vp.glideCurBits = 0.0;
+                    vp.glideSamplesRemaining = 0;
+                }
+
+                // hard sync: the note is the master, the table plays
+                // syncBits above it and restarts every master cycle
+                const int offsetBits = int(std::lround(vp.glideCurBits));
+                const int masterBits = vp.pitchBits + offsetBits;
+                const int laneBits = (syncBits > 0) ? jmin(masterBits + syncBits, maxPitchBits()) : masterBits;
+                const gw5::UInt32 syncStep = (syncBits > 0) ? masterStep(masterBits) : 0;
+
+                // second oscillator: same note, envelope and table,
+                // offset frame / pitch; switched on mid-note it starts
+                // in phase with the first. Without a lane from the pool
+                // the voice plays the first one alone
+                Lane& cur = *(vp.toggle ? vp.B : vp.A);
+                Lane* cur2 = vp.toggle ? vp.B2 : vp.A2;
+                const bool two = (osc2Level > 0.0f) && !dropOsc2 && cur2 != nullptr;
+                const int lane2Bits = jlimit(0, maxPitchBits(), laneBits + osc2Bits);
+                const int frame2 = osc2FrameOf(vp.frameParam);
+                const float* mod = (blockMod != nullptr) ? blockMod + blockOffset + base : nullptr;
+
+                if (two && !cur2->active) startLane(*cur2, cur, frame2, lane2Bits);
+
+                prepareLane(cur, vp.frameParam, laneBits, syncStep);
+                if (two) prepareLane(*cur2, frame2, lane2Bits, syncStep);
+                renderVoice(cur, two ? cur2 : nullptr, laneBuf, laneBufR, mod, len, stereo);
+
+                if (vp.fading)
+                {
+                    float prevBuf[LONG_SLICE], prevBufR[LONG_SLICE];
+                    Lane& prev = *(vp.toggle ? vp.A : vp.B);
+                    Lane* prev2 = vp.toggle ? vp.A2 : vp.B2;
+                    const bool two2 = two && prev2 != nullptr && prev2->active;
+                    prepareLane(prev, vp.frameParam, laneBits, syncStep);
+                    if (two2) prepareLane(*prev2, frame2, lane2Bits, syncStep);
+                    renderVoice(prev, two2 ? prev2 : nullptr, prevBuf, prevBufR, mod, len, stereo);
+
+                    float a = vp.fadeAlpha;
+                    FloatVectorOperations::multiply(laneBuf, a, len);
+                    FloatVectorOperations::addWithMultiply(
+                        laneBuf, prevBuf, 1.0f - a, len);
+                    if (stereo)
+                    {
+                        FloatVectorOperations::multiply(laneBufR, a, len);
+                        FloatVectorOperations::addWithMultiply(
+                            laneBufR, prevBufR, 1.0f - a, len);
+                    }
+
+                    vp.fadeAlpha += VoicePack::fadeDelta() * len;
+                    if (vp.fadeAlpha >= 1.0f)
+                    {
+                        vp.fading = false;
+                        prev.active = false;
+                        if (prev2 != nullptr) prev2->active = false;
+                    }
+                }
+
+                if (blockFilt)
+                    for (int s = base; s < base + len; s += SLICE)
+                        sliceBits[(s / SLICE) * NV + job] = masterBits;
+            }
+
+            if (governor.isEnabled() || vp.ticket >= 0)
+            {
+                const auto r = FloatVectorOperations::findMinAndMax(outL, nbrSpl);
+                vp.level = jmax(-r.getStart(), r.getEnd());
+            }
+
+            // stolen by the governor or the budget: short fade, then the voice is free
+            if (vp.stealGain > 0.0f)
+            {
+                const float step = 1.0f / float(STEAL_LEN);
+                for (int i = 0; i < nbrSpl; ++i)
+                {
+                    const float g = jmax(0.0f, vp.stealGain - step * float(i));
+                    outL[i] *= g;
+                    if (blockStereo) outR[i] *= g;
+                }
+                vp.stealGain -= step * float(nbrSpl);
+                if (vp.stealGain <= 0.0f)
+                    vp.clear();
+                else
+                    vp.stealGain = jmax(vp.stealGain, 1e-6f);
+            }
+        }
+
+        /* per-voice filter: the slots are gathered into a sample-major slice
+           so the bank filters every voice in one pass, then summed */
+        void filterAndMix(gw5::VoiceEngine::Slots& slots, float* L, float* R, int n)
+        {
+            // one voice (HISE per-voice rendering): filter its slot in place
+            if (nbrJobs == 1)
+            {
+                const int v = jobIndex[0];
+                float* srcL = slots.l(0);
+                float* srcR = (R != nullptr) ? slots.r(0) : nullptr;
+                for (int base = 0; base < n; base += SLICE)
+                {
+                    const int len = jmin(SLICE, n - base);
+                    svf.setCutoff(v, trackedCutoff(sliceBits[(base / SLICE) * NV]));
+                    svf.processVoice(v, srcL + base, srcR != nullptr ? srcR + base : nullptr, len);
+                }
+                FloatVectorOperations::add(L, srcL, n);
+                if (R != nullptr) FloatVectorOperations::add(R, srcR, n);
+                return;
+            }
+
+            // several voices in this call: sample-major slice, one pass per sample
+            for (int base = 0; base < n; base += SLICE)
+            {
+                const int len = jmin(SLICE, n - base);
+                int nbrLanes = 0;
+                std::fill(voiceBuf.begin(), voiceBuf.begin() + len * NV, 0.0f);
+                if (R != nullptr) std::fill(voiceBufR.begin(), voiceBufR.begin() + len * NV, 0.0f);
+
+                for (int j = 0; j < nbrJobs; ++j)
+                {
+                    const int v = jobIndex[j];
+                    svf.setCutoff(v, trackedCutoff(sliceBits[(base / SLICE) * NV + j]));
+                    const float* srcL = slots.l(j) + base;
+                    for (int s = 0; s < len; ++s) voiceBuf[s * NV + v] = srcL[s];
+                    if (R != nullptr)
+                    {
+                        const float* srcR = slots.r(j) + base;
+                        for (int s = 0; s < len; ++s) voiceBufR[s * NV + v] = srcR[s];
+                    }
+                    nbrLanes = jmax(nbrLanes, v + 1);
+                }
+
+                svf.process(voiceBuf.data(), R != nullptr ? voiceBufR.data() : nullptr, len, nbrLanes);
+                sumLanes(L + base, voiceBuf.data(), len, nbrLanes);
+                if (R != nullptr) sumLanes(R + base, voiceBufR.data(), len, nbrLanes);
+            }
+        }
+
+        int osc2FrameOf(int frame) const noexcept
+        {
+            return jlimit(0, MAX_FRAMES - 1, frame + osc2Frame);
+        }
+
+        void prepareLane(Lane& l, int frame, int bits, gw5::UInt32 syncStep)
+        {
+            l.res.set_pitch(bits);
+            l.res.set_sync(syncStep);
+            l.res.set_playback_pos(wrap(frame, l.res.get_playback_pos()));
+        }
+
+        /* dst takes over src's phase inside frame 'frame'; dst may be src */
+        void startLane(Lane& dst, const Lane& src, int frame, int bits)
+        {
+            gw5::Int64 p = src.res.get_playback_pos();
+            gw5::Int64 ip = p >> 32;
+            gw5::Int64 frac = p & 0xffffffff;
+            gw5::Int64 rel = (ip - frameStart[src.frameIdx]) & (cycle - 1);
+            const gw5::UInt32 syncPhase = src.res.get_sync_phase();
+
+            initLane(dst);
+            dst.res.set_playback_pos(((frameStart[frame] + rel) << 32) | frac);
+            dst.res.set_sync_reset_pos(frameStart[frame] << 32);
+            dst.res.set_sync_phase(syncPhase);
+            dst.res.set_fm_cycle(frameStart[frame] << 32, cycle);
+            dst.res.set_pitch(bits);
+            dst.frameIdx = frame;
+            dst.active = true;
+        }
+
+        /* one lane, SLICE samples at most; mod != nullptr selects FM */
+        void renderLane(Lane& l, float* bufL, float* bufR, const float* mod, int len, bool stereo) const
+        {
+            if (mod != nullptr)
+            {
+                if (stereo) l.res.interpolate_block_fm(bufL, bufR, mod, fmDepth, len);
+                else        l.res.interpolate_block_fm(bufL, mod, fmDepth, len);
+            }
+            else
+            {
+                if (stereo) l.res.interpolate_block(bufL, bufR, len);
+                else        l.res.interpolate_block(bufL, len);
+            }
+        }
+
+        /* one voice, optionally with its second oscillator. Plain playback
+           runs both through the fused dual pass; sync and FM keep their own
+           kernels and render the oscillators one after the other */
+        void renderVoice(Lane& l, Lane* l2, float* bufL, float* bufR, const float* mod, int len, bool stereo) const
+        {
+            if (l2 == nullptr)
+            {
+                renderLane(l, bufL, bufR, mod, len, stereo);
+            }
+            else if (mod == nullptr && syncBits == 0)
+            {
+                if (stereo) l.res.interpolate_block_dual(bufL, bufR, l2->res, osc2Level, len);
+                else        l.res.interpolate_block_dual(bufL, l2->res, osc2Level, len);
+            }
+            else
+            {
+                float osc2Buf[LONG_SLICE], osc2BufR[LONG_SLICE];
+                renderLane(l, bufL, bufR, mod, len, stereo);
+                renderLane(*l2, osc2Buf, osc2BufR, mod, len, stereo);
+                FloatVectorOperations::addWithMultiply(bufL, osc2Buf, osc2Level, len);
+                if (stereo) FloatVectorOperations::addWithMultiply(bufR, osc2BufR, osc2Level, len);
+            }
+        }
+
+        int maxPitchBits() const noexcept
+        {
+            return (_activeMip->get_nbr_tables() << BITS_OCT) - 1;
+        }
+
+        /* master cycles per output sample, 0.32 fixed: one cycle is one
+           frame at the table's pitch 0 */
+        static gw5::UInt32 masterStep(int bits) noexcept
+        {
+            const double cycles = std::exp2(double(bits) / double(1 << BITS_OCT)) / double(FRAME_SIZE);
+            return gw5::UInt32(jlimit(1.0, double(0x7fffffff), cycles * 4294967296.0));
         }
 
         gw5::Int64 wrap(int idx, gw5::Int64 p) const noexcept
@@ -540,19 +1229,34 @@ namespace project
 
         void switchFrame(VoicePack& vp)
         {
-            Lane& src = vp.toggle ? vp.B : vp.A;
-            Lane& dst = vp.toggle ? vp.A : vp.B;
+            GW5_TRACE_SCOPE("Griffin_WT::switchFrame");
 
-            gw5::Int64 p = src.res.get_playback_pos();
-            gw5::Int64 ip = p >> 32;
-            gw5::Int64 frac = p & 0xffffffff;
-            gw5::Int64 rel = (ip - frameStart[vp.frameParam]) & (cycle - 1);
+            Lane* src = vp.toggle ? vp.B : vp.A;
+            Lane* dst = vp.toggle ? vp.A : vp.B;
+            Lane* src2 = vp.toggle ? vp.B2 : vp.A2;
+            Lane* dst2 = vp.toggle ? vp.A2 : vp.B2;
 
-            initLane(dst);
-            dst.res.set_playback_pos(((frameStart[vp.pendFrame] + rel) << 32) | frac);
-            dst.res.set_pitch(vp.pitchBits);
-            dst.frameIdx = vp.pendFrame;
-            dst.active = true;
+            // no partner lane left in the pool: jump in place, unfaded
+            if (dst == nullptr)
+            {
+                startLane(*src, *src, vp.pendFrame, vp.pitchBits);
+                if (src2 != nullptr && src2->active)
+                    startLane(*src2, *src2, osc2FrameOf(vp.pendFrame), vp.pitchBits);
+                vp.frameParam = vp.pendFrame;
+                vp.pendFlag = false;
+                return;
+            }
+
+            startLane(*dst, *src, vp.pendFrame, vp.pitchBits);
+
+            // the second oscillator follows the scan at its offset
+            if (dst2 != nullptr)
+            {
+                if (src2 != nullptr && src2->active)
+                    startLane(*dst2, *src2, osc2FrameOf(vp.pendFrame), vp.pitchBits);
+                else
+                    dst2->active = false;
+            }
 
             vp.fading = true;
             vp.toggle = !vp.toggle;
@@ -4,8 +4,25 @@
 #include <JuceHeader.h>
 #include <vector>
 #include <atomic>
+#include <mutex>
+#include <string>
+#include <utility>
 
+#include "src/griffinwave5/AdditiveFrames.h"
 #include "src/griffinwave5/AsyncMipBuilder.h"
+#include "src/griffinwave5/JobPool.h"
+#include "src/griffinwave5/MappedFile.h"
+#include "src/griffinwave5/MemStats.h"
+#include "src/griffinwave5/PeriodSlicer.h"
+#include "src/griffinwave5/SpectralMorph.h"
+#include "src/griffinwave5/TableBlend.h"
+#include "src/griffinwave5/Trace.h"
+#include "src/griffinwave5/WavReader.h"
+#include "src/griffinwave5/WavetableImport.h"
+
+#if !defined(GW5_CORE_LIBRARY)
+#include "src/griffinwave5/CoreUnity.cpp"
+#endif
 
 // Use this enum to refer to the cables, eg. this->setGlobalCableValue<GlobalCables::cbl_e1_w1>(0.4)
 
@@ -19,12 +36,18 @@ namespace project
     enum class GlobalCables
     {
         cbl_e1_w1 = 0,  // external slot 0 – decimated preview
-        cbl_e1_w2 = 1,  // external slot 1 – decimated preview
-        cbl_e1_w3 = 2   // blended preview (GUI waveform)
+        cbl_e1_w2 = 1,  // external slot 1 – decimated preview (slots 2-7 have none)
+        cbl_e1_w3 = 2,  // blended preview (GUI waveform)
+        cbl_e1_w4 = 3,  // memory report (JSON object, bytes)
+        cbl_e1_w5 = 4,  // WAV import request in: path, or { slot, file, frameLength, mode }
+        cbl_e1_w6 = 5   // slicing progress out (0..1)
     };
     using cable_manager_t = routing::global_cable_cpp_manager<SN_GLOBAL_CABLE(328105083),
         SN_GLOBAL_CABLE(328105084),
-        SN_GLOBAL_CABLE(328105085)>;
+        SN_GLOBAL_CABLE(328105085),
+        SN_GLOBAL_CABLE(328105086),
+        SN_GLOBAL_CABLE(328105087),
+        SN_GLOBAL_CABLE(328105088)>;
 
     template <int NV>
     struct Griffin_WaveMaker : public data::base, public cable_manager_t
@@ -40,8 +63,8 @@ namespace project
         static constexpr int  getFixChannelAmount() { return 2; }
 
         static constexpr int NumTables = 0;
-        static constexpr int NumSliderPacks = 0;
-        static constexpr int NumAudioFiles = 2;
+        static constexpr int NumSliderPacks = 2;    // additive: amplitudes, phases
+        static constexpr int NumAudioFiles = gw5::TableBlend::MAX_INPUTS;
         static constexpr int NumFilters = 0;
         static constexpr int NumDisplayBuffers = 0;
 
@@ -54,141 +77,643 @@ namespace project
         static constexpr int TripFactor = 3;
         static constexpr int TripledSamples = MaxSamples * TripFactor; // 1572864
         static constexpr int TripledFrame = FrameSize * TripFactor; // 6144
+        static constexpr int MipLevels = 12;
+        static constexpr int PreviewLevel = 2;                      // FrameSize / DecFactor per frame
+        static_assert((FrameSize >> PreviewLevel) * DecFactor == FrameSize, "preview level");
+
+        /* ===== parameter layout =========================================== */
+        // 0 Mix (equal-power between inputs 1 and 2), then per input:
+        static constexpr int ParamWeight = 1;                           // 1..8
+        static constexpr int ParamOffset = ParamWeight + NumAudioFiles; // 9..16
+        static constexpr int ParamReverse = ParamOffset + NumAudioFiles; // 17..24
+        static constexpr int ParamMode = ParamReverse + NumAudioFiles;   // 25
+        static constexpr int ParamSource = ParamMode + 1;                // 26
+        static constexpr int ParamEditFrame = ParamSource + 1;           // 27
+        static constexpr int ParamImportFrameLength = ParamEditFrame + 1; // 28
+        static constexpr int ParamImportMode = ParamImportFrameLength + 1; // 29
+        static constexpr int ParamDcRemove = ParamImportMode + 1;        // 30
+        static constexpr int ParamNormalize = ParamDcRemove + 1;         // 31
+        static constexpr int ParamAlignZero = ParamNormalize + 1;        // 32
+
+        enum BlendMode
+        {
+            BlendMode_CROSSFADE = 0,    // time domain, equal power
+            BlendMode_SPECTRAL          // magnitude / unwrapped phase morph
+        };
+
+        enum Source
+        {
+            Source_FILES = 0,           // blend of the audio file inputs
+            Source_ADDITIVE             // harmonic frames edited via slider packs
+        };
+
+        enum ImportMode
+        {
+            ImportMode_FRAMES = 0,      // file is a wavetable, cut at the frame length
+            ImportMode_SLICE            // any recording, one pitch period per frame
+        };
+
+        enum Normalize
+        {
+            Normalize_OFF = 0,
+            Normalize_PEAK,             // every frame to full scale
+            Normalize_RMS               // every frame to the same loudness
+        };
 
         /* ===== storage ==================================================== */
+        // inputData[k] points either into a HISE pool file (audioBlocks) or
+        // into ownedInputs (WAV import); only the rebuild job reads or
+        // changes it, new inputs are staged and installed at its start.
+        // inputDataR[k] is the right channel of a stereo pool file.
         block              audioBlocks[NumAudioFiles];
-        int                numSamples[NumAudioFiles]{ 0, 0 };
+        block              audioBlocksR[NumAudioFiles];
+        const float*       inputData[NumAudioFiles]{};
+        const float*       inputDataR[NumAudioFiles]{};
+        std::vector<float> ownedInputs[NumAudioFiles];
 
-        std::vector<float> mixBuf;   // full-rate buffer (MaxSamples)
-        std::vector<float> decBuf;   // decimated buffer (DecSamples)
-
-        float* tripleView{ nullptr };   // producer view into AsyncMipBuilder slot
+        struct StagedInput
+        {
+            bool               set = false;
+            const float*       data = nullptr;   // pool data, or
+            const float*       dataR = nullptr;  // (stereo pool file)
+            std::vector<float> owned;            // converted import
+        };
+        StagedInput        staged[NumAudioFiles];
+        std::mutex         stageMutex;
 
-        WaitableEvent      wakeEvt;
         std::atomic<double> mix{ 0.5 };
+        std::atomic<float>  weight[NumAudioFiles];
+        std::atomic<int>    frameOffset[NumAudioFiles];
+        std::atomic<bool>   reverse[NumAudioFiles];
+        std::atomic<int>    blendMode{ BlendMode_CROSSFADE };
+        std::atomic<int>    source{ Source_FILES };
+        std::atomic<int>    importFrameLength{ 0 };    // 0 = from the file, else 2048
+        std::atomic<int>    importMode{ ImportMode_FRAMES };
+
+        /* per-frame conditioning of the file inputs (gw5::FrameConditioner
+           flags). Measured by the rebuild job whenever an input or the flags
+           change and applied by the blend, so the pool data stays untouched
+           and scanning needs no per-voice level compensation. */
+        std::atomic<int>      conditionFlags{ 0 };
+        gw5::FrameConditioning conditioning[NumAudioFiles];
+        int                   conditionedFlags[NumAudioFiles]{};   // rebuild job only
+        bool                  conditionStale[NumAudioFiles]{};
+
+        /* additive source: slider pack 0 = harmonic amplitudes, 1 = phases
+           (cycles), both applied to frame editFrame whenever HISE reports
+           a change of the pack while the additive source is selected */
+        block               sliderBlocks[NumSliderPacks];
+        int                 sliderSizes[NumSliderPacks]{};
+        SliderPackData*     sliderPacks[NumSliderPacks]{};
+        SimpleReadWriteLock unboundLock;           // for a pack not connected yet
+        std::atomic<int>    editFrame{ 0 };
+        gw5::AdditiveFrames additive{ FrameSize, MaxFrames };
+
+        Griffin_WaveMaker()
+        {
+            // sized before any rebuild can write the slot; later calls are no-ops
+            gw5::AsyncMipBuilder::instance().configure(TripledSamples, MipLevels);
+
+            for (int k = 0; k < NumAudioFiles; ++k)
+            {
+                weight[k].store(1.0f);
+                frameOffset[k].store(0);
+                reverse[k].store(false);
+                conditioning[k].resize(MaxFrames);
+                gw5::MemStats::instance().add(gw5::MemStats::Category_WAVEMAKER, conditioning[k].getMemBytes());
+            }
+
+            this->template registerDataCallback<GlobalCables::cbl_e1_w5>(
+                [this](const var& v) { onImportRequest(v); });
+        }
+
+        /* ===== background jobs (shared gw5::JobPool) ====================== */
+        // addresses used as job keys: one rebuild and one preview per cable
+        // queued or running per instance
+        struct JobKeys { char rebuild; char preview[3]; char import[NumAudioFiles]; } jobKeys{};
+
+        void requestRebuild()
+        {
+            gw5::JobPool::instance().submit(
+                [this](const gw5::JobPool::Job& job) { rebuild(job); },
+                gw5::JobPool::Priority_NORMAL, &jobKeys.rebuild);
+        }
+
+        /* decimated preview -> cable, off the rebuild path */
+        template <GlobalCables C>
+        void requestPreview(std::vector<float>&& dec)
+        {
+            gw5::JobPool::instance().submit(
+                [this, dec = std::move(dec)](const gw5::JobPool::Job& job)
+                {
+                    Array<var> decArr;
+                    decArr.ensureStorageAllocated((int)dec.size());
+                    for (float v : dec) decArr.add(v);
+
+                    if (!job.isCancelled())
+                        sendDataToGlobalCable<C>(decArr);
+                },
+                gw5::JobPool::Priority_LOW, &jobKeys.preview[(int)C]);
+        }
+
+        /* snapshot of the weight vector; the Mix pair keeps the legacy
+           cos/sin law and everything is normalised to equal power, so one or
+           two inputs at default weights blend exactly as before. The spectral
+           morph interpolates magnitudes, so there the pair is linear and the
+           gains sum to 1. */
+        int gatherInputs(gw5::TableBlend::Input in[NumAudioFiles], bool spectral) const
+        {
+            const bool has0 = (inputData[0] != nullptr);
+            const bool has1 = (inputData[1] != nullptr);
+            const double m = mix.load(std::memory_order_acquire);
+
+            float g0, g1;
+            if (spectral)
+                gw5::TableBlend::linearGains(m, has0, has1, g0, g1);
+            else
+                gw5::TableBlend::equalPowerGains(m, has0, has1, g0, g1);
+
+            int loaded = 0;
+            for (int k = 0; k < NumAudioFiles; ++k)
+            {
+                const bool has = (inputData[k] != nullptr);
+                loaded += has ? 1 : 0;
+
+                float g = has ? weight[k].load(std::memory_order_relaxed) : 0.0f;
+                if (k == 0) g *= g0;
+                if (k == 1) g *= g1;
+
+                in[k].data = inputData[k];
+                in[k].dataR = spectral ? nullptr : inputDataR[k];   // the morph is mono
+                in[k].gain = g;
+                in[k].frameOffset = frameOffset[k].load(std::memory_order_relaxed);
+                in[k].reverse = reverse[k].load(std::memory_order_relaxed);
+                in[k].cond = (has && conditionedFlags[k] != 0) ? &conditioning[k] : nullptr;
+            }
+
+            if (spectral)
+                gw5::TableBlend::normalizeSum(in, NumAudioFiles);
+            else
+                gw5::TableBlend::normalizePower(in, NumAudioFiles);
+            return loaded;
+        }
 
-        /* ===== builder thread ============================================ */
-        struct Worker : Thread
+        void rebuild(const gw5::JobPool::Job& job)
         {
-            Griffin_WaveMaker& owner;
-            explicit Worker(Griffin_WaveMaker& p) : Thread("WTBuilder"), owner(p) {}
+            installStagedInputs();
+
+            if (source.load(std::memory_order_relaxed) == Source_ADDITIVE)
+            {
+                rebuildAdditive(job);
+                return;
+            }
+
+            const bool spectral = (blendMode.load(std::memory_order_relaxed) == BlendMode_SPECTRAL);
+
+            updateConditioning();
+
+            gw5::TableBlend::Input in[NumAudioFiles];
+            if (gatherInputs(in, spectral) == 0) return;   // nothing loaded yet
+            if (job.isCancelled()) return;                 // superseded by a newer request
 
-            void run() override
+            GW5_TRACE_SCOPE("WaveMaker::rebuild");
+
+            if (spectral)
             {
-                constexpr int N = MaxSamples;
+                rebuildSpectral(job, in);
+                return;
+            }
+
+            // any stereo input makes the table stereo (interleaved)
+            const int nbrChn = gw5::TableBlend::channelsOf(in, NumAudioFiles);
 
-                for (;;)
+            std::vector<float> dec(DecSamples);
+            {
+                gw5::AsyncMipBuilder::SlotWriter slot(gw5::AsyncMipBuilder::instance(), nbrChn);
+
+                /* --- 1. fused blend straight into the builder slot ------- */
                 {
-                    owner.wakeEvt.wait(-1);
-                    if (threadShouldExit()) return;
-
-                    const bool has0 = (owner.numSamples[0] == N);
-                    const bool has1 = (owner.numSamples[1] == N);
-                    if (!has0 && !has1) continue;          // nothing loaded yet
-
-                    /* --- 1. blend ------------------------------------------------ */
-                    const double m = owner.mix.load(std::memory_order_acquire);
-                    FloatVectorOperations::clear(owner.mixBuf.data(), N);
-
-                    double g0 = 0.0, g1 = 0.0;
-                    if (has0 && has1)
-                    {
-                        double angle = m * MathConstants<double>::halfPi;
-                        g0 = std::cos(angle);
-                        g1 = std::sin(angle);
-                    }
-                    else if (has0) g0 = 1.0;
-                    else           g1 = 1.0;
-
-                    if (has0)
-                        FloatVectorOperations::addWithMultiply(
-                            owner.mixBuf.data(), owner.audioBlocks[0].data, (float)g0, N);
-                    if (has1)
-                        FloatVectorOperations::addWithMultiply(
-                            owner.mixBuf.data(), owner.audioBlocks[1].data, (float)g1, N);
-
-                    /* --- 2. down-sample for the GUI cable ---------------------- */
-                    for (int i = 0; i < DecSamples; ++i)
-                        owner.decBuf[i] = owner.mixBuf[i * DecFactor];
+                    GW5_TRACE_SCOPE("WaveMaker::blend");
+                    gw5::TableBlend::blendTripled(slot.data(), in, NumAudioFiles, FrameSize, MaxFrames, nbrChn);
+                }
 
-                    Array<var> decArr;
-                    decArr.ensureStorageAllocated(DecSamples);
-                    for (float v : owner.decBuf) decArr.add(v);
-
-                    // blended preview -> cbl_e1_w3
-                    owner.sendDataToGlobalCable<GlobalCables::cbl_e1_w3>(decArr);
-
-                    /* --- 3. write tripled block straight into builder slot ----- */
-                    owner.tripleView = gw5::AsyncMipBuilder::instance().writeSlot();
-
-                    float* dst = owner.tripleView;
-                    const float* src = owner.mixBuf.data();
-                    for (int f = 0; f < MaxFrames; ++f)
-                    {
-                        memcpy(dst, src, FrameSize * sizeof(float));
-                        memcpy(dst + FrameSize, src, FrameSize * sizeof(float));
-                        memcpy(dst + FrameSize * 2, src, FrameSize * sizeof(float));
-                        dst += TripledFrame;
-                        src += FrameSize;
-                    }
-
-                    /* hand-off to background builder */
-                    gw5::AsyncMipBuilder::instance().commitSlot();
+                /* --- 2. down-sample for the GUI cable -------------------- */
+                {
+                    GW5_TRACE_SCOPE("WaveMaker::decimate");
+                    gw5::TableBlend::decimateTripled(dec.data(), slot.data(), FrameSize, MaxFrames, DecFactor, nbrChn);
                 }
+
+                /* hand-off to background builder */
+                slot.commit();
+            }
+
+            // blended preview -> cbl_e1_w3
+            requestPreview<GlobalCables::cbl_e1_w3>(std::move(dec));
+
+            sendMemoryReport();
+        }
+
+        /* spectral morph: frames in parallel on the pool, every mip level
+           generated from the spectra, published without the slot / FIR pass */
+        void rebuildSpectral(const gw5::JobPool::Job& job, const gw5::TableBlend::Input in[NumAudioFiles])
+        {
+            auto mp = gw5::SpectralMorph::build(in, NumAudioFiles, FrameSize, MaxFrames, MipLevels, job);
+            if (mp == nullptr) return;                     // cancelled
+
+            // preview from the band-limited level that has the preview rate
+            std::vector<float> dec(DecSamples);
+            gw5::TableBlend::decimateTripled(dec.data(), mp->use_table(PreviewLevel),
+                FrameSize >> PreviewLevel, MaxFrames, 1);
+
+            gw5::AsyncMipBuilder::instance().publish(std::move(mp));
+
+            requestPreview<GlobalCables::cbl_e1_w3>(std::move(dec));
+            sendMemoryReport();
+        }
+
+        /* additive: only frames edited since the last build are regenerated,
+           on top of a copy of the previous pyramid */
+        void rebuildAdditive(const gw5::JobPool::Job& job)
+        {
+            GW5_TRACE_SCOPE("WaveMaker::additive");
+
+            auto mp = additive.build(MipLevels, job);
+            if (mp == nullptr || job.isCancelled()) return;
+
+            std::vector<float> dec(DecSamples);
+            gw5::TableBlend::decimateTripled(dec.data(), mp->use_table(PreviewLevel),
+                FrameSize >> PreviewLevel, MaxFrames, 1);
+
+            gw5::AsyncMipBuilder::instance().publish(std::move(mp));
+
+            requestPreview<GlobalCables::cbl_e1_w3>(std::move(dec));
+            sendMemoryReport();
+        }
+
+        /* ===== inputs ===================================================== */
+        static int64_t bytesOf(const std::vector<float>& v) noexcept
+        {
+            return static_cast<int64_t>(v.capacity() * sizeof(float));
+        }
+
+        /* any thread; replaces an input not yet installed */
+        void stageInput(int k, const float* data, std::vector<float>&& owned, const float* dataR = nullptr)
+        {
+            std::lock_guard<std::mutex> lock(stageMutex);
+            gw5::MemStats::instance().add(gw5::MemStats::Category_WAVEMAKER, -bytesOf(staged[k].owned));
+            staged[k].set = true;
+            staged[k].data = data;
+            staged[k].dataR = dataR;
+            staged[k].owned = std::move(owned);
+        }
+
+        /* rebuild job only */
+        void installStagedInputs()
+        {
+            std::lock_guard<std::mutex> lock(stageMutex);
+            for (int k = 0; k < NumAudioFiles; ++k)
+            {
+                if (!staged[k].set)
+                    continue;
+
+                gw5::MemStats::instance().add(gw5::MemStats::Category_WAVEMAKER, -bytesOf(ownedInputs[k]));
+                ownedInputs[k] = std::move(staged[k].owned);
+                inputData[k] = ownedInputs[k].empty() ? staged[k].data : ownedInputs[k].data();
+                inputDataR[k] = ownedInputs[k].empty() ? staged[k].dataR : nullptr;
+                staged[k] = StagedInput();
+                conditionStale[k] = true;
+            }
+        }
+
+        /* rebuild job only: re-measure inputs that are new or were measured
+           with other flags */
+        void updateConditioning()
+        {
+            const int flags = conditionFlags.load(std::memory_order_relaxed);
+            for (int k = 0; k < NumAudioFiles; ++k)
+            {
+                if (inputData[k] == nullptr || (!conditionStale[k] && conditionedFlags[k] == flags))
+                    continue;
+
+                gw5::FrameConditioner::analyse(inputData[k], inputDataR[k], FrameSize, MaxFrames, flags, conditioning[k]);
+                conditionedFlags[k] = flags;
+                conditionStale[k] = false;
             }
-        } worker{ *this };
+        }
+
+        /* setParameter: flag bits in mask are replaced by bits */
+        void setConditionFlags(int mask, int bits)
+        {
+            int cur = conditionFlags.load();
+            while (!conditionFlags.compare_exchange_weak(cur, (cur & ~mask) | bits)) {}
+            if ((cur & mask) != bits)
+                requestRebuild();
+        }
+
+        /* cbl_e1_w5: a path (slot 1) or { "slot": 1..8, "file": path,
+           "frameLength": n, "mode": "frames" | "slice" } */
+        void onImportRequest(const var& v)
+        {
+            int slot = 0;
+            int frameLen = importFrameLength.load();
+            bool slice = (importMode.load() == ImportMode_SLICE);
+            String path;
+
+            if (v.isString())
+            {
+                path = v.toString();
+            }
+            else if (v.isObject())
+            {
+                slot = (int)v.getProperty("slot", 1) - 1;
+                path = v["file"].toString();
+                frameLen = (int)v.getProperty("frameLength", frameLen);
+                if (v.getProperty("mode", var()).isString())
+                    slice = (v["mode"].toString() == "slice");
+            }
+
+            if (path.isEmpty() || slot < 0 || slot >= NumAudioFiles)
+            {
+                Logger::writeToLog("WaveMaker: import needs a file path and a slot 1-" + String(NumAudioFiles));
+                return;
+            }
+
+            requestImport(slot, path.toStdString(), frameLen, slice);
+        }
+
+        /* map, parse and convert on the pool; a newer import into the same
+           slot cancels this one */
+        void requestImport(int slot, std::string path, int frameLen, bool slice)
+        {
+            gw5::JobPool::instance().submit(
+                [this, slot, path = std::move(path), frameLen, slice](const gw5::JobPool::Job& job)
+                {
+                    importFile(job, slot, path, frameLen, slice);
+                },
+                gw5::JobPool::Priority_NORMAL, &jobKeys.import[slot]);
+        }
+
+        void importFile(const gw5::JobPool::Job& job, int slot, const std::string& path, int frameLen, bool slice)
+        {
+            GW5_TRACE_SCOPE("WaveMaker::import");
+
+            gw5::MappedFile file;
+            gw5::WavReader  wav;
+            if (!file.open(path.c_str()) || !wav.parse(file.data(), file.size()))
+            {
+                Logger::writeToLog("WaveMaker: can't read WAV " + String(path));
+                return;
+            }
+
+            if (slice)
+            {
+                std::vector<float> mono(wav.getNbrSamples());
+                wav.readMono(0, wav.getNbrSamples(), mono.data());
+                file.close();
+                sliceInput(job, slot, std::move(mono));
+                return;
+            }
+
+            if (frameLen <= 0)
+                frameLen = (wav.getFrameLength() > 0) ? wav.getFrameLength() : FrameSize;
+
+            std::vector<float> table(MaxSamples);
+            gw5::MemStats::instance().add(gw5::MemStats::Category_WAVEMAKER, bytesOf(table));
+
+            if (!gw5::WavetableImport::convert(wav, frameLen, table.data(), FrameSize, MaxFrames, job))
+            {
+                if (!job.isCancelled())
+                    Logger::writeToLog("WaveMaker: " + String(path) + " is shorter than one frame of " + String(frameLen));
+                gw5::MemStats::instance().add(gw5::MemStats::Category_WAVEMAKER, -bytesOf(table));
+                return;
+            }
+
+            installImport(slot, std::move(table));
+        }
+
+        /* pool file in slice mode: the mono mix is copied here since the pool
+           may drop its buffer before the job runs */
+        void requestSlice(int slot, std::vector<float>&& mono)
+        {
+            gw5::JobPool::instance().submit(
+                [this, slot, mono = std::move(mono)](const gw5::JobPool::Job& job) mutable
+                {
+                    sliceInput(job, slot, std::move(mono));
+                },
+                gw5::JobPool::Priority_NORMAL, &jobKeys.import[slot]);
+        }
+
+        /* pitch-period slicing, progress -> cbl_e1_w6 */
+        void sliceInput(const gw5::JobPool::Job& job, int slot, std::vector<float>&& mono)
+        {
+            GW5_TRACE_SCOPE("WaveMaker::slice");
+
+            if ((long)mono.size() < gw5::PeriodSlicer::getMinLength())
+            {
+                Logger::writeToLog("WaveMaker: slicing needs at least "
+                    + String((int)gw5::PeriodSlicer::getMinLength()) + " samples");
+                return;
+            }
+
+            std::vector<float> table(MaxSamples);
+            gw5::MemStats::instance().add(gw5::MemStats::Category_WAVEMAKER, bytesOf(table));
+
+            setGlobalCableValue<GlobalCables::cbl_e1_w6>(0.0);
+            const bool ok = gw5::PeriodSlicer::slice(mono.data(), (long)mono.size(),
+                table.data(), FrameSize, MaxFrames, job,
+                [this](double p) { setGlobalCableValue<GlobalCables::cbl_e1_w6>(p); });
+
+            if (!ok)
+            {
+                gw5::MemStats::instance().add(gw5::MemStats::Category_WAVEMAKER, -bytesOf(table));
+                return;                                    // cancelled
+            }
+
+            installImport(slot, std::move(table));
+        }
+
+        /* converted table: slot preview, then staged for the next rebuild */
+        void installImport(int slot, std::vector<float>&& table)
+        {
+            if (slot < 2)
+            {
+                std::vector<float> dec(DecSamples);
+                gw5::TableBlend::decimate(dec.data(), table.data(), DecSamples, DecFactor);
+                if (slot == 0)
+                    requestPreview<GlobalCables::cbl_e1_w1>(std::move(dec));
+                else
+                    requestPreview<GlobalCables::cbl_e1_w2>(std::move(dec));
+            }
+
+            stageInput(slot, nullptr, std::move(table));
+            requestRebuild();
+        }
 
         /* ===== lifecycle ================================================== */
+        /* never waits on pool jobs: the builder was configured at construction */
         void prepare(PrepareSpecs)
         {
-            mixBuf.resize(MaxSamples);
-            decBuf.resize(DecSamples);
+            sendMemoryReport();
+        }
 
-            gw5::AsyncMipBuilder::instance().configure(TripledSamples, 12);
-            worker.startThread();
+        ~Griffin_WaveMaker()
+        {
+            auto& pool = gw5::JobPool::instance();
+            for (const char& k : jobKeys.import)
+                pool.cancel(&k, true);
+            pool.cancel(&jobKeys.rebuild, true);
+            for (const char& k : jobKeys.preview)
+                pool.cancel(&k, true);
+
+            for (int k = 0; k < NumAudioFiles; ++k)
+                gw5::MemStats::instance().add(gw5::MemStats::Category_WAVEMAKER,
+                    -(bytesOf(ownedInputs[k]) + bytesOf(staged[k].owned) + conditioning[k].getMemBytes()));
         }
 
-        void reset() { wakeEvt.signal(); }
+        void reset() { requestRebuild(); }
+
+        /* ===== memory accounting ========================================== */
+        // pool inputs are referenced and the blend writes into the builder
+        // slot; owned are imported inputs, their conditioning and the
+        // additive frame data
+        int64_t getMemoryBytes() const noexcept
+        {
+            int64_t bytes = additive.getMemoryBytes();
+            for (const auto& v : ownedInputs)
+                bytes += bytesOf(v);
+            for (const auto& c : conditioning)
+                bytes += c.getMemBytes();
+            return bytes;
+        }
+
+        /* per table / per instance / per process snapshot -> cbl_e1_w4 */
+        void sendMemoryReport()
+        {
+            auto& builder = gw5::AsyncMipBuilder::instance();
+            const auto s = gw5::MemStats::instance().snapshot();
+
+            auto* obj = new DynamicObject();
+            obj->setProperty("tableBytes", (int64)builder.getActiveTableBytes());
+            obj->setProperty("instanceBytes", (int64)getMemoryBytes());
+            obj->setProperty("mipBytes", (int64)s.bytes[gw5::MemStats::Category_MIP_TABLES]);
+            obj->setProperty("slotBytes", (int64)s.bytes[gw5::MemStats::Category_BUILDER_SLOT]);
+            obj->setProperty("waveMakerBytes", (int64)s.bytes[gw5::MemStats::Category_WAVEMAKER]);
+            obj->setProperty("resamplerBytes", (int64)s.bytes[gw5::MemStats::Category_RESAMPLER]);
+            obj->setProperty("voiceEngineBytes", (int64)s.bytes[gw5::MemStats::Category_VOICE_ENGINE]);
+            obj->setProperty("processBytes", (int64)s.total);
+            obj->setProperty("peakBytes", (int64)s.peak);
+            obj->setProperty("buildPeakBytes", (int64)builder.getBuildPeakBytes());
+
+            sendDataToGlobalCable<GlobalCables::cbl_e1_w4>(var(obj));
+        }
 
         SN_EMPTY_PROCESS_FRAME;
         SN_EMPTY_HANDLE_EVENT;
         SN_EMPTY_PROCESS;
 
+        /* ===== additive edit frame ========================================= */
+        SimpleReadWriteLock& packLock(int n) const noexcept
+        {
+            return sliderPacks[n] != nullptr ? sliderPacks[n]->getDataLock()
+                                             : const_cast<SimpleReadWriteLock&>(unboundLock);
+        }
+
+        /* packs -> frame editFrame, reading under the packs' locks */
+        void storeEditFrame()
+        {
+            SimpleReadWriteLock::ScopedReadLock l0(packLock(0));
+            SimpleReadWriteLock::ScopedReadLock l1(packLock(1));
+            additive.setFrame(editFrame.load(),
+                sliderBlocks[0].data, sliderSizes[0],
+                sliderBlocks[1].data, sliderSizes[1]);
+        }
+
+        /* frame f -> packs: written under the packs' locks, then the packs
+           are told so their editors and listeners update */
+        void loadEditFrame(int f)
+        {
+            {
+                SimpleReadWriteLock::ScopedWriteLock l0(packLock(0));
+                SimpleReadWriteLock::ScopedWriteLock l1(packLock(1));
+                additive.getFrame(f, sliderBlocks[0].data, sliderSizes[0],
+                    sliderBlocks[1].data, sliderSizes[1]);
+            }
+            for (auto* sp : sliderPacks)
+                if (sp != nullptr)
+                    sp->getUpdater().sendContentChangeMessage(sendNotificationAsync, -1);
+        }
+
         /* ===== external data ============================================= */
         void setExternalData(const snex::ExternalData& d, int idx)
         {
+            if (d.dataType == snex::ExternalData::DataType::SliderPack)
+            {
+                if (idx >= NumSliderPacks)
+                    return;
+
+                d.referBlockTo(sliderBlocks[idx], 0);
+                sliderSizes[idx] = d.numSamples;
+                sliderPacks[idx] = dynamic_cast<SliderPackData*>(d.obj);
+
+                if (source.load() == Source_ADDITIVE)
+                {
+                    storeEditFrame();
+                    requestRebuild();
+                }
+                return;
+            }
+
             if (d.dataType != snex::ExternalData::DataType::AudioFile || idx >= NumAudioFiles)
                 return;
 
-            const bool valid = (d.numChannels == 1 && d.numSamples == MaxSamples);
+            const bool valid = ((d.numChannels == 1 || d.numChannels == 2) && d.numSamples == MaxSamples);
+
+            // a pool file replaces an import still running for this slot
+            gw5::JobPool::instance().cancel(&jobKeys.import[idx], false);
+
+            if (importMode.load() == ImportMode_SLICE && d.numSamples > 0)
+            {
+                // any length / channel count; the slot keeps its current
+                // table until the slices are ready
+                std::vector<float> mono((size_t)d.numSamples, 0.0f);
+                const float scale = 1.0f / (float)jmax(1, d.numChannels);
+                for (int c = 0; c < d.numChannels; ++c)
+                {
+                    block b;
+                    d.referBlockTo(b, c);
+                    for (int i = 0; i < d.numSamples; ++i)
+                        mono[(size_t)i] += b[i] * scale;
+                }
+                requestSlice(idx, std::move(mono));
+                return;
+            }
 
             if (!valid)
             {
-                Logger::writeToLog("WaveMaker: wavetable must be mono " + String(MaxSamples) + " samples");
-                numSamples[idx] = 0;
+                Logger::writeToLog("WaveMaker: wavetable must be mono or stereo " + String(MaxSamples)
+                    + " samples, other files can be imported via cbl_e1_w5 or sliced (Import Mode)");
+                stageInput(idx, nullptr, {});
             }
             else
             {
                 d.referBlockTo(audioBlocks[idx], 0);
-                numSamples[idx] = d.numSamples;
+                if (d.numChannels == 2)
+                    d.referBlockTo(audioBlocksR[idx], 1);
+                stageInput(idx, audioBlocks[idx].data, {},
+                    (d.numChannels == 2) ? audioBlocksR[idx].data : nullptr);
 
                 /* --- decimate once and publish to dedicated cable ---------- */
                 std::vector<float> tmpDec(DecSamples);
-                const float* src = audioBlocks[idx].data;
-                for (int i = 0; i < DecSamples; ++i) tmpDec[i] = src[i * DecFactor];
-
-                Array<var> decArr;
-                decArr.ensureStorageAllocated(DecSamples);
-                for (float v : tmpDec) decArr.add(v);
+                gw5::TableBlend::decimate(tmpDec.data(), audioBlocks[idx].data, DecSamples, DecFactor);
 
                 if (idx == 0)
-                    sendDataToGlobalCable<GlobalCables::cbl_e1_w1>(decArr);
-                else
-                    sendDataToGlobalCable<GlobalCables::cbl_e1_w2>(decArr);
+                    requestPreview<GlobalCables::cbl_e1_w1>(std::move(tmpDec));
+                else if (idx == 1)
+                    requestPreview<GlobalCables::cbl_e1_w2>(std::move(tmpDec));
             }
 
-            /* wake builder – it will only process if something is loaded */
-            wakeEvt.signal();
+            /* queue a rebuild – it will only process if something is loaded */
+            requestRebuild();
         }
 
         /* ===== parameter ================================================== */
@@ -201,16 +726,132 @@ namespace project
                 if (std::abs(prev - v) > 1e-6)
                 {
                     mix.store(v);
-                    wakeEvt.signal();
+                    requestRebuild();
+                }
+            }
+            else if constexpr (P >= ParamWeight && P < ParamOffset)
+            {
+                const float w = (float)v;
+                if (weight[P - ParamWeight].exchange(w) != w)
+                    requestRebuild();
+            }
+            else if constexpr (P >= ParamOffset && P < ParamReverse)
+            {
+                const int o = (int)v;
+                if (frameOffset[P - ParamOffset].exchange(o) != o)
+                    requestRebuild();
+            }
+            else if constexpr (P >= ParamReverse && P < ParamMode)
+            {
+                const bool r = v > 0.5;
+                if (reverse[P - ParamReverse].exchange(r) != r)
+                    requestRebuild();
+            }
+            else if constexpr (P == ParamMode)
+            {
+                const int m = (v > 0.5) ? BlendMode_SPECTRAL : BlendMode_CROSSFADE;
+                if (blendMode.exchange(m) != m)
+                    requestRebuild();
+            }
+            else if constexpr (P == ParamSource)
+            {
+                const int s = (v > 0.5) ? Source_ADDITIVE : Source_FILES;
+                if (source.exchange(s) != s)
+                {
+                    // first selection allocates the harmonic data
+                    if (s == Source_ADDITIVE) storeEditFrame();
+                    requestRebuild();
                 }
             }
+            else if constexpr (P == ParamEditFrame)
+            {
+                // load the frame into the packs so the next edit starts from it
+                const int f = jlimit(0, MaxFrames - 1, (int)v);
+                if (editFrame.exchange(f) != f)
+                    loadEditFrame(f);
+            }
+            else if constexpr (P == ParamImportFrameLength)
+            {
+                importFrameLength.store((int)v);     // used by the next import
+            }
+            else if constexpr (P == ParamImportMode)
+            {
+                importMode.store((v > 0.5) ? ImportMode_SLICE : ImportMode_FRAMES);   // next load
+            }
+            else if constexpr (P == ParamDcRemove)
+            {
+                setConditionFlags(gw5::FrameConditioner::Flag_DC, (v > 0.5) ? gw5::FrameConditioner::Flag_DC : 0);
+            }
+            else if constexpr (P == ParamNormalize)
+            {
+                const int n = jlimit((int)Normalize_OFF, (int)Normalize_RMS, (int)(v + 0.5));
+                setConditionFlags(gw5::FrameConditioner::Flag_PEAK | gw5::FrameConditioner::Flag_RMS,
+                    n == Normalize_PEAK ? gw5::FrameConditioner::Flag_PEAK
+                    : n == Normalize_RMS ? gw5::FrameConditioner::Flag_RMS : 0);
+            }
+            else if constexpr (P == ParamAlignZero)
+            {
+                setConditionFlags(gw5::FrameConditioner::Flag_ALIGN, (v > 0.5) ? gw5::FrameConditioner::Flag_ALIGN : 0);
+            }
         }
 
         void createParameters(ParameterDataList& ps)
         {
-            parameter::data p("Mix", { 0.0, 1.0 });
-            p.setDefaultValue(0.5);
-            registerCallback<0>(p);
+            {
+                parameter::data p("Mix", { 0.0, 1.0 });
+                p.setDefaultValue(0.5);
+                registerCallback<0>(p);
+                ps.add(std::move(p));
+            }
+            createInputParameters(ps, std::make_integer_sequence<int, NumAudioFiles>());
+            {
+                parameter::data p("Blend Mode", { 0.0, 1.0, 1.0 });
+                p.setParameterValueNames({ "Crossfade", "Spectral" });
+                p.setDefaultValue(BlendMode_CROSSFADE);
+                registerCallback<ParamMode>(p);
+                ps.add(std::move(p));
+            }
+            {
+                parameter::data p("Source", { 0.0, 1.0, 1.0 });
+                p.setParameterValueNames({ "Files", "Additive" });
+                p.setDefaultValue(Source_FILES);
+                registerCallback<ParamSource>(p);
+                ps.add(std::move(p));
+            }
+            addParameter<ParamEditFrame>(ps, "Edit Frame", 0.0, MaxFrames - 1.0, 1.0, 0.0);
+            addParameter<ParamImportFrameLength>(ps, "Import Frame Length", 0.0, 8192.0, 1.0, 0.0);
+            {
+                parameter::data p("Import Mode", { 0.0, 1.0, 1.0 });
+                p.setParameterValueNames({ "Frames", "Slice" });
+                p.setDefaultValue(ImportMode_FRAMES);
+                registerCallback<ParamImportMode>(p);
+                ps.add(std::move(p));
+            }
+            addParameter<ParamDcRemove>(ps, "DC Remove", 0.0, 1.0, 1.0, 0.0);
+            {
+                parameter::data p("Normalize", { 0.0, 2.0, 1.0 });
+                p.setParameterValueNames({ "Off", "Peak", "RMS" });
+                p.setDefaultValue(Normalize_OFF);
+                registerCallback<ParamNormalize>(p);
+                ps.add(std::move(p));
+            }
+            addParameter<ParamAlignZero>(ps, "Align Zero", 0.0, 1.0, 1.0, 0.0);
+        }
+
+        template <int... K>
+        void createInputParameters(ParameterDataList& ps, std::integer_sequence<int, K...>)
+        {
+            (addParameter<ParamWeight + K>(ps, "Weight " + String(K + 1), 0.0, 1.0, 0.001, 1.0), ...);
+            (addParameter<ParamOffset + K>(ps, "Offset " + String(K + 1), 0.0, MaxFrames - 1.0, 1.0, 0.0), ...);
+            (addParameter<ParamReverse + K>(ps, "Reverse " + String(K + 1), 0.0, 1.0, 1.0, 0.0), ...);
+        }
+
+        template <int P>
+        void addParameter(ParameterDataList& ps, const String& name, double lo, double hi, double step, double def)
+        {
+            parameter::data p(name, { lo, hi, step });
+            p.setDefaultValue(def);
+            registerCallback<P>(p);
             ps.add(std::move(p));
         }
 
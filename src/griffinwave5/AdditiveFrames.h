@@ -0,0 +1,233 @@
+// AdditiveFrames.h   (procedural frames from harmonic amplitude / phase)
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "JobPool.h"
+#include "MemStats.h"
+#include "MipMapFlt.hpp"
+#include "SpectralMip.h"
+#include "Trace.h"
+
+namespace gw5
+{
+    /*
+    ==============================================================================
+    Name: AdditiveFrames
+    Purpose: Wavetable described per frame by harmonic amplitudes and phases
+             (harmonic h is amp * sin(h * w + phase * 2pi)). Frames are turned
+             into mip levels directly (SpectralMip: per-level inverse FFT with
+             the harmonics above the level's Nyquist dropped).
+             Edits are tracked per frame; build() copies the previous pyramid
+             and regenerates only the frames edited since, so an edit costs a
+             pyramid copy plus its own frames instead of the full pipeline.
+             Starts as 256 sines. The harmonic data (about 2 MB) is only
+             allocated on the first setFrame() or build(), so an owner that
+             never selects the additive source doesn't pay for it.
+    ==============================================================================
+    */
+    class AdditiveFrames final
+    {
+    public:
+        enum { FRAMES_PER_CHUNK = 8 };
+
+        AdditiveFrames(int frameSize, int nbrFrames)
+            : _frameSize(frameSize)
+            , _nbrFrames(nbrFrames)
+            , _nbrHarm(frameSize / 2 - 1)
+            , _editGen(nbrFrames, 1)
+            , _builtGen(nbrFrames, 0)
+        {
+            MemStats::instance().add(MemStats::Category_WAVEMAKER, getMemoryBytes());
+        }
+
+        ~AdditiveFrames()
+        {
+            MemStats::instance().add(MemStats::Category_WAVEMAKER, -getMemoryBytes());
+        }
+
+
+        int getNbrHarmonics() const noexcept { return _nbrHarm; }
+
+        /* amp / phase may be shorter than getNbrHarmonics() (rest is 0) or
+           null; phase is in cycles (0..1) */
+        void setFrame(int f, const float amp[], int nbrAmp, const float phase[], int nbrPhase)
+        {
+            if (f < 0 || f >= _nbrFrames)
+                return;
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            allocateLocked();
+            float* a = &_amp[size_t(f) * _nbrHarm];
+            float* p = &_phase[size_t(f) * _nbrHarm];
+            for (int h = 0; h < _nbrHarm; ++h)
+            {
+                a[h] = (amp != nullptr && h < nbrAmp) ? amp[h] : 0.0f;
+                p[h] = (phase != nullptr && h < nbrPhase) ? phase[h] : 0.0f;
+            }
+            ++_editGen[f];
+        }
+
+        /* copies frame f into amp / phase (up to the given lengths) */
+        void getFrame(int f, float amp[], int nbrAmp, float phase[], int nbrPhase) const
+        {
+            if (f < 0 || f >= _nbrFrames)
+                return;
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_amp.empty())
+            {
+                // not allocated yet: every frame is still the plain sine
+                for (int h = 0; h < nbrAmp; ++h)   amp[h] = (h == 0) ? 1.0f : 0.0f;
+                for (int h = 0; h < nbrPhase; ++h) phase[h] = 0.0f;
+                return;
+            }
+            const float* a = &_amp[size_t(f) * _nbrHarm];
+            const float* p = &_phase[size_t(f) * _nbrHarm];
+            for (int h = 0; h < nbrAmp; ++h)   amp[h] = (h < _nbrHarm) ? a[h] : 0.0f;
+            for (int h = 0; h < nbrPhase; ++h) phase[h] = (h < _nbrHarm) ? p[h] : 0.0f;
+        }
+
+        /* Pyramid with every frame up to date; the last one is returned as is
+           when nothing changed. nullptr if the job was cancelled, in which
+           case the edits stay pending. */
+        std::shared_ptr<const MipMapFlt> build(int nbrTables, const JobPool::Job& job)
+        {
+            GW5_TRACE_SCOPE("AdditiveFrames::build");
+
+            /* snapshot of the edited frames */
+            std::vector<int>      frames;
+            std::vector<uint32_t> gens;
+            std::vector<float>    amp, phase;
+            std::shared_ptr<const MipMapFlt> base;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                allocateLocked();
+                base = _last;
+                if (base != nullptr && base->get_nbr_tables() != nbrTables)
+                    base = nullptr;
+
+                for (int f = 0; f < _nbrFrames; ++f)
+                {
+                    if (base != nullptr && _editGen[f] == _builtGen[f])
+                        continue;
+                    frames.push_back(f);
+                    gens.push_back(_editGen[f]);
+                    amp.insert(amp.end(), _amp.begin() + size_t(f) * _nbrHarm, _amp.begin() + size_t(f + 1) * _nbrHarm);
+                    phase.insert(phase.end(), _phase.begin() + size_t(f) * _nbrHarm, _phase.begin() + size_t(f + 1) * _nbrHarm);
+                }
+            }
+
+            if (frames.empty())
+                return base;
+
+            /* copy-on-write: the live pyramid is never touched */
+            std::shared_ptr<MipMapFlt> mp;
+            if (base != nullptr)
+            {
+                GW5_TRACE_SCOPE("AdditiveFrames::copy");
+                mp = std::make_shared<MipMapFlt>();
+                mp->init_sample_direct_from(*base);
+            }
+            else
+            {
+                mp = SpectralMip::create(_frameSize, _nbrFrames, nbrTables);
+            }
+
+            std::atomic<bool> cancelled{ false };
+            JobPool::instance().parallelFor(int(frames.size()), [&](int begin, int end)
+            {
+                GW5_TRACE_SCOPE("AdditiveFrames::frames");
+
+                const int bins = _frameSize / 2 + 1;
+                SpectralMip::Scratch scratch(_frameSize, nbrTables);
+                std::vector<float>   re(bins), im(bins);
+
+                for (int i = begin; i < end; ++i)
+                {
+                    if (job.isCancelled())
+                    {
+                        cancelled.store(true, std::memory_order_relaxed);
+                        return;
+                    }
+                    toSpectrum(&amp[size_t(i) * _nbrHarm], &phase[size_t(i) * _nbrHarm], re.data(), im.data());
+                    SpectralMip::writeFrame(*mp, frames[i], re.data(), im.data(), scratch);
+                }
+            }, FRAMES_PER_CHUNK);
+
+            if (cancelled.load(std::memory_order_relaxed))
+                return nullptr;
+
+            mp->commit_direct();
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (size_t i = 0; i < frames.size(); ++i)
+                _builtGen[frames[i]] = gens[i];
+            _last = mp;
+            return _last;
+        }
+
+        int64_t getMemoryBytes() const noexcept
+        {
+            return static_cast<int64_t>((_amp.capacity() + _phase.capacity()) * sizeof(float)
+                + (_editGen.capacity() + _builtGen.capacity()) * sizeof(uint32_t));
+        }
+
+    private:
+        /* first use: 256 sines */
+        void allocateLocked()
+        {
+            if (!_amp.empty())
+                return;
+
+            const int64_t before = getMemoryBytes();
+            _amp.assign(size_t(_nbrFrames) * _nbrHarm, 0.0f);
+            _phase.assign(size_t(_nbrFrames) * _nbrHarm, 0.0f);
+            for (int f = 0; f < _nbrFrames; ++f)
+                _amp[size_t(f) * _nbrHarm] = 1.0f;
+            MemStats::instance().add(MemStats::Category_WAVEMAKER, getMemoryBytes() - before);
+        }
+
+        /* bins 0..frameSize/2 matching FftReal::forward() of the frame */
+        void toSpectrum(const float amp[], const float phase[], float re[], float im[]) const noexcept
+        {
+            const float  half = 0.5f * float(_frameSize);
+            const double twoPi = 6.283185307179586;
+
+            re[0] = 0.0f;
+            im[0] = 0.0f;
+            for (int h = 0; h < _nbrHarm; ++h)
+            {
+                const double ph = twoPi * phase[h];
+                re[h + 1] = half * amp[h] * float(std::sin(ph));
+                im[h + 1] = -half * amp[h] * float(std::cos(ph));
+            }
+            for (int h = _nbrHarm + 1; h <= _frameSize / 2; ++h)
+            {
+                re[h] = 0.0f;
+                im[h] = 0.0f;
+            }
+        }
+
+        const int             _frameSize;
+        const int             _nbrFrames;
+        const int             _nbrHarm;     // below Nyquist
+
+        mutable std::mutex    _mutex;       // frame data and generations
+        std::vector<float>    _amp;         // [frame][harmonic], empty until first used
+        std::vector<float>    _phase;       // [frame][harmonic], cycles
+        std::vector<uint32_t> _editGen;     // per frame, bumped on edit
+        std::vector<uint32_t> _builtGen;    // per frame, in _last
+        std::shared_ptr<const MipMapFlt> _last;
+
+        AdditiveFrames(const AdditiveFrames&) = delete;
+        AdditiveFrames& operator=(const AdditiveFrames&) = delete;
+    };
+
+} // namespace gw5
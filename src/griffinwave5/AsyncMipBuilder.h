@@ -1,28 +1,65 @@
 // AsyncMipBuilder.h   (fixed 1-May-2025)
 #pragma once
 
-#include <JuceHeader.h>
 #include <atomic>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <cstring>
 
+#include "Denormals.h"
 #include "InterpPack.h"
+#include "JobPool.h"
+#include "MemStats.h"
 #include "MipMapFlt.hpp"
 #include "ResamplerFlt.h"
+#include "Trace.h"
 
 namespace gw5
 {
     /*
     ==============================================================================
     Name: AsyncMipBuilder
-    Purpose: Single background thread that converts a *tripled* wavetable block
-             into a ready-to-use MipMapFlt and publishes it lock-free.
+    Purpose: Converts a *tripled* wavetable block into a ready-to-use MipMapFlt
+             on the shared JobPool and publishes it lock-free. Commits are
+             debounced: the build starts BUILD_DELAY_MS after the first commit
+             it covers, later commits are folded into the same build.
+             The build holds the slot lock only while it copies the slot into
+             the new pyramid's level 0; the FIR pass runs after it is
+             released, so writers and configure() never wait for a build.
     ==============================================================================
     */
     class AsyncMipBuilder final
     {
     public:
+        static constexpr double BUILD_DELAY_MS = 60.0;
+
+        /* producer: holds the slot lock from construction until commit(), so a
+           build never reads a half-written slot. nbrChn > 1 makes the slot an
+           interleaved multichannel table (grown on first use). */
+        class SlotWriter
+        {
+        public:
+            explicit SlotWriter(AsyncMipBuilder& b, int nbrChn = 1)
+                : _owner(b), _lock(b._slotMutex)
+            {
+                _owner.setSlotChannels(nbrChn);
+            }
+
+            float* data() const noexcept { return _owner._slot.data(); }
+
+            /* returns the generation number of this commit (first is 1) */
+            uint64_t commit()
+            {
+                _lock.unlock();
+                return _owner.commitSlot();
+            }
+
+        private:
+            AsyncMipBuilder&             _owner;
+            std::unique_lock<std::mutex> _lock;
+        };
+
         /* singleton access */
         static AsyncMipBuilder& instance() noexcept
         {
@@ -30,23 +67,46 @@ namespace gw5
             return s;
         }
 
-        /* configure once at startup */
-        void configure(long tripLen, int mipLevels) noexcept
+        /* configure once at startup; calls with the same layout return
+           without taking the slot lock */
+        void configure(long tripLen, int mipLevels)
         {
+            if (_configLen.load(std::memory_order_acquire) == tripLen
+                && _configLevels.load(std::memory_order_acquire) == mipLevels)
+                return;
+
+            std::lock_guard<std::mutex> lock(_slotMutex);
             _tripLen = tripLen;
             _mipLevels = mipLevels;
-            _slot.resize(static_cast<size_t>(tripLen));
+
+            const int64_t before = getSlotBytes();
+            _slot.resize(static_cast<size_t>(tripLen) * _slotChn);
+            MemStats::instance().add(MemStats::Category_BUILDER_SLOT, getSlotBytes() - before);
+            _configLevels.store(mipLevels, std::memory_order_release);
+            _configLen.store(tripLen, std::memory_order_release);
         }
 
         /* producer  WaveMaker worker thread */
-        float* writeSlot() noexcept { return _slot.data(); }
-        void   commitSlot() noexcept
+        SlotWriter writeSlot(int nbrChn = 1) { return SlotWriter(*this, nbrChn); }
+
+        /* producer with a ready pyramid (levels filled directly, no slot, no
+           FIR pass): counts as a commit and supersedes pending slot builds.
+           Returns the generation number. */
+        uint64_t publish(std::shared_ptr<const MipMapFlt> mp)
         {
-            _lastTouch.store(Time::getMillisecondCounterHiRes(),
-                std::memory_order_release);
-            _slotReady.store(true, std::memory_order_release);
+            const uint64_t gen = _commitGen.fetch_add(1, std::memory_order_acq_rel) + 1;
+            JobPool::instance().cancel(this, true);
+
+            updateBuildPeak();
+            _activeGen.store(gen, std::memory_order_release);
+            std::atomic_store(&_active, std::move(mp));
+            _buildCount.fetch_add(1, std::memory_order_relaxed);
+            return gen;
         }
 
+        long getTableLength() const noexcept { return _tripLen; }
+        int  getMipLevels() const noexcept { return _mipLevels; }
+
         /* consumer  audio / render threads */
         std::shared_ptr<const MipMapFlt> current() const noexcept
         {
@@ -64,83 +124,157 @@ namespace gw5
         /* diagnostic */
         bool isBuilding() const noexcept { return _building.load(std::memory_order_acquire); }
 
+        /* latest commit generation, and the one the latest published table was
+           built from (commits in between were superseded before being built).
+           The generation is stored before the table is published. */
+        uint64_t getCommitGeneration() const noexcept { return _commitGen.load(std::memory_order_acquire); }
+        uint64_t getActiveGeneration() const noexcept { return _activeGen.load(std::memory_order_acquire); }
+        uint64_t getBuildCount() const noexcept { return _buildCount.load(std::memory_order_relaxed); }
+
+        /* memory accounting */
+        int64_t getSlotBytes() const noexcept
+        {
+            return static_cast<int64_t>(_slot.capacity() * sizeof(float));
+        }
+
+        int64_t getActiveTableBytes() const noexcept
+        {
+            auto mp = current();
+            return mp ? mp->get_mem_bytes() : 0;
+        }
+
+        /* highest process total seen while a new pyramid coexisted with the old one */
+        int64_t getBuildPeakBytes() const noexcept { return _buildPeak.load(std::memory_order_relaxed); }
+
     private:
-        AsyncMipBuilder() : _worker(*this) {}
-        ~AsyncMipBuilder() = default;            // <-- override removed
+        AsyncMipBuilder()
+        {
+            JobPool::instance();                 // outlives the builder
+        }
+
+        ~AsyncMipBuilder()
+        {
+            JobPool::instance().cancel(this, true);
+        }
 
         AsyncMipBuilder(const AsyncMipBuilder&) = delete;
         AsyncMipBuilder& operator=(const AsyncMipBuilder&) = delete;
 
+        /* slot lock held */
+        void setSlotChannels(int nbrChn)
+        {
+            if (nbrChn == _slotChn)
+                return;
+
+            const int64_t before = getSlotBytes();
+            _slotChn = nbrChn;
+            _slot.resize(static_cast<size_t>(_tripLen) * _slotChn);
+            MemStats::instance().add(MemStats::Category_BUILDER_SLOT, getSlotBytes() - before);
+        }
+
+        uint64_t commitSlot()
+        {
+            const uint64_t gen = _commitGen.fetch_add(1, std::memory_order_acq_rel) + 1;
+            JobPool::instance().submit([this](const JobPool::Job&) { build(); },
+                JobPool::Priority_HIGH, this, BUILD_DELAY_MS);
+            return gen;
+        }
+
         /* ----------------------------------------------------------------- */
-        /* background worker                                                 */
+        /* build job                                                         */
         /* ----------------------------------------------------------------- */
-        class Worker : public juce::Thread
+        void build()
         {
-        public:
-            explicit Worker(AsyncMipBuilder& o)
-                : juce::Thread("MipBuilder"), owner(o)
+            GW5_TRACE_SCOPE("MipBuilder::build");
+            ScopedNoDenormals noDenormals;
+
+            _building.store(true, std::memory_order_release);
+
+            long len;
+            int  levels;
+            int  chn;
             {
-                startThread(1);   // lowest priority
+                std::lock_guard<std::mutex> lock(_slotMutex);
+                len = _tripLen;
+                levels = _mipLevels;
+                chn = _slotChn;
+            }
+            if (len < 2)
+            {
+                _building.store(false, std::memory_order_release);
+                return;                                  // not configured
             }
 
-            void run() override
+            /* allocation, unlocked */
+            auto mp = std::make_shared<MipMapFlt>();
             {
-                for (;;)
+                GW5_TRACE_SCOPE("MipBuilder::init");
+                mp->init_sample(len,
+                    InterpPack::get_len_pre(),
+                    InterpPack::get_len_post(),
+                    levels,
+                    ResamplerFlt::_fir_mip_map_coef_arr,
+                    ResamplerFlt::MIP_MAP_FIR_LEN,
+                    chn);
+            }
+
+            /* copy under the lock: every sample but the last, so the
+               pyramid is not filtered yet */
+            uint64_t gen;
+            std::vector<float> last(static_cast<size_t>(chn));
+            {
+                GW5_TRACE_SCOPE("MipBuilder::copy");
+                std::lock_guard<std::mutex> lock(_slotMutex);
+                if (_tripLen != len || _slotChn != chn)
                 {
-                    if (threadShouldExit())
-                        return;
-
-                    if (!owner._slotReady.load(std::memory_order_acquire))
-                    {
-                        juce::Thread::sleep(5);
-                        continue;
-                    }
-
-                    auto now = Time::getMillisecondCounterHiRes();
-                    auto last = owner._lastTouch.load(std::memory_order_acquire);
-                    if (now - last < 60.0)
-                    {
-                        juce::Thread::sleep(5);
-                        continue;
-                    }
-
-                    owner._slotReady.store(false, std::memory_order_release);
-                    owner._building.store(true, std::memory_order_release);
-
-                    /* build mip directly from producer slot */
-                    auto mp = std::make_shared<MipMapFlt>();
-                    mp->init_sample(owner._tripLen,
-                        InterpPack::get_len_pre(),
-                        InterpPack::get_len_post(),
-                        owner._mipLevels,
-                        ResamplerFlt::_fir_mip_map_coef_arr,
-                        ResamplerFlt::MIP_MAP_FIR_LEN);
-                    mp->fill_sample(owner._slot.data(), owner._tripLen);
-
-                    std::atomic_store(&owner._active, std::shared_ptr<const MipMapFlt>(mp));
-
-                    owner._building.store(false, std::memory_order_release);
+                    _building.store(false, std::memory_order_release);
+                    return;                              // reshaped meanwhile: its commit builds again
                 }
+                gen = _commitGen.load(std::memory_order_acquire);
+                mp->fill_sample(_slot.data(), len - 1);
+                std::memcpy(last.data(), _slot.data() + (len - 1) * chn, sizeof(float) * size_t(chn));
             }
 
-        private:
-            AsyncMipBuilder& owner;
-        };
+            /* the last sample completes level 0 and runs the FIR pass, unlocked */
+            {
+                GW5_TRACE_SCOPE("MipBuilder::fill");
+                mp->fill_sample(last.data(), 1);
+            }
+
+            updateBuildPeak();
+
+            _activeGen.store(gen, std::memory_order_release);
+            std::atomic_store(&_active, std::shared_ptr<const MipMapFlt>(mp));
+            _buildCount.fetch_add(1, std::memory_order_relaxed);
+
+            _building.store(false, std::memory_order_release);
+        }
+
+        void updateBuildPeak() noexcept
+        {
+            const int64_t total = MemStats::instance().total();
+            if (total > _buildPeak.load(std::memory_order_relaxed))
+                _buildPeak.store(total, std::memory_order_relaxed);
+        }
 
         /* ----------------------------------------------------------------- */
         /* shared state                                                      */
         /* ----------------------------------------------------------------- */
         std::vector<float>               _slot;        // producer buffer
+        std::mutex                       _slotMutex;   // producer vs build job
         std::shared_ptr<const MipMapFlt> _active;      // latest built mip
 
         std::atomic<bool>    _building{ false };
-        std::atomic<bool>    _slotReady{ false };
-        std::atomic<int64_t> _lastTouch{ 0 };
+        std::atomic<int64_t> _buildPeak{ 0 };
+        std::atomic<uint64_t> _commitGen{ 0 };
+        std::atomic<uint64_t> _activeGen{ 0 };
+        std::atomic<uint64_t> _buildCount{ 0 };
 
         long _tripLen = 0;
         int  _mipLevels = 0;
-
-        Worker _worker;
+        std::atomic<long> _configLen{ -1 };   // lock-free check in configure()
+        std::atomic<int>  _configLevels{ -1 };
+        int  _slotChn = 1;          // interleaved channels in _slot
     };
 
 } // namespace gw5
@@ -21,6 +21,7 @@
 
 #include	<cassert>
 #include	<cmath>
+#include	<cstring>
 
 namespace std {}
 
@@ -42,9 +43,11 @@ BaseVoiceState::BaseVoiceState ()
 ,	_table_len (0)
 ,	_table (0)
 ,	_ovrspl_flag (true)
+,	_blep_pos (0)
 {
 	_pos._all  = 0;
 	_step._all = static_cast <Int64> (0x80000000UL);
+	clear_blep ();
 }
 
 
@@ -60,11 +63,26 @@ BaseVoiceState &	BaseVoiceState::operator = (const BaseVoiceState &other)
 	_table       = other._table;
 	_ovrspl_flag = other._ovrspl_flag;
 
+	using namespace std;
+	memcpy (_blep_l, other._blep_l, sizeof (_blep_l));
+	memcpy (_blep_r, other._blep_r, sizeof (_blep_r));
+	_blep_pos    = other._blep_pos;
+
 	return (*this);
 }
 
 
 
+void	BaseVoiceState::clear_blep ()
+{
+	using namespace std;
+	memset (_blep_l, 0, sizeof (_blep_l));
+	memset (_blep_r, 0, sizeof (_blep_r));
+	_blep_pos = 0;
+}
+
+
+
 void	BaseVoiceState::compute_step (long pitch)
 {
 	assert (_table >= 0);
@@ -37,12 +37,14 @@ public:
 
 	enum {			NBR_BITS_PER_OCT	= 16	};
 	enum {			FADE_LEN				= 64	};
+	enum {			BLEP_LEN				= 16	};	// Hard-sync residual, interpolator samples
 
 						BaseVoiceState ();
 	BaseVoiceState &
 						operator = (const BaseVoiceState &other);
 
 	void				compute_step (long pitch);
+	void				clear_blep ();
 
 	Fixed3232		_pos;			// Position in the current MIP-map level
 	Fixed3232		_step;		// Step in the current MIP-map level
@@ -51,6 +53,12 @@ public:
 	int				_table;
 	bool				_ovrspl_flag;
 
+	// Band-limited step corrections still to be output, per channel. Read
+	// and cleared one slot per interpolated sample by the sync loops.
+	float				_blep_l [BLEP_LEN];
+	float				_blep_r [BLEP_LEN];
+	int				_blep_pos;
+
 
 
 /*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
@@ -77,6 +85,20 @@ private:
 
 
 
+/* Hard-sync master shared by the voices of a ResamplerFlt. The phase is the
+   position in the master cycle (0x100000000 = one cycle); each time it wraps
+   the slave restarts at _reset_pos. */
+class SyncState
+{
+public:
+
+	UInt32			_phase = 0;
+	UInt32			_step = 0;		// Per output sample, 0 = sync off
+	Int64				_reset_pos = 0;	// MIP-map level 0, 32:32
+};
+
+
+
 }	// namespace rspl
 
 
@@ -0,0 +1,13 @@
+// CoreUnity.cpp   (the gw5 core as one translation unit)
+//
+// The CMake build compiles the gw5 sources separately into the gw5 static
+// library and defines GW5_CORE_LIBRARY for everything that links it. Hosts
+// that only see headers (HISE compiles the nodes that way) include this file
+// once, from the node, instead.
+
+#pragma once
+
+#include "BaseVoiceState.cpp"
+#include "InterpPack.cpp"
+#include "ResamplerFlt.cpp"
+#include "Wave.cpp"
@@ -0,0 +1,183 @@
+// CpuFeatures.h   (run-time instruction set detection and kernel selection)
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#if defined (__x86_64__) || defined (_M_X64) || defined (__i386__) || defined (_M_IX86)
+    #define GW5_ISA_X86 1
+    #if defined (_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+    #include <immintrin.h>
+#else
+    #define GW5_ISA_X86 0
+#endif
+
+// GCC and Clang compile a function for a wider instruction set than the rest
+// of the build with a target attribute; flatten inlines the whole call tree
+// into it, so templates instantiated from there get the same code generation.
+// MSVC accepts the intrinsics anywhere and needs neither.
+#if GW5_ISA_X86 && (defined (__GNUC__) || defined (__clang__))
+    #define GW5_TARGET_AVX2     __attribute__ ((target ("avx2,fma")))
+    #define GW5_TARGET_AVX512   __attribute__ ((target ("avx512f,avx2,fma")))
+    #define GW5_FLATTEN         __attribute__ ((flatten))
+#else
+    #define GW5_TARGET_AVX2
+    #define GW5_TARGET_AVX512
+    #define GW5_FLATTEN
+#endif
+
+namespace gw5
+{
+    /*
+    ==============================================================================
+    Name: CpuFeatures
+    Purpose: Picks the kernel variant the DSP runs, once per process:
+               Isa_GENERIC   portable C++, whatever the build flags allow
+               Isa_AVX2      AVX2 + FMA
+               Isa_AVX512    AVX-512F
+             Detection uses cpuid and checks that the OS saves the wider
+             registers. The GW5_ISA environment variable (generic, avx2,
+             avx512) or force() select a lower variant for testing; neither
+             can select one the CPU doesn't have.
+    ==============================================================================
+    */
+    class CpuFeatures final
+    {
+    public:
+        enum Isa
+        {
+            Isa_GENERIC = 0,
+            Isa_AVX2,
+            Isa_AVX512,
+
+            Isa_NBR_ELT
+        };
+
+        /* best variant this CPU runs */
+        static Isa getDetected() noexcept
+        {
+            static const Isa isa = detect();
+            return isa;
+        }
+
+        /* variant the kernels use now */
+        static Isa getActive() noexcept
+        {
+            const int f = forced().load(std::memory_order_relaxed);
+            return (f >= 0) ? Isa(f) : getDefault();
+        }
+
+        /* Isa_NBR_ELT goes back to the automatic choice */
+        static void force(Isa isa) noexcept
+        {
+            const int f = (isa >= Isa_NBR_ELT) ? -1 : std::min(int(isa), int(getDetected()));
+            forced().store(f, std::memory_order_relaxed);
+        }
+
+        static const char* getName(Isa isa) noexcept
+        {
+            switch (isa)
+            {
+            case Isa_AVX2:   return "avx2";
+            case Isa_AVX512: return "avx512";
+            default:         return "generic";
+            }
+        }
+
+        static bool parse(const char* name, Isa& isa) noexcept
+        {
+            for (int i = 0; i < Isa_NBR_ELT; ++i)
+            {
+                if (std::strcmp(name, getName(Isa(i))) == 0)
+                {
+                    isa = Isa(i);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        static std::atomic<int>& forced() noexcept
+        {
+            static std::atomic<int> f{ -1 };
+            return f;
+        }
+
+        static Isa getDefault() noexcept
+        {
+            static const Isa isa = [] {
+                Isa d = getDetected();
+                Isa wanted;
+                const char* env = std::getenv("GW5_ISA");
+                if (env != nullptr && parse(env, wanted))
+                    d = std::min(d, wanted);
+                return d;
+                }();
+            return isa;
+        }
+
+        static Isa detect() noexcept
+        {
+#if GW5_ISA_X86
+            unsigned int r[4];
+            cpuid(r, 0, 0);
+            if (r[0] < 7)
+                return Isa_GENERIC;
+
+            cpuid(r, 1, 0);
+            const bool osxsave = (r[2] & (1u << 27)) != 0;
+            const bool avx = (r[2] & (1u << 28)) != 0;
+            const bool fma = (r[2] & (1u << 12)) != 0;
+            if (!osxsave || !avx || !fma)
+                return Isa_GENERIC;
+
+            const unsigned long long xcr0 = xgetbv();
+            if ((xcr0 & 0x06) != 0x06)          // XMM and YMM state
+                return Isa_GENERIC;
+
+            cpuid(r, 7, 0);
+            const bool avx2 = (r[1] & (1u << 5)) != 0;
+            const bool avx512f = (r[1] & (1u << 16)) != 0;
+            if (!avx2)
+                return Isa_GENERIC;
+            if (avx512f && (xcr0 & 0xE6) == 0xE6) // + opmask and ZMM state
+                return Isa_AVX512;
+            return Isa_AVX2;
+#else
+            return Isa_GENERIC;
+#endif
+        }
+
+#if GW5_ISA_X86
+        static void cpuid(unsigned int r[4], unsigned int leaf, unsigned int sub) noexcept
+        {
+    #if defined (_MSC_VER)
+            int v[4];
+            __cpuidex(v, int(leaf), int(sub));
+            for (int i = 0; i < 4; ++i) r[i] = unsigned(v[i]);
+    #else
+            __cpuid_count(leaf, sub, r[0], r[1], r[2], r[3]);
+    #endif
+        }
+
+        static unsigned long long xgetbv() noexcept
+        {
+    #if defined (_MSC_VER)
+            return _xgetbv(0);
+    #else
+            unsigned int lo, hi;
+            __asm__ volatile ("xgetbv" : "=a" (lo), "=d" (hi) : "c" (0));
+            return (static_cast<unsigned long long>(hi) << 32) | lo;
+    #endif
+        }
+#endif
+    };
+
+} // namespace gw5
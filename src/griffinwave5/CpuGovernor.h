@@ -0,0 +1,205 @@
+// CpuGovernor.h   (render time vs. block deadline -> quality level)
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "Trace.h"
+
+namespace gw5
+{
+    /*
+    ==============================================================================
+    Name: CpuGovernor
+    Purpose: Times a node's render of every block against the block's
+             deadline (block length / sample rate) and turns the result into a
+             degradation level the node applies to its voices:
+               Level_FULL    full quality
+               Level_SLICE   longer control slices (less per-slice setup)
+               Level_KERNEL  + 1x interpolation kernels, no downsampler
+               Level_OSC2    + second oscillators dropped
+               Level_STEAL   + quietest voices stolen, one per HOLD_BLOCKS,
+                             while both the smoothed and the last block's
+                             load stay above budget
+             Load is the render time as a fraction of the deadline, smoothed
+             upward fast and downward slowly. A level is added as soon as the
+             smoothed load exceeds the budget (at most one per HOLD_BLOCKS) and
+             removed after RECOVER_MS below RECOVER_RATIO x budget.
+             The policy (on/off, budget, deepest level) is set by the node's
+             parameters; the stats are lock-free so a UI or a log can poll
+             them from any thread.
+    ==============================================================================
+    */
+    class CpuGovernor final
+    {
+    public:
+        enum Level
+        {
+            Level_FULL = 0,
+            Level_SLICE,
+            Level_KERNEL,
+            Level_OSC2,
+            Level_STEAL,
+
+            Level_NBR_ELT
+        };
+
+        static constexpr int    HOLD_BLOCKS = 4;        // min. blocks between two steps down in quality or two steals
+        static constexpr double RECOVER_MS = 500.0;     // headroom needed this long before stepping back up
+        static constexpr float  RECOVER_RATIO = 0.6f;
+        static constexpr float  RISE = 0.25f;           // smoothing of a rising load
+        static constexpr float  FALL = 0.05f;           // smoothing of a falling load
+
+        struct Stats
+        {
+            float         load = 0.0f;                  // smoothed, fraction of the deadline
+            float         peak = 0.0f;                  // highest single block since reset
+            int           level = Level_FULL;
+            std::uint32_t overloads = 0;                // blocks above the deadline
+            std::uint32_t steals = 0;
+        };
+
+        using Clock = std::chrono::steady_clock;
+
+        void prepare(double sampleRate)
+        {
+            _sr = std::max(1.0, sampleRate);
+            reset();
+        }
+
+        void reset() noexcept
+        {
+            _load = 0.0f;
+            _hold = 0;
+            _stealHold = 0;
+            _recoverSpl = 0.0;
+            _level.store(Level_FULL, std::memory_order_relaxed);
+            _statLoad.store(0.0f, std::memory_order_relaxed);
+            _statPeak.store(0.0f, std::memory_order_relaxed);
+            _overloads.store(0, std::memory_order_relaxed);
+            _steals.store(0, std::memory_order_relaxed);
+        }
+
+        void setEnabled(bool flag) noexcept
+        {
+            _enabled = flag;
+            if (!flag) _level.store(Level_FULL, std::memory_order_relaxed);
+        }
+
+        /* share of the block deadline this node may use */
+        void setBudget(float fraction) noexcept { _budget = std::clamp(fraction, 0.01f, 1.0f); }
+
+        /* deepest level the governor may go to */
+        void setMaxLevel(int level) noexcept
+        {
+            _maxLevel = std::clamp(level, int(Level_FULL), int(Level_NBR_ELT) - 1);
+            if (getLevel() > _maxLevel) _level.store(_maxLevel, std::memory_order_relaxed);
+        }
+
+        bool isEnabled() const noexcept { return _enabled; }
+        int  getLevel() const noexcept { return _level.load(std::memory_order_relaxed); }
+
+        /* at Level_STEAL: true when the smoothed load is over budget and the
+           last block still was (the smoothed load falls slowly, so it alone
+           would keep stealing after the steals already worked), at most once
+           per HOLD_BLOCKS so a stolen voice has faded before the next */
+        bool wantsSteal() const noexcept
+        {
+            return getLevel() >= Level_STEAL && _stealHold == 0
+                && _load > _budget && _lastLoad > _budget;
+        }
+
+        void noteSteal() noexcept
+        {
+            _stealHold = HOLD_BLOCKS;
+            _steals.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        Clock::time_point beginBlock() const noexcept { return Clock::now(); }
+
+        void endBlock(Clock::time_point start, int nbrSpl) noexcept
+        {
+            if (nbrSpl <= 0)
+                return;
+
+            const double spent = std::chrono::duration<double>(Clock::now() - start).count();
+            const float  load = float(spent * _sr / double(nbrSpl));
+            _lastLoad = load;
+
+            _load += (load - _load) * (load > _load ? RISE : FALL);
+            _statLoad.store(_load, std::memory_order_relaxed);
+            if (load > _statPeak.load(std::memory_order_relaxed))
+                _statPeak.store(load, std::memory_order_relaxed);
+            if (load > 1.0f)
+                _overloads.fetch_add(1, std::memory_order_relaxed);
+
+            if (!_enabled)
+                return;
+
+            int level = getLevel();
+            if (_hold > 0)
+                --_hold;
+            if (_stealHold > 0)
+                --_stealHold;
+
+            if (_load > _budget)
+            {
+                _recoverSpl = 0.0;
+                if (_hold == 0 && level < _maxLevel)
+                {
+                    ++level;
+                    _hold = HOLD_BLOCKS;
+                }
+            }
+            else if (_load < _budget * RECOVER_RATIO && level > Level_FULL)
+            {
+                _recoverSpl += nbrSpl;
+                if (_recoverSpl >= RECOVER_MS * 0.001 * _sr)
+                {
+                    --level;
+                    _recoverSpl = 0.0;
+                }
+            }
+            else
+            {
+                _recoverSpl = 0.0;
+            }
+
+            if (level != getLevel())
+                GW5_TRACE_COUNTER("CpuGovernor::level", level);
+            _level.store(level, std::memory_order_relaxed);
+        }
+
+        Stats getStats() const noexcept
+        {
+            Stats s;
+            s.load = _statLoad.load(std::memory_order_relaxed);
+            s.peak = _statPeak.load(std::memory_order_relaxed);
+            s.level = getLevel();
+            s.overloads = _overloads.load(std::memory_order_relaxed);
+            s.steals = _steals.load(std::memory_order_relaxed);
+            return s;
+        }
+
+    private:
+        double _sr = 44100.0;
+        bool   _enabled = false;
+        float  _budget = 0.5f;
+        int    _maxLevel = Level_STEAL;
+
+        float  _load = 0.0f;
+        float  _lastLoad = 0.0f;
+        int    _hold = 0;
+        int    _stealHold = 0;
+        double _recoverSpl = 0.0;
+
+        std::atomic<int>           _level{ Level_FULL };
+        std::atomic<float>         _statLoad{ 0.0f };
+        std::atomic<float>         _statPeak{ 0.0f };
+        std::atomic<std::uint32_t> _overloads{ 0 };
+        std::atomic<std::uint32_t> _steals{ 0 };
+    };
+
+} // namespace gw5
@@ -2,9 +2,11 @@
 
 Class halving the sample rate (2x-downsampler) with the help of a polyphase
 IIR low-pass filter. It is used by ResamplerFlt, but can be used alone.
-The number of coefficients is hardwired to 7 in this implementation. Check
-the Artur Krukowski's webpage (http://www.cmsa.wmin.ac.uk/~artur/Poly.html)
-to know more about the filter coefficients to submit.
+The number of coefficients is hardwired to 7 in this implementation, or to
+3 for the low-latency variant (wider transition band, about half the group
+delay). Check the Artur Krukowski's webpage
+(http://www.cmsa.wmin.ac.uk/~artur/Poly.html) to know more about the filter
+coefficients to submit.
 
 *Tab=3***********************************************************************/
 
@@ -28,6 +30,7 @@ class Downsampler2Flt
 /*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
 public:
     enum { NBR_COEFS = 7 };
+    enum { NBR_COEFS_SHORT = 3 };
 
     /*
     ==============================================================================
@@ -49,13 +52,16 @@ public:
     ==============================================================================
     Name: set_coefs
     Description:
-      Set the filter coefficients.
+      Set the filter coefficients. Changing the number of coefficients clears
+      the state buffer.
     Input parameters:
       - coef_ptr: pointer on the array containing the coefficients.
+      - nbr_coefs: NBR_COEFS or NBR_COEFS_SHORT.
     Throws: Nothing
     ==============================================================================
     */
-    inline void set_coefs (const double coef_ptr [NBR_COEFS]);
+    inline void set_coefs (const double coef_ptr [], int nbr_coefs = NBR_COEFS);
+    inline int get_nbr_coefs () const;
 
     /*
     ==============================================================================
@@ -118,6 +124,7 @@ private:
     float _coef_arr [NBR_COEFS];
     float _x_arr    [2];
     float _y_arr    [NBR_COEFS];
+    int   _nbr_coefs;
 
     /*
     ==============================================================================
@@ -132,7 +139,8 @@ private:
     Throws: Nothing
     ==============================================================================
     */
-    inline rspl_FORCEINLINE float process_sample (float path_0, float path_1);
+    rspl_FORCEINLINE float process_sample (float path_0, float path_1);
+    rspl_FORCEINLINE float process_sample_short (float path_0, float path_1);
 
 /*\\\ FORBIDDEN MEMBER FUNCTIONS \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
 private:
@@ -150,21 +158,33 @@ inline Downsampler2Flt::Downsampler2Flt ()
 : _coef_arr ()
 , _x_arr    ()
 , _y_arr    ()
+, _nbr_coefs (NBR_COEFS)
 {
     _coef_arr [0] = static_cast <float> (CHK_COEFS_NOT_SET);
     clear_buffers ();
 }
 
-inline void Downsampler2Flt::set_coefs (const double coef_ptr [NBR_COEFS])
+inline void Downsampler2Flt::set_coefs (const double coef_ptr [], int nbr_coefs)
 {
     assert (coef_ptr != nullptr);
-    for (int mem = 0; mem < NBR_COEFS; ++mem)
+    assert (nbr_coefs == NBR_COEFS || nbr_coefs == NBR_COEFS_SHORT);
+    for (int mem = 0; mem < nbr_coefs; ++mem)
     {
         const float coef = static_cast <float> (coef_ptr [mem]);
         assert (coef > 0.0f);
         assert (coef < 1.0f);
         _coef_arr [mem] = coef;
     }
+    if (nbr_coefs != _nbr_coefs)
+    {
+        _nbr_coefs = nbr_coefs;
+        clear_buffers ();
+    }
+}
+
+inline int Downsampler2Flt::get_nbr_coefs () const
+{
+    return (_nbr_coefs);
 }
 
 inline void Downsampler2Flt::clear_buffers ()
@@ -185,6 +205,19 @@ inline void Downsampler2Flt::downsample_block (float dest_ptr [], const float sr
     assert (nbr_spl > 0);
 
     long pos = 0;
+    if (_nbr_coefs == NBR_COEFS_SHORT)
+    {
+        do
+        {
+            const float path_0 = src_ptr [pos * 2 + 1];
+            const float path_1 = src_ptr [pos * 2];
+            dest_ptr [pos]     = process_sample_short (path_0, path_1);
+            ++ pos;
+        }
+        while (pos < nbr_spl);
+        return;
+    }
+
     do
     {
         const float path_0 = src_ptr [pos * 2 + 1];
@@ -203,27 +236,29 @@ inline void Downsampler2Flt::phase_block (float dest_ptr [], const float src_ptr
     assert (nbr_spl   > 0);
 
     long pos = 0;
-    do
+    if (_nbr_coefs == NBR_COEFS_SHORT)
     {
-        float path_1 = src_ptr [pos];
-        dest_ptr [pos] = process_sample (0.0f, path_1);
-        ++ pos;
+        do
+        {
+            float path_1 = src_ptr [pos];
+            dest_ptr [pos] = process_sample_short (0.0f, path_1);
+            ++ pos;
+        }
+        while (pos < nbr_spl);
+    }
+    else
+    {
+        do
+        {
+            float path_1 = src_ptr [pos];
+            dest_ptr [pos] = process_sample (0.0f, path_1);
+            ++ pos;
+        }
+        while (pos < nbr_spl);
     }
-    while (pos < nbr_spl);
-
-    // Kills denormals on path 0, if any. Theoretically we just need to do it
-    // on results of multiplications with coefficients < 0.5.
-    _y_arr [0] += ANTI_DENORMAL_FLT;
-    _y_arr [2] += ANTI_DENORMAL_FLT;
-    _y_arr [4] += ANTI_DENORMAL_FLT;
-    _y_arr [6] += ANTI_DENORMAL_FLT;
-    _y_arr [0] -= ANTI_DENORMAL_FLT;
-    _y_arr [2] -= ANTI_DENORMAL_FLT;
-    _y_arr [4] -= ANTI_DENORMAL_FLT;
-    _y_arr [6] -= ANTI_DENORMAL_FLT;
 }
 
-inline rspl_FORCEINLINE float Downsampler2Flt::process_sample (float path_0, float path_1)
+rspl_FORCEINLINE float Downsampler2Flt::process_sample (float path_0, float path_1)
 {
     float tmp_0 = _x_arr [0];
     float tmp_1 = _x_arr [1];
@@ -257,6 +292,26 @@ inline rspl_FORCEINLINE float Downsampler2Flt::process_sample (float path_0, flo
     return (path_0 + path_1);
 }
 
+rspl_FORCEINLINE float Downsampler2Flt::process_sample_short (float path_0, float path_1)
+{
+    float tmp_0 = _x_arr [0];
+    float tmp_1 = _x_arr [1];
+    _x_arr [0]  = path_0;
+    _x_arr [1]  = path_1;
+
+    path_0 = (path_0 - _y_arr [0]) * _coef_arr [0] + tmp_0;
+    path_1 = (path_1 - _y_arr [1]) * _coef_arr [1] + tmp_1;
+    tmp_0   = _y_arr [0];
+    _y_arr [0] = path_0;
+    _y_arr [1] = path_1;
+
+    path_0 = (path_0 - _y_arr [2]) * _coef_arr [2] + tmp_0;
+    _y_arr [2] = path_0;
+
+    assert (NBR_COEFS_SHORT == 3);
+    return (path_0 + path_1);
+}
+
 } // namespace rspl
 
 #endif // rspl_Downsampler2_HEADER_INCLUDED
@@ -0,0 +1,129 @@
+// FftReal.h   (radix-2 FFT of real frames)
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace gw5
+{
+    /*
+    ==============================================================================
+    Name: FftReal
+    Purpose: Forward / inverse DFT of one real frame, length a power of 2 (1 is
+             allowed). Iterative radix-2 on a double precision work buffer so a
+             spectrum can go through several inverse sizes without drift.
+             One instance per thread: the work buffer is not shared.
+    ==============================================================================
+    */
+    class FftReal final
+    {
+    public:
+        explicit FftReal(int len)
+            : _len(len)
+            , _bitrev(len)
+            , _cos(std::max(len / 2, 1))
+            , _sin(std::max(len / 2, 1))
+            , _re(len)
+            , _im(len)
+        {
+            assert(len > 0 && (len & (len - 1)) == 0);
+
+            int bits = 0;
+            while ((1 << bits) < len) ++bits;
+            for (int i = 0; i < len; ++i)
+            {
+                int r = 0;
+                for (int b = 0; b < bits; ++b)
+                    r |= ((i >> b) & 1) << (bits - 1 - b);
+                _bitrev[i] = r;
+            }
+
+            const double w = 6.283185307179586 / double(len);
+            for (int k = 0; k < len / 2; ++k)
+            {
+                _cos[k] = std::cos(w * k);
+                _sin[k] = std::sin(w * k);
+            }
+        }
+
+        int get_len() const noexcept { return _len; }
+
+        /* bins 0..len/2 of the unnormalised DFT */
+        void forward(const float x[], float re[], float im[]) noexcept
+        {
+            for (int i = 0; i < _len; ++i)
+            {
+                _re[_bitrev[i]] = x[i];
+                _im[_bitrev[i]] = 0.0;
+            }
+            transform(false);
+            for (int h = 0; h <= _len / 2; ++h)
+            {
+                re[h] = float(_re[h]);
+                im[h] = float(_im[h]);
+            }
+        }
+
+        /* inverse of forward(), 1/len scale included; takes bins 0..len/2 and
+           mirrors the rest, DC and Nyquist are taken as real */
+        void inverse(const float re[], const float im[], float x[]) noexcept
+        {
+            const int half = _len / 2;
+            for (int h = 0; h < _len; ++h)
+            {
+                double r, i;
+                if (h <= half) { r = re[h];        i = im[h]; }
+                else           { r = re[_len - h]; i = -im[_len - h]; }
+                if (h == 0 || h == half) i = 0.0;
+
+                _re[_bitrev[h]] = r;
+                _im[_bitrev[h]] = i;
+            }
+            transform(true);
+            const double scale = 1.0 / double(_len);
+            for (int i = 0; i < _len; ++i)
+                x[i] = float(_re[i] * scale);
+        }
+
+    private:
+        /* input already in bit-reversed order */
+        void transform(bool inv) noexcept
+        {
+            const double sign = inv ? 1.0 : -1.0;
+            for (int size = 2; size <= _len; size <<= 1)
+            {
+                const int half = size >> 1;
+                const int step = _len / size;
+                for (int start = 0; start < _len; start += size)
+                {
+                    for (int k = 0; k < half; ++k)
+                    {
+                        const double wr = _cos[k * step];
+                        const double wi = _sin[k * step] * sign;
+                        const int a = start + k;
+                        const int b = a + half;
+                        const double tr = _re[b] * wr - _im[b] * wi;
+                        const double ti = _re[b] * wi + _im[b] * wr;
+                        _re[b] = _re[a] - tr;
+                        _im[b] = _im[a] - ti;
+                        _re[a] += tr;
+                        _im[a] += ti;
+                    }
+                }
+            }
+        }
+
+        int                 _len;
+        std::vector<int>    _bitrev;
+        std::vector<double> _cos;
+        std::vector<double> _sin;
+        std::vector<double> _re;
+        std::vector<double> _im;
+
+        FftReal(const FftReal&) = delete;
+        FftReal& operator=(const FftReal&) = delete;
+    };
+
+} // namespace gw5
@@ -0,0 +1,171 @@
+// FrameConditioner.h   (per-frame DC / level / start-phase analysis)
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Trace.h"
+
+namespace gw5
+{
+    /* per-frame corrections of one input table; applied by the blend stages
+       while they read the frame, the table itself is never written */
+    struct FrameConditioning
+    {
+        std::vector<float> dc;        // subtracted before the gain, left / mono
+        std::vector<float> dcR;       // right channel of a stereo input
+        std::vector<float> gain;      // level correction
+        std::vector<int>   rotate;    // frame is read starting at this sample
+
+        explicit FrameConditioning(int nbrFrames = 0) { resize(nbrFrames); }
+
+        void resize(int nbrFrames)
+        {
+            dc.assign(size_t(nbrFrames), 0.0f);
+            dcR.assign(size_t(nbrFrames), 0.0f);
+            gain.assign(size_t(nbrFrames), 1.0f);
+            rotate.assign(size_t(nbrFrames), 0);
+        }
+
+        long long getMemBytes() const noexcept
+        {
+            return static_cast<long long>((dc.capacity() + dcR.capacity() + gain.capacity()) * sizeof(float)
+                + rotate.capacity() * sizeof(int));
+        }
+    };
+
+    /*
+    ==============================================================================
+    Name: FrameConditioner
+    Purpose: Measures every frame of an input once (when the input or the
+             settings change) and stores DC offset, normalising gain and the
+             rotation that starts the frame on an upward zero crossing. The
+             blend folds them into its per-frame weight and read offset, so
+             conditioning costs nothing per rebuild beyond a multiply-add and
+             nothing at all per voice. Stereo inputs get a DC per channel and
+             a shared gain / rotation so the image is kept.
+    ==============================================================================
+    */
+    class FrameConditioner final
+    {
+    public:
+        enum Flags
+        {
+            Flag_DC = 1,              // remove the frame mean
+            Flag_PEAK = 2,            // peak -> PEAK_TARGET
+            Flag_RMS = 4,             // RMS -> RMS_TARGET (wins over PEAK)
+            Flag_ALIGN = 8            // start on the upward zero crossing nearest 0
+        };
+
+        static constexpr float PEAK_TARGET = 1.0f;
+        static constexpr float RMS_TARGET = 0.5f;
+        static constexpr float MAX_GAIN = 64.0f;        // +36 dB
+        static constexpr float SILENCE = 1e-5f;         // frames below keep gain 1
+
+        /* r may be null (mono); frameSize must be a power of 2 */
+        static void analyse(const float l[], const float r[], int frameSize, int nbrFrames, int flags,
+            FrameConditioning& out)
+        {
+            GW5_TRACE_SCOPE("FrameConditioner::analyse");
+
+            out.resize(nbrFrames);
+            if (flags == 0)
+                return;
+
+            for (int f = 0; f < nbrFrames; ++f)
+            {
+                const float* fl = l + long(f) * frameSize;
+                const float* fr = (r != nullptr) ? r + long(f) * frameSize : nullptr;
+
+                const float dcL = (flags & Flag_DC) ? mean(fl, frameSize) : 0.0f;
+                const float dcR = (flags & Flag_DC) && fr != nullptr ? mean(fr, frameSize) : 0.0f;
+                out.dc[f] = dcL;
+                out.dcR[f] = dcR;
+
+                if (flags & (Flag_PEAK | Flag_RMS))
+                {
+                    float level, target;
+                    if (flags & Flag_RMS)
+                    {
+                        double e = energy(fl, frameSize, dcL);
+                        if (fr != nullptr)
+                            e = 0.5 * (e + energy(fr, frameSize, dcR));
+                        level = float(std::sqrt(e / frameSize));
+                        target = RMS_TARGET;
+                    }
+                    else
+                    {
+                        level = peak(fl, frameSize, dcL);
+                        if (fr != nullptr)
+                            level = std::max(level, peak(fr, frameSize, dcR));
+                        target = PEAK_TARGET;
+                    }
+                    out.gain[f] = (level > SILENCE) ? std::min(target / level, MAX_GAIN) : 1.0f;
+                }
+
+                if (flags & Flag_ALIGN)
+                    out.rotate[f] = upwardCrossing(fl, fr, frameSize, dcL, dcR);
+            }
+        }
+
+    private:
+        static float mean(const float x[], int n) noexcept
+        {
+            float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+            for (int i = 0; i < n; i += 4)
+            {
+                s0 += x[i];
+                s1 += x[i + 1];
+                s2 += x[i + 2];
+                s3 += x[i + 3];
+            }
+            return (s0 + s1 + s2 + s3) / float(n);
+        }
+
+        static double energy(const float x[], int n, float dc) noexcept
+        {
+            float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+            for (int i = 0; i < n; i += 4)
+            {
+                const float a = x[i] - dc, b = x[i + 1] - dc, c = x[i + 2] - dc, d = x[i + 3] - dc;
+                s0 += a * a;
+                s1 += b * b;
+                s2 += c * c;
+                s3 += d * d;
+            }
+            return double(s0) + s1 + s2 + s3;
+        }
+
+        static float peak(const float x[], int n, float dc) noexcept
+        {
+            float lo = x[0], hi = x[0];
+            for (int i = 1; i < n; ++i)
+            {
+                lo = std::min(lo, x[i]);
+                hi = std::max(hi, x[i]);
+            }
+            return std::max(hi - dc, dc - lo);
+        }
+
+        /* circular, on the channel sum; 0 if the frame never crosses */
+        static int upwardCrossing(const float l[], const float r[], int n, float dcL, float dcR) noexcept
+        {
+            auto at = [&](int i)
+            {
+                const int k = i & (n - 1);
+                return (r != nullptr) ? (l[k] - dcL) + (r[k] - dcR) : l[k] - dcL;
+            };
+
+            for (int d = 0; d <= n / 2; ++d)
+            {
+                if (at(d - 1) < 0.0f && at(d) >= 0.0f)
+                    return d & (n - 1);
+                if (d > 0 && at(-d - 1) < 0.0f && at(-d) >= 0.0f)
+                    return (-d) & (n - 1);
+            }
+            return 0;
+        }
+    };
+
+} // namespace gw5
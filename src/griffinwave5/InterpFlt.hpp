@@ -16,6 +16,7 @@ and the primary FIR interpolator (InterpFlt), fully inlined and header?only.
 
 /*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
 #include "rspl.hpp"
+#include "SimdKernels.h"
 #include <cassert>
 
 namespace gw5
@@ -25,17 +26,18 @@ namespace gw5
     This class implements one phase of the scaled FIR interpolator. It stores
     per?phase impulse and delta tables, and provides a convolve() method to
     compute a single?phase output given a fractional position.
+    LEN is the number of taps, 12 * SC unless a shorter kernel is wanted.
     *Tab=3***********************************************************************/
 #if ! defined (rspl_InterpFltPhase_HEADER_INCLUDED)
 #define rspl_InterpFltPhase_HEADER_INCLUDED
 
-    template <int SC>
+    template <int SC, int LEN = 12 * SC>
     class InterpFltPhase
     {
         /*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
     public:
         enum { SCALE = SC };
-        enum { FIR_LEN = 12 * SCALE };
+        enum { FIR_LEN = LEN };
 
         /*
         ==============================================================================
@@ -59,6 +61,22 @@ namespace gw5
         */
         rspl_FORCEINLINE float convolve(const float data_ptr[], float q) const;
 
+        /*
+        ==============================================================================
+        Name: convolve_stereo
+        Description:
+          Same as convolve() on interleaved stereo data (L R L R ...). Each tap
+          coefficient is computed once and applied to both channels.
+        Input parameters:
+          - data_ptr: Pointer to the left sample of the first tap (FIR_LEN frames).
+          - q:        Fractional coefficient (0 <= q < 1).
+        Output parameters:
+          - l, r:     Filtered values for this phase.
+        Throws: assert if not initialized.
+        ==============================================================================
+        */
+        rspl_FORCEINLINE void convolve_stereo(const float data_ptr[], float q, float& l, float& r) const;
+
         float _dif[FIR_LEN]; // Index inverted (Gd [FIR_LEN-1] first).
         float _imp[FIR_LEN]; // Index inverted.
 
@@ -82,17 +100,28 @@ namespace gw5
 #if ! defined (rspl_InterpFltPhase_CODEHEADER_INCLUDED)
 #define rspl_InterpFltPhase_CODEHEADER_INCLUDED
 
-    template <int SC>
-    InterpFltPhase<SC>::InterpFltPhase()
+    template <int SC, int LEN>
+    InterpFltPhase<SC, LEN>::InterpFltPhase()
     {
         _imp[0] = CHK_IMPULSE_NOT_SET;
     }
 
-    template <int SC>
-    rspl_FORCEINLINE float InterpFltPhase<SC>::convolve(const float data_ptr[], float /*q*/) const
+    template <int SC, int LEN>
+    rspl_FORCEINLINE float InterpFltPhase<SC, LEN>::convolve(const float data_ptr[], float q) const
     {
-        assert(false);
-        return (0.0f);
+        assert(_imp[0] != CHK_IMPULSE_NOT_SET);
+
+        // Generic length, same even/odd accumulation as the unrolled versions
+        float c_0 = 0.0f;
+        float c_1 = 0.0f;
+        for (int i = 0; i < FIR_LEN; i += 2)
+        {
+            c_0 += (_imp[i] + _dif[i] * q) * data_ptr[i];
+            c_1 += (_imp[i + 1] + _dif[i + 1] * q) * data_ptr[i + 1];
+        }
+        static_assert((FIR_LEN & 1) == 0, "Even number of taps expected");
+
+        return (c_0 + c_1);
     }
 
     template <>
@@ -153,6 +182,35 @@ namespace gw5
         return (c_0 + c_1);
     }
 
+    template <int SC, int LEN>
+    rspl_FORCEINLINE void InterpFltPhase<SC, LEN>::convolve_stereo(const float data_ptr[], float q, float& l, float& r) const
+    {
+        assert(_imp[0] != CHK_IMPULSE_NOT_SET);
+
+        // Coefficients duplicated to the data layout (c0 c0 c1 c1 ...), so the
+        // products are one contiguous dot product the compiler turns into
+        // 4-wide multiply-adds. Lanes 0/2 and 1/3 keep the even/odd tap
+        // pairing of convolve(): both channels match the mono path exactly.
+        float c[FIR_LEN * 2];
+        for (int i = 0; i < FIR_LEN; ++i)
+        {
+            const float v = _imp[i] + _dif[i] * q;
+            c[i * 2] = v;
+            c[i * 2 + 1] = v;
+        }
+
+        float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for (int i = 0; i < FIR_LEN * 2; i += 4)
+        {
+            acc[0] += c[i] * data_ptr[i];
+            acc[1] += c[i + 1] * data_ptr[i + 1];
+            acc[2] += c[i + 2] * data_ptr[i + 2];
+            acc[3] += c[i + 3] * data_ptr[i + 3];
+        }
+        l = acc[0] + acc[2];
+        r = acc[1] + acc[3];
+    }
+
 #endif // rspl_InterpFltPhase_CODEHEADER_INCLUDED
 
 
@@ -161,16 +219,17 @@ namespace gw5
     access" on the source sample.
     Template parameters:
      - SC: Scale of the FIR interpolator. Its length is 64 * 12 * SC.
+     - LEN: Number of taps, if not 12 * SC. Impulse length is 64 * LEN.
     *Tab=3***********************************************************************/
 #if ! defined (rspl_InterpFlt_HEADER_DECLARED)
 #define rspl_InterpFlt_HEADER_DECLARED
 
-    template <int SC = 1>
+    template <int SC = 1, int LEN = 12 * SC>
     class InterpFlt
     {
         /*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
     public:
-        typedef InterpFltPhase<SC> Phase;
+        typedef InterpFltPhase<SC, LEN> Phase;
         enum { SCALE = Phase::SCALE };
         enum { FIR_LEN = Phase::FIR_LEN };
         enum { NBR_PHASES_L2 = 6 };
@@ -214,12 +273,32 @@ namespace gw5
         Input parameters:
           - data_ptr: pointer to input samples (must cover FIR_LEN taps around pos).
           - frac_pos: 32?bit fixed?point fractional sample index.
+        Template parameters:
+          - K: simd:: kernel variant doing the convolution.
         Returns: Interpolated sample.
         Throws: assert if data_ptr == nullptr.
         ==============================================================================
         */
+        template <class K = simd::Generic>
         rspl_FORCEINLINE float interpolate(const float data_ptr[], UInt32 frac_pos) const;
 
+        /*
+        ==============================================================================
+        Name: interpolate_stereo
+        Description:
+          interpolate() on interleaved stereo data: one phase lookup and one
+          coefficient set for both channels.
+        Input parameters:
+          - data_ptr: pointer to the left sample of the integer position.
+          - frac_pos: 32-bit fixed-point fractional sample index.
+        Output parameters:
+          - l, r:     Interpolated samples.
+        Throws: assert if data_ptr == nullptr.
+        ==============================================================================
+        */
+        template <class K = simd::Generic>
+        rspl_FORCEINLINE void interpolate_stereo(const float data_ptr[], UInt32 frac_pos, float& l, float& r) const;
+
         /*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
     protected:
         /*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
@@ -242,15 +321,15 @@ namespace gw5
 #if ! defined (rspl_InterpFlt_CODEHEADER_INCLUDED)
 #define rspl_InterpFlt_CODEHEADER_INCLUDED
 
-    template <int SC>
-    InterpFlt<SC>::InterpFlt()
+    template <int SC, int LEN>
+    InterpFlt<SC, LEN>::InterpFlt()
         : _phase_arr()
     {
         // Nothing
     }
 
-    template <int SC>
-    void InterpFlt<SC>::set_impulse(const double imp_ptr[IMPULSE_LEN])
+    template <int SC, int LEN>
+    void InterpFlt<SC, LEN>::set_impulse(const double imp_ptr[IMPULSE_LEN])
     {
         assert(imp_ptr != nullptr);
         double next_coef_dbl = 0.0;
@@ -271,8 +350,9 @@ namespace gw5
         }
     }
 
-    template <int SC>
-    rspl_FORCEINLINE float InterpFlt<SC>::interpolate(const float data_ptr[], UInt32 frac_pos) const
+    template <int SC, int LEN>
+    template <class K>
+    rspl_FORCEINLINE float InterpFlt<SC, LEN>::interpolate(const float data_ptr[], UInt32 frac_pos) const
     {
         assert(data_ptr != nullptr);
         // q is made of the lower bits of the fractional position, scaled in the
@@ -284,7 +364,21 @@ namespace gw5
         const Phase& phase = _phase_arr[phase_index];
         // center the FIR window
         const int offset = -FIR_LEN / 2 + 1;
-        return phase.convolve(data_ptr + offset, q);
+        return K::convolve(phase, data_ptr + offset, q);
+    }
+
+    template <int SC, int LEN>
+    template <class K>
+    rspl_FORCEINLINE void InterpFlt<SC, LEN>::interpolate_stereo(const float data_ptr[], UInt32 frac_pos, float& l, float& r) const
+    {
+        assert(data_ptr != nullptr);
+
+        const float q_scl = 1.0f / (65536.0f * 65536.0f);
+        const float q = static_cast<float> (frac_pos << NBR_PHASES_L2) * q_scl;
+        const int phase_index = frac_pos >> (32 - NBR_PHASES_L2);
+        const Phase& phase = _phase_arr[phase_index];
+        const int offset = (-FIR_LEN / 2 + 1) * 2;
+        K::convolve_stereo(phase, data_ptr + offset, q, l, r);
     }
 
 #endif // rspl_InterpFlt_CODEHEADER_INCLUDED
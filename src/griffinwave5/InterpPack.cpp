@@ -21,9 +21,15 @@
 /*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
 
 #include	"BaseVoiceState.h"
+#include	"FftReal.h"
 #include	"InterpPack.h"
+#include	"MipMapFlt.hpp"
+#include	"SimdKernels.h"
 
-#include	<cassert>
+#include	<algorithm>
+#include	<cassert>
+#include	<cmath>
+#include	<vector>
 
 
 
@@ -39,18 +45,431 @@ namespace gw5
 InterpPack::InterpPack ()
 :	_interp_1x ()
 ,	_interp_2x ()
+,	_interp_1x_short ()
+,	_interp_2x_short ()
+,	_kernel_set (KernelSet_LINEAR)
 {
 	_interp_1x.set_impulse (_fir_1x_coef_arr);
 	_interp_2x.set_impulse (_fir_2x_coef_arr);
+
+	double			imp_1x_arr [InterpRate1xShort::IMPULSE_LEN];
+	make_short_impulse (
+		imp_1x_arr, InterpRate1xShort::FIR_LEN,
+		_fir_1x_coef_arr, InterpRate1x::FIR_LEN
+	);
+	_interp_1x_short.set_impulse (imp_1x_arr);
+
+	double			imp_2x_arr [InterpRate2xShort::IMPULSE_LEN];
+	make_short_impulse (
+		imp_2x_arr, InterpRate2xShort::FIR_LEN,
+		_fir_2x_coef_arr, InterpRate2x::FIR_LEN
+	);
+	_interp_2x_short.set_impulse (imp_2x_arr);
+}
+
+
+
+/*
+==============================================================================
+Name: set_kernel_set
+Description:
+	Selects the kernels used by all the interp_*() functions. Resamplers
+	attached to this pack must be attached again (ResamplerFlt::set_interp())
+	so their downsamplers follow.
+Input parameters:
+	- kernel_set: KernelSet_LINEAR or KernelSet_SHORT.
+Throws: Nothing
+==============================================================================
+*/
+
+void	InterpPack::set_kernel_set (KernelSet kernel_set)
+{
+	assert (kernel_set >= 0);
+	assert (kernel_set < KernelSet_NBR_ELT);
+
+	_kernel_set = kernel_set;
+}
+
+
+
+InterpPack::KernelSet	InterpPack::get_kernel_set () const
+{
+	return (_kernel_set);
 }
 
 
 
 void	InterpPack::interp_ovrspl (float dest_ptr [], long nbr_spl, BaseVoiceState &voice) const
+{
+	simd::dispatch ([&] (auto k)
+	{
+		using K = decltype (k);
+		if (_kernel_set == KernelSet_SHORT)
+		{
+			interp_mono <K> (_interp_2x_short, 0.5f, dest_ptr, nbr_spl, voice);
+		}
+		else
+		{
+			interp_mono <K> (_interp_2x, 0.5f, dest_ptr, nbr_spl, voice);
+		}
+	});
+}
+
+
+
+void	InterpPack::interp_norm (float dest_ptr [], long nbr_spl, BaseVoiceState &voice) const
+{
+	simd::dispatch ([&] (auto k)
+	{
+		using K = decltype (k);
+		if (_kernel_set == KernelSet_SHORT)
+		{
+			interp_mono <K> (_interp_1x_short, 1.0f, dest_ptr, nbr_spl, voice);
+		}
+		else
+		{
+			interp_mono <K> (_interp_1x, 1.0f, dest_ptr, nbr_spl, voice);
+		}
+	});
+}
+
+
+
+void	InterpPack::interp_ovrspl_ramp_add (float dest_ptr [], long nbr_spl, BaseVoiceState &voice, float vol, float vol_step) const
+{
+	assert (vol >= 0);
+	assert (vol <= 1);
+	assert (vol_step >= -1);
+	assert (vol_step <= 1);
+
+	vol *= 0.5;
+	vol_step *= 0.5;
+
+	simd::dispatch ([&] (auto k)
+	{
+		using K = decltype (k);
+		if (_kernel_set == KernelSet_SHORT)
+		{
+			interp_mono_ramp_add <K> (_interp_2x_short, dest_ptr, nbr_spl, 1, voice, vol, vol_step);
+		}
+		else
+		{
+			interp_mono_ramp_add <K> (_interp_2x, dest_ptr, nbr_spl, 1, voice, vol, vol_step);
+		}
+	});
+}
+
+
+
+void	InterpPack::interp_norm_ramp_add (float dest_ptr [], long nbr_spl, BaseVoiceState &voice, float vol, float vol_step) const
+{
+	assert (vol >= 0);
+	assert (vol <= 1);
+	assert (vol_step >= -1);
+	assert (vol_step <= 1);
+
+	vol_step *= 2;
+
+	simd::dispatch ([&] (auto k)
+	{
+		using K = decltype (k);
+		if (_kernel_set == KernelSet_SHORT)
+		{
+			interp_mono_ramp_add <K> (_interp_1x_short, dest_ptr, nbr_spl, 2, voice, vol, vol_step);
+		}
+		else
+		{
+			interp_mono_ramp_add <K> (_interp_1x, dest_ptr, nbr_spl, 2, voice, vol, vol_step);
+		}
+	});
+}
+
+
+
+void	InterpPack::interp_ovrspl_stereo (float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice) const
+{
+	simd::dispatch ([&] (auto k)
+	{
+		using K = decltype (k);
+		if (_kernel_set == KernelSet_SHORT)
+		{
+			interp_stereo <K> (_interp_2x_short, 0.5f, dest_l_ptr, dest_r_ptr, nbr_spl, voice);
+		}
+		else
+		{
+			interp_stereo <K> (_interp_2x, 0.5f, dest_l_ptr, dest_r_ptr, nbr_spl, voice);
+		}
+	});
+}
+
+
+
+void	InterpPack::interp_norm_stereo (float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice) const
+{
+	simd::dispatch ([&] (auto k)
+	{
+		using K = decltype (k);
+		if (_kernel_set == KernelSet_SHORT)
+		{
+			interp_stereo <K> (_interp_1x_short, 1.0f, dest_l_ptr, dest_r_ptr, nbr_spl, voice);
+		}
+		else
+		{
+			interp_stereo <K> (_interp_1x, 1.0f, dest_l_ptr, dest_r_ptr, nbr_spl, voice);
+		}
+	});
+}
+
+
+
+void	InterpPack::interp_ovrspl_ramp_add_stereo (float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice, float vol, float vol_step) const
+{
+	assert (vol >= 0);
+	assert (vol <= 1);
+	assert (vol_step >= -1);
+	assert (vol_step <= 1);
+
+	vol *= 0.5;
+	vol_step *= 0.5;
+
+	simd::dispatch ([&] (auto k)
+	{
+		using K = decltype (k);
+		if (_kernel_set == KernelSet_SHORT)
+		{
+			interp_stereo_ramp_add <K> (_interp_2x_short, dest_l_ptr, dest_r_ptr, nbr_spl, 1, voice, vol, vol_step);
+		}
+		else
+		{
+			interp_stereo_ramp_add <K> (_interp_2x, dest_l_ptr, dest_r_ptr, nbr_spl, 1, voice, vol, vol_step);
+		}
+	});
+}
+
+
+
+void	InterpPack::interp_norm_ramp_add_stereo (float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice, float vol, float vol_step) const
+{
+	assert (vol >= 0);
+	assert (vol <= 1);
+	assert (vol_step >= -1);
+	assert (vol_step <= 1);
+
+	vol_step *= 2;
+
+	simd::dispatch ([&] (auto k)
+	{
+		using K = decltype (k);
+		if (_kernel_set == KernelSet_SHORT)
+		{
+			interp_stereo_ramp_add <K> (_interp_1x_short, dest_l_ptr, dest_r_ptr, nbr_spl, 2, voice, vol, vol_step);
+		}
+		else
+		{
+			interp_stereo_ramp_add <K> (_interp_1x, dest_l_ptr, dest_r_ptr, nbr_spl, 2, voice, vol, vol_step);
+		}
+	});
+}
+
+
+
+/*
+==============================================================================
+Name: interp_ovrspl_sync, interp_norm_sync, interp_*_ramp_add_sync
+Description:
+	Hard-sync counterparts of the functions above, same rates and gains.
+	The master phase advances by sync._step per output sample (half of it
+	per oversampled sample); when it wraps, the slave position restarts at
+	sync._reset_pos, advanced by the time elapsed since the wrap, and the
+	jump is corrected with a band-limited step residual spread over the
+	next BLEP_LEN interpolated samples of the voice.
+Input parameters:
+	- dest_r_ptr: right output for interleaved stereo tables, 0 for mono.
+Input/output parameters:
+	- voice: slave position and pending residual.
+	- sync: master phase, advanced.
+Throws: Nothing
+==============================================================================
+*/
+
+void	InterpPack::interp_ovrspl_sync (float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice, SyncState &sync) const
+{
+	if (_kernel_set == KernelSet_SHORT)
+	{
+		interp_sync (_interp_2x_short, 0.5f, dest_l_ptr, dest_r_ptr, nbr_spl, 1, voice, sync, sync._step >> 1, false, 1.0f, 0.0f);
+	}
+	else
+	{
+		interp_sync (_interp_2x, 0.5f, dest_l_ptr, dest_r_ptr, nbr_spl, 1, voice, sync, sync._step >> 1, false, 1.0f, 0.0f);
+	}
+}
+
+
+
+void	InterpPack::interp_norm_sync (float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice, SyncState &sync) const
+{
+	if (_kernel_set == KernelSet_SHORT)
+	{
+		interp_sync (_interp_1x_short, 1.0f, dest_l_ptr, dest_r_ptr, nbr_spl, 1, voice, sync, sync._step, false, 1.0f, 0.0f);
+	}
+	else
+	{
+		interp_sync (_interp_1x, 1.0f, dest_l_ptr, dest_r_ptr, nbr_spl, 1, voice, sync, sync._step, false, 1.0f, 0.0f);
+	}
+}
+
+
+
+void	InterpPack::interp_ovrspl_ramp_add_sync (float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice, SyncState &sync, float vol, float vol_step) const
+{
+	assert (vol >= 0);
+	assert (vol <= 1);
+
+	if (_kernel_set == KernelSet_SHORT)
+	{
+		interp_sync (_interp_2x_short, 0.5f, dest_l_ptr, dest_r_ptr, nbr_spl, 1, voice, sync, sync._step >> 1, true, vol, vol_step);
+	}
+	else
+	{
+		interp_sync (_interp_2x, 0.5f, dest_l_ptr, dest_r_ptr, nbr_spl, 1, voice, sync, sync._step >> 1, true, vol, vol_step);
+	}
+}
+
+
+
+void	InterpPack::interp_norm_ramp_add_sync (float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice, SyncState &sync, float vol, float vol_step) const
+{
+	assert (vol >= 0);
+	assert (vol <= 1);
+
+	if (_kernel_set == KernelSet_SHORT)
+	{
+		interp_sync (_interp_1x_short, 1.0f, dest_l_ptr, dest_r_ptr, nbr_spl, 2, voice, sync, sync._step, true, vol, vol_step * 2);
+	}
+	else
+	{
+		interp_sync (_interp_1x, 1.0f, dest_l_ptr, dest_r_ptr, nbr_spl, 2, voice, sync, sync._step, true, vol, vol_step * 2);
+	}
+}
+
+
+
+/*
+==============================================================================
+Name: interp_ovrspl_dual
+Description:
+	interp_ovrspl() for two voices reading the same table, summed. Both
+	positions advance in the same loop, so the second oscillator of a synth
+	voice costs its multiply-adds only.
+Input parameters:
+	- dest_r_ptr: right output for interleaved stereo tables, 0 for mono.
+	- gain_b: level of voice_b relative to voice_a.
+Throws: Nothing
+==============================================================================
+*/
+
+void	InterpPack::interp_ovrspl_dual (float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice_a, BaseVoiceState &voice_b, float gain_b) const
+{
+	simd::dispatch ([&] (auto k)
+	{
+		using K = decltype (k);
+		if (_kernel_set == KernelSet_SHORT)
+		{
+			interp_dual <K> (_interp_2x_short, dest_l_ptr, dest_r_ptr, nbr_spl, voice_a, voice_b, gain_b);
+		}
+		else
+		{
+			interp_dual <K> (_interp_2x, dest_l_ptr, dest_r_ptr, nbr_spl, voice_a, voice_b, gain_b);
+		}
+	});
+}
+
+
+
+/*
+==============================================================================
+Name: interp_fm
+Description:
+	Linear FM, through zero: the step of output sample i is
+	step * (1 + depth * mod_ptr [i]) level-0 samples, and may be negative.
+	The position wraps inside [cycle_start, cycle_start + cycle_len) in both
+	directions. Each sample reads the MIP-map level where |step| is at most
+	1 (so the single-rate interpolator never aliases), blended into the next
+	level over the top of that range so level changes do not click.
+Input parameters:
+	- dest_r_ptr: right output for interleaved stereo tables, 0 for mono.
+	- spl: the sample, all levels.
+	- cycle_start, cycle_len: 32:32, level 0; cycle_len a power of 2.
+	- step: unmodulated step, level-0 samples per output sample.
+	- mod_ptr: modulator, nbr_spl values.
+	- depth: modulation index.
+Input/output parameters:
+	- pos: playback position, level 0, 32:32.
+Throws: Nothing
+==============================================================================
+*/
+
+void	InterpPack::interp_fm (float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, const MipMapFlt &spl, Int64 &pos, Int64 cycle_start, Int64 cycle_len, double step, const float mod_ptr [], float depth) const
+{
+	if (_kernel_set == KernelSet_SHORT)
+	{
+		fm_block (_interp_1x_short, dest_l_ptr, dest_r_ptr, nbr_spl, spl, pos, cycle_start, cycle_len, step, mod_ptr, depth);
+	}
+	else
+	{
+		fm_block (_interp_1x, dest_l_ptr, dest_r_ptr, nbr_spl, spl, pos, cycle_start, cycle_len, step, mod_ptr, depth);
+	}
+}
+
+
+
+long	InterpPack::get_len_pre (KernelSet kernel_set)
+{
+	assert (   static_cast <long> (InterpRate1x::FIR_LEN)
+	        >= static_cast <long> (InterpRate2x::FIR_LEN));
+	assert (   static_cast <long> (InterpRate1xShort::FIR_LEN)
+	        >= static_cast <long> (InterpRate2xShort::FIR_LEN));
+
+	if (kernel_set == KernelSet_SHORT)
+	{
+		return (static_cast <long> (InterpRate1xShort::FIR_LEN / 2));
+	}
+
+	return (static_cast <long> (InterpRate1x::FIR_LEN / 2));
+}
+
+
+
+long	InterpPack::get_len_post (KernelSet kernel_set)
+{
+	assert (   static_cast <long> (InterpRate1x::FIR_LEN)
+	        >= static_cast <long> (InterpRate2x::FIR_LEN));
+	assert (   static_cast <long> (InterpRate1xShort::FIR_LEN)
+	        >= static_cast <long> (InterpRate2xShort::FIR_LEN));
+
+	if (kernel_set == KernelSet_SHORT)
+	{
+		return (static_cast <long> (InterpRate1xShort::FIR_LEN / 2));
+	}
+
+	return (static_cast <long> (InterpRate1x::FIR_LEN / 2));
+}
+
+
+
+/*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+/*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+template <class K, class IF>
+void	InterpPack::interp_mono (const IF &interp, float scale, float dest_ptr [], long nbr_spl, BaseVoiceState &voice) const
 {
 	assert (dest_ptr != 0);
 	assert (nbr_spl > 0);
-	assert (&voice != 0);
 	assert (voice._table_ptr != 0);
 
 	long				cnt = 0;
@@ -58,7 +477,7 @@ void	InterpPack::interp_ovrspl (float dest_ptr [], long nbr_spl, BaseVoiceState
 	{
 		assert (voice._pos._part._msw < voice._table_len);
 
-		dest_ptr [cnt] = 0.5f * _interp_2x.interpolate (
+		dest_ptr [cnt] = scale * interp.template interpolate <K> (
 			voice._table_ptr + voice._pos._part._msw,
 			voice._pos._part._lsw
 		);
@@ -71,11 +490,12 @@ void	InterpPack::interp_ovrspl (float dest_ptr [], long nbr_spl, BaseVoiceState
 
 
 
-void	InterpPack::interp_norm (float dest_ptr [], long nbr_spl, BaseVoiceState &voice) const
+template <class K, class IF>
+void	InterpPack::interp_mono_ramp_add (const IF &interp, float dest_ptr [], long nbr_spl, long dest_step, BaseVoiceState &voice, float vol, float vol_step) const
 {
 	assert (dest_ptr != 0);
 	assert (nbr_spl > 0);
-	assert (&voice != 0);
+	assert (dest_step > 0);
 	assert (voice._table_ptr != 0);
 
 	long				cnt = 0;
@@ -83,109 +503,527 @@ void	InterpPack::interp_norm (float dest_ptr [], long nbr_spl, BaseVoiceState &v
 	{
 		assert (voice._pos._part._msw < voice._table_len);
 
-		dest_ptr [cnt] = _interp_1x.interpolate (
+		dest_ptr [cnt] += vol * interp.template interpolate <K> (
 			voice._table_ptr + voice._pos._part._msw,
 			voice._pos._part._lsw
 		);
 
 		voice._pos._all += voice._step._all;
-		++ cnt;
+		vol += vol_step;
+		cnt += dest_step;
 	}
 	while (cnt < nbr_spl);
 }
 
 
 
-void	InterpPack::interp_ovrspl_ramp_add (float dest_ptr [], long nbr_spl, BaseVoiceState &voice, float vol, float vol_step) const
+template <class K, class IF>
+void	InterpPack::interp_stereo (const IF &interp, float scale, float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice) const
 {
-	assert (dest_ptr != 0);
+	assert (dest_l_ptr != 0);
+	assert (dest_r_ptr != 0);
 	assert (nbr_spl > 0);
-	assert (&voice != 0);
 	assert (voice._table_ptr != 0);
-	assert (vol >= 0);
-	assert (vol <= 1);
-	assert (vol_step >= -1);
-	assert (vol_step <= 1);
 
-	vol *= 0.5;
-	vol_step *= 0.5;
+	long				cnt = 0;
+	do
+	{
+		assert (voice._pos._part._msw < voice._table_len);
+
+		float				l;
+		float				r;
+		interp.template interpolate_stereo <K> (
+			voice._table_ptr + voice._pos._part._msw * 2,
+			voice._pos._part._lsw,
+			l,
+			r
+		);
+		dest_l_ptr [cnt] = scale * l;
+		dest_r_ptr [cnt] = scale * r;
+
+		voice._pos._all += voice._step._all;
+		++ cnt;
+	}
+	while (cnt < nbr_spl);
+}
+
+
+
+template <class K, class IF>
+void	InterpPack::interp_stereo_ramp_add (const IF &interp, float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, long dest_step, BaseVoiceState &voice, float vol, float vol_step) const
+{
+	assert (dest_l_ptr != 0);
+	assert (dest_r_ptr != 0);
+	assert (nbr_spl > 0);
+	assert (dest_step > 0);
+	assert (voice._table_ptr != 0);
 
 	long				cnt = 0;
 	do
 	{
 		assert (voice._pos._part._msw < voice._table_len);
 
-		dest_ptr [cnt] += vol * _interp_2x.interpolate (
-			voice._table_ptr + voice._pos._part._msw,
-			voice._pos._part._lsw
+		float				l;
+		float				r;
+		interp.template interpolate_stereo <K> (
+			voice._table_ptr + voice._pos._part._msw * 2,
+			voice._pos._part._lsw,
+			l,
+			r
 		);
+		dest_l_ptr [cnt] += vol * l;
+		dest_r_ptr [cnt] += vol * r;
 
 		voice._pos._all += voice._step._all;
 		vol += vol_step;
-		++ cnt;
+		cnt += dest_step;
 	}
 	while (cnt < nbr_spl);
 }
 
 
 
-void	InterpPack::interp_norm_ramp_add (float dest_ptr [], long nbr_spl, BaseVoiceState &voice, float vol, float vol_step) const
+template <class K, class IF>
+void	InterpPack::interp_dual (const IF &interp, float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice_a, BaseVoiceState &voice_b, float gain_b) const
 {
-	assert (dest_ptr != 0);
+	assert (dest_l_ptr != 0);
+	assert (nbr_spl > 0);
+	assert (voice_a._table_ptr != 0);
+	assert (voice_b._table_ptr != 0);
+
+	const float		gain_a = 0.5f;
+	gain_b *= 0.5f;
+
+	long				cnt = 0;
+	if (dest_r_ptr == 0)
+	{
+		do
+		{
+			assert (voice_a._pos._part._msw < voice_a._table_len);
+			assert (voice_b._pos._part._msw < voice_b._table_len);
+
+			dest_l_ptr [cnt] =
+				  gain_a * interp.template interpolate <K> (
+					voice_a._table_ptr + voice_a._pos._part._msw,
+					voice_a._pos._part._lsw
+				)
+				+ gain_b * interp.template interpolate <K> (
+					voice_b._table_ptr + voice_b._pos._part._msw,
+					voice_b._pos._part._lsw
+				);
+
+			voice_a._pos._all += voice_a._step._all;
+			voice_b._pos._all += voice_b._step._all;
+			++ cnt;
+		}
+		while (cnt < nbr_spl);
+	}
+	else
+	{
+		do
+		{
+			assert (voice_a._pos._part._msw < voice_a._table_len);
+			assert (voice_b._pos._part._msw < voice_b._table_len);
+
+			float				la, ra, lb, rb;
+			interp.template interpolate_stereo <K> (
+				voice_a._table_ptr + voice_a._pos._part._msw * 2,
+				voice_a._pos._part._lsw,
+				la,
+				ra
+			);
+			interp.template interpolate_stereo <K> (
+				voice_b._table_ptr + voice_b._pos._part._msw * 2,
+				voice_b._pos._part._lsw,
+				lb,
+				rb
+			);
+			dest_l_ptr [cnt] = gain_a * la + gain_b * lb;
+			dest_r_ptr [cnt] = gain_a * ra + gain_b * rb;
+
+			voice_a._pos._all += voice_a._step._all;
+			voice_b._pos._all += voice_b._step._all;
+			++ cnt;
+		}
+		while (cnt < nbr_spl);
+	}
+}
+
+
+
+template <class IF>
+void	InterpPack::fm_block (const IF &interp, float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, const MipMapFlt &spl, Int64 &pos, Int64 cycle_start, Int64 cycle_len, double step, const float mod_ptr [], float depth) const
+{
+	assert (dest_l_ptr != 0);
+	assert (nbr_spl > 0);
+	assert (mod_ptr != 0);
+	assert (cycle_len > 0);
+	assert ((cycle_len & (cycle_len - 1)) == 0);
+	assert (pos >= cycle_start);
+	assert (pos < cycle_start + cycle_len);
+
+	using namespace std;
+
+	const bool		stereo_flag = (dest_r_ptr != 0);
+	const int		chn = stereo_flag ? 2 : 1;
+	const int		last = spl.get_nbr_tables () - 1;
+	const Int64		mask = cycle_len - 1;
+	const double	fix_mul = 4294967296.0;
+	const float		blend_beg = 0.7f;	// Of the level's |step| range
+
+	for (long cnt = 0; cnt < nbr_spl; ++cnt)
+	{
+		const double	inst = step * (1.0 + depth * mod_ptr [cnt]);
+		const double	mag = fabs (inst);
+
+		// Level where mag / 2^level is in (0.5, 1]
+		int				level = 0;
+		double			rate = mag;
+		if (mag > 1)
+		{
+			int				e;
+			rate = frexp (mag, &e);
+			level = e;
+			if (rate == 0.5)
+			{
+				-- level;
+				rate = 1;
+			}
+		}
+		if (level > last)
+		{
+			rate = ldexp (rate, level - last);
+			level = last;
+		}
+
+		float				l;
+		float				r = 0;
+		read_level (interp, spl, level, pos, chn, l, r);
+
+		const float		blend = (level < last) ? float (rate) - blend_beg : 0;
+		if (blend > 0)
+		{
+			float				l2;
+			float				r2 = 0;
+			read_level (interp, spl, level + 1, pos, chn, l2, r2);
+			const float		w = blend * (1 / (1 - blend_beg));
+			l += w * (l2 - l);
+			r += w * (r2 - r);
+		}
+
+		dest_l_ptr [cnt] = l;
+		if (stereo_flag)
+		{
+			dest_r_ptr [cnt] = r;
+		}
+
+		pos = cycle_start + ((pos - cycle_start + static_cast <Int64> (inst * fix_mul)) & mask);
+	}
+}
+
+
+
+template <class IF>
+void	InterpPack::interp_sync (const IF &interp, float scale, float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, long dest_step, BaseVoiceState &voice, SyncState &sync, UInt32 master_step, bool add_flag, float vol, float vol_step) const
+{
+	assert (dest_l_ptr != 0);
 	assert (nbr_spl > 0);
-	assert (&voice != 0);
 	assert (voice._table_ptr != 0);
-	assert (vol >= 0);
-	assert (vol <= 1);
-	assert (vol_step >= -1);
-	assert (vol_step <= 1);
+	assert (master_step > 0);
 
-	vol_step *= 2;
+	const bool		stereo_flag = (dest_r_ptr != 0);
+	const int		chn = stereo_flag ? 2 : 1;
+	const int		mask = BaseVoiceState::BLEP_LEN - 1;
 
 	long				cnt = 0;
 	do
 	{
+		const UInt32	prev_phase = sync._phase;
+		sync._phase += master_step;
+		if (sync._phase < prev_phase)
+		{
+			restart_slave (interp, scale, stereo_flag, voice, sync, master_step);
+		}
+
 		assert (voice._pos._part._msw < voice._table_len);
 
-		dest_ptr [cnt] += vol * _interp_1x.interpolate (
-			voice._table_ptr + voice._pos._part._msw,
-			voice._pos._part._lsw
-		);
+		const float *	data_ptr = voice._table_ptr + voice._pos._part._msw * chn;
+		const int		slot = voice._blep_pos;
+		voice._blep_pos = (slot + 1) & mask;
+
+		float				l;
+		float				r = 0;
+		if (stereo_flag)
+		{
+			interp.interpolate_stereo (data_ptr, voice._pos._part._lsw, l, r);
+			r = r * scale + voice._blep_r [slot];
+			voice._blep_r [slot] = 0;
+		}
+		else
+		{
+			l = interp.interpolate (data_ptr, voice._pos._part._lsw);
+		}
+		l = l * scale + voice._blep_l [slot];
+		voice._blep_l [slot] = 0;
+
+		if (add_flag)
+		{
+			dest_l_ptr [cnt] += vol * l;
+			if (stereo_flag)
+			{
+				dest_r_ptr [cnt] += vol * r;
+			}
+		}
+		else
+		{
+			dest_l_ptr [cnt] = l;
+			if (stereo_flag)
+			{
+				dest_r_ptr [cnt] = r;
+			}
+		}
 
 		voice._pos._all += voice._step._all;
 		vol += vol_step;
-		cnt += 2;
+		cnt += dest_step;
 	}
 	while (cnt < nbr_spl);
 }
 
 
 
-long	InterpPack::get_len_pre ()
+template <class IF>
+void	InterpPack::read_level (const IF &interp, const MipMapFlt &spl, int level, Int64 pos, int chn, float &l, float &r) const
 {
-	assert (   static_cast <long> (InterpRate1x::FIR_LEN)
-	        >= static_cast <long> (InterpRate2x::FIR_LEN));
+	Fixed3232		p;
+	p._all = pos >> level;
+	assert (p._part._msw < spl.get_lev_len (level));
 
-	return (static_cast <long> (InterpRate1x::FIR_LEN / 2));
+	const float *	data_ptr = spl.use_table (level) + p._part._msw * chn;
+	if (chn == 2)
+	{
+		interp.interpolate_stereo (data_ptr, p._part._lsw, l, r);
+	}
+	else
+	{
+		l = interp.interpolate (data_ptr, p._part._lsw);
+	}
 }
 
 
 
-long	InterpPack::get_len_post ()
+// The master wrapped tau samples before the current one: move the slave to
+// where it would be had it restarted then, and queue the residual of the
+// jump it makes, starting at tau.
+template <class IF>
+void	InterpPack::restart_slave (const IF &interp, float scale, bool stereo_flag, BaseVoiceState &voice, const SyncState &sync, UInt32 master_step) const
 {
-	assert (   static_cast <long> (InterpRate1x::FIR_LEN)
-	        >= static_cast <long> (InterpRate2x::FIR_LEN));
+	const int		chn = stereo_flag ? 2 : 1;
+	const double	tau = double (sync._phase) / double (master_step);
+	const Int64		elapsed = static_cast <Int64> (tau * double (voice._step._all));
+
+	Fixed3232		before;
+	Fixed3232		after;
+	before._all = voice._pos._all - elapsed;
+	after._all  = sync._reset_pos >> voice._table;
+	voice._pos._all = after._all + elapsed;
+
+	assert (before._part._msw >= 0);
+	assert (before._part._msw < voice._table_len);
+	assert (after._part._msw < voice._table_len);
+
+	float				jump_l;
+	float				jump_r = 0;
+	if (stereo_flag)
+	{
+		float				l0, r0, l1, r1;
+		interp.interpolate_stereo (voice._table_ptr + before._part._msw * chn, before._part._lsw, l0, r0);
+		interp.interpolate_stereo (voice._table_ptr + after._part._msw * chn, after._part._lsw, l1, r1);
+		jump_l = (l1 - l0) * scale;
+		jump_r = (r1 - r0) * scale;
+	}
+	else
+	{
+		jump_l = (  interp.interpolate (voice._table_ptr + after._part._msw, after._part._lsw)
+		          - interp.interpolate (voice._table_ptr + before._part._msw, before._part._lsw)) * scale;
+	}
 
-	return (static_cast <long> (InterpRate1x::FIR_LEN / 2));
+	// The naive signal already holds the new level from here on; the
+	// residual (blep - 1) moves it back to a band-limited step.
+	const float *	res_ptr = use_blep_residual ();
+	const int		mask = BaseVoiceState::BLEP_LEN - 1;
+	for (int k = 0; k < BaseVoiceState::BLEP_LEN; ++k)
+	{
+		const double	x = (tau + k) * BLEP_OVRSPL;
+		const int		i = static_cast <int> (x);
+		if (i >= BaseVoiceState::BLEP_LEN * BLEP_OVRSPL)
+		{
+			break;
+		}
+		const float		f = static_cast <float> (x - i);
+		const float		res = res_ptr [i] + f * (res_ptr [i + 1] - res_ptr [i]);
+		const int		slot = (voice._blep_pos + k) & mask;
+		voice._blep_l [slot] += jump_l * res;
+		voice._blep_r [slot] += jump_r * res;
+	}
 }
 
 
 
-/*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+/*
+==============================================================================
+Name: use_blep_residual
+Description:
+	Minimum-phase band-limited step minus the ideal step, BLEP_LEN samples
+	at BLEP_OVRSPL points per sample (plus a closing 0). Built once from a
+	Blackman-windowed sinc through the real cepstrum (Brandt's minBLEP).
+Returns: Pointer on the table, BLEP_LEN * BLEP_OVRSPL + 1 values.
+Throws: std::vector related exceptions, on first call.
+==============================================================================
+*/
 
+const float *	InterpPack::use_blep_residual ()
+{
+	static const std::vector <float>	res_arr = []
+	{
+		using namespace std;
+
+		const int		len = BaseVoiceState::BLEP_LEN * BLEP_OVRSPL;
+		const int		fft_len = len * 8;
+		const int		nbr_bins = fft_len / 2 + 1;
+
+		// Linear-phase impulse: sinc over the whole residual length
+		vector <float>	x (fft_len, 0.0f);
+		for (int i = 0; i < len; ++i)
+		{
+			const double	t = double (i - len / 2) / BLEP_OVRSPL;
+			const double	sinc = (t == 0) ? 1.0 : sin (PI * t) / (PI * t);
+			const double	w = double (i) / (len - 1);
+			const double	win = 0.42 - 0.5 * cos (2 * PI * w) + 0.08 * cos (4 * PI * w);
+			x [i] = static_cast <float> (sinc * win);
+		}
+
+		// Real cepstrum, folded onto positive quefrencies
+		FftReal			fft (fft_len);
+		vector <float>	re (nbr_bins);
+		vector <float>	im (nbr_bins);
+		fft.forward (&x [0], &re [0], &im [0]);
+		for (int h = 0; h < nbr_bins; ++h)
+		{
+			re [h] = static_cast <float> (log (max (hypot (double (re [h]), double (im [h])), 1e-9)));
+			im [h] = 0;
+		}
+		fft.inverse (&re [0], &im [0], &x [0]);
+		for (int i = 1; i < fft_len / 2; ++i)
+		{
+			x [i] *= 2;
+		}
+		for (int i = fft_len / 2 + 1; i < fft_len; ++i)
+		{
+			x [i] = 0;
+		}
+
+		// Back to a minimum-phase spectrum, then to time
+		fft.forward (&x [0], &re [0], &im [0]);
+		for (int h = 0; h < nbr_bins; ++h)
+		{
+			const double	mag = exp (double (re [h]));
+			const double	ph = im [h];
+			re [h] = static_cast <float> (mag * cos (ph));
+			im [h] = static_cast <float> (mag * sin (ph));
+		}
+		fft.inverse (&re [0], &im [0], &x [0]);
+
+		// Integrate to a step normalised to 1, keep the difference
+		double			sum = 0;
+		for (int i = 0; i < len; ++i)
+		{
+			sum += x [i];
+		}
+		vector <float>	res (len + 1, 0.0f);
+		double			acc = 0;
+		for (int i = 0; i < len; ++i)
+		{
+			acc += x [i];
+			res [i] = static_cast <float> (acc / sum - 1);
+		}
+		return res;
+	} ();
+
+	return (&res_arr [0]);
+}
 
 
-/*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+/*
+==============================================================================
+Name: make_short_impulse
+Description:
+	Derives a shorter kernel from one of the long ones: the central dest_len
+	taps, under a Kaiser window (beta 3), scaled to the same DC gain. The
+	cutoff of the source kernel is kept.
+Input parameters:
+	- dest_len: number of taps of the new kernel, even, <= src_len.
+	- src_ptr: source impulse, src_len * NBR_PHASES coefficients.
+	- src_len: number of taps of the source kernel.
+Output parameters:
+	- dest_ptr: new impulse, dest_len * NBR_PHASES coefficients.
+Throws: Nothing
+==============================================================================
+*/
+
+void	InterpPack::make_short_impulse (double dest_ptr [], long dest_len, const double src_ptr [], long src_len)
+{
+	assert (dest_ptr != 0);
+	assert (src_ptr != 0);
+	assert (dest_len > 0);
+	assert (dest_len <= src_len);
+	assert (((src_len - dest_len) & 1) == 0);
+
+	using namespace std;
+
+	const long		nbr_phases = InterpRate1x::NBR_PHASES;
+	const long		skip = (src_len - dest_len) / 2 * nbr_phases;
+	const long		imp_len = dest_len * nbr_phases;
+	const double	half = imp_len * 0.5;
+	const double	beta = 3.0;
+
+	// Zeroth-order modified Bessel function, power series
+	auto				bessel_i0 = [] (double x)
+	{
+		double			sum = 1;
+		double			term = 1;
+		for (int k = 1; term > 1e-12 * sum; ++k)
+		{
+			const double	h = x / (2 * k);
+			term *= h * h;
+			sum += term;
+		}
+		return sum;
+	};
+	const double	norm = 1 / bessel_i0 (beta);
+
+	double			sum_src = 0;
+	for (long pos = 0; pos < src_len * nbr_phases; ++pos)
+	{
+		sum_src += src_ptr [pos];
+	}
+
+	double			sum_dest = 0;
+	for (long pos = 0; pos < imp_len; ++pos)
+	{
+		const double	x = (pos - half) / half;
+		const double	win = bessel_i0 (beta * sqrt (max (1 - x * x, 0.0))) * norm;
+		dest_ptr [pos] = src_ptr [skip + pos] * win;
+		sum_dest += dest_ptr [pos];
+	}
+
+	const double	gain = sum_src / sum_dest;
+	for (long pos = 0; pos < imp_len; ++pos)
+	{
+		dest_ptr [pos] *= gain;
+	}
+}
 
 
 
@@ -16,6 +16,14 @@ Other public functions are for the sole ResamplerFlt's use
 Technically, it groups two flavours of interpolators, one for r >= 1
 (oversampled) and the other one for r < 1 (single rate).
 
+Two kernel sets are available. KernelSet_LINEAR is the original pair of long
+linear-phase kernels. KernelSet_SHORT uses kernels of half the support
+(12 and 8 taps), which need half the sample headroom and ring less around
+transients, at the cost of a slightly earlier roll-off and less image
+rejection. ResamplerFlt reads the set when the pack is attached and matches
+its downsampler to it. Change the set before attaching the pack, and build
+the MIP-maps with the headroom of the set in use (or the larger one).
+
 
 
 *Tab=3***********************************************************************/
@@ -44,6 +52,8 @@ namespace gw5
 
 
 class BaseVoiceState;
+class MipMapFlt;
+class SyncState;
 
 class InterpPack
 {
@@ -52,16 +62,50 @@ class InterpPack
 
 public:
 
+	enum KernelSet
+	{
+		KernelSet_LINEAR = 0,
+		KernelSet_SHORT,
+
+		KernelSet_NBR_ELT
+	};
+
 						InterpPack ();
 	virtual			~InterpPack () {}
 
+	void				set_kernel_set (KernelSet kernel_set);
+	KernelSet		get_kernel_set () const;
+
+	// The plain, ramp and dual block functions run the kernel variant
+	// CpuFeatures selected (SimdKernels.h); sync and FM use the generic one.
 	void				interp_ovrspl (float dest_ptr [], long nbr_spl, BaseVoiceState &voice) const;
 	void				interp_norm (float dest_ptr [], long nbr_spl, BaseVoiceState &voice) const;
 	void				interp_ovrspl_ramp_add (float dest_ptr [], long nbr_spl, BaseVoiceState &voice, float vol, float vol_step) const;
 	void				interp_norm_ramp_add (float dest_ptr [], long nbr_spl, BaseVoiceState &voice, float vol, float vol_step) const;
 
-	static long		get_len_pre ();
-	static long		get_len_post ();
+	// Interleaved stereo tables, one output buffer per channel
+	void				interp_ovrspl_stereo (float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice) const;
+	void				interp_norm_stereo (float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice) const;
+	void				interp_ovrspl_ramp_add_stereo (float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice, float vol, float vol_step) const;
+	void				interp_norm_ramp_add_stereo (float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice, float vol, float vol_step) const;
+
+	// Hard sync: the slave restarts whenever the master phase wraps, each
+	// restart is band-limited with a minBLEP residual. dest_r_ptr is 0 for
+	// mono tables.
+	void				interp_ovrspl_sync (float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice, SyncState &sync) const;
+	void				interp_norm_sync (float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice, SyncState &sync) const;
+	void				interp_ovrspl_ramp_add_sync (float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice, SyncState &sync, float vol, float vol_step) const;
+	void				interp_norm_ramp_add_sync (float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice, SyncState &sync, float vol, float vol_step) const;
+
+	// Two voices on the same table in one pass, second one scaled by gain_b
+	void				interp_ovrspl_dual (float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice_a, BaseVoiceState &voice_b, float gain_b) const;
+
+	// Linear through-zero FM: per-sample signed step, wrap inside one cycle,
+	// MIP-map level chosen from |step|. Positions are level 0, 32:32.
+	void				interp_fm (float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, const MipMapFlt &spl, Int64 &pos, Int64 cycle_start, Int64 cycle_len, double step, const float mod_ptr [], float depth) const;
+
+	static long		get_len_pre (KernelSet kernel_set = KernelSet_LINEAR);
+	static long		get_len_post (KernelSet kernel_set = KernelSet_LINEAR);
 
 
 
@@ -77,9 +121,42 @@ private:
 
 	typedef	InterpFlt <2>	InterpRate1x;
 	typedef	InterpFlt <1>	InterpRate2x;
+	typedef	InterpFlt <1>	InterpRate1xShort;
+	typedef	InterpFlt <1, 8>	InterpRate2xShort;
+
+	enum {			BLEP_OVRSPL	= 64	};	// Residual table points per sample
+
+	template <class K, class IF>
+	void				interp_mono (const IF &interp, float scale, float dest_ptr [], long nbr_spl, BaseVoiceState &voice) const;
+	template <class K, class IF>
+	void				interp_mono_ramp_add (const IF &interp, float dest_ptr [], long nbr_spl, long dest_step, BaseVoiceState &voice, float vol, float vol_step) const;
+	template <class K, class IF>
+	void				interp_stereo (const IF &interp, float scale, float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice) const;
+	template <class K, class IF>
+	void				interp_stereo_ramp_add (const IF &interp, float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, long dest_step, BaseVoiceState &voice, float vol, float vol_step) const;
+	template <class K, class IF>
+	void				interp_dual (const IF &interp, float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, BaseVoiceState &voice_a, BaseVoiceState &voice_b, float gain_b) const;
+	template <class IF>
+	void				fm_block (const IF &interp, float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, const MipMapFlt &spl, Int64 &pos, Int64 cycle_start, Int64 cycle_len, double step, const float mod_ptr [], float depth) const;
+	template <class IF>
+	void				interp_sync (const IF &interp, float scale, float dest_l_ptr [], float dest_r_ptr [], long nbr_spl, long dest_step, BaseVoiceState &voice, SyncState &sync, UInt32 master_step, bool add_flag, float vol, float vol_step) const;
+	template <class IF>
+	void				restart_slave (const IF &interp, float scale, bool stereo_flag, BaseVoiceState &voice, const SyncState &sync, UInt32 master_step) const;
+
+	static const float *
+						use_blep_residual ();
+	template <class IF>
+	rspl_FORCEINLINE void
+						read_level (const IF &interp, const MipMapFlt &spl, int level, Int64 pos, int chn, float &l, float &r) const;
+	static void		make_short_impulse (double dest_ptr [], long dest_len, const double src_ptr [], long src_len);
 
 	InterpRate1x	_interp_1x;		// Single-rate interpolation (larger imp.)
 	InterpRate2x	_interp_2x;		// For double-sampled interpolation
+	InterpRate1xShort
+						_interp_1x_short;
+	InterpRate2xShort
+						_interp_2x_short;
+	KernelSet		_kernel_set;
 
 	static const double
 						_fir_1x_coef_arr [InterpRate1x::IMPULSE_LEN];
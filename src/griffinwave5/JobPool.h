@@ -0,0 +1,388 @@
+// JobPool.h   (shared background job system)
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined (__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+#include "Denormals.h"
+#include "Trace.h"
+
+#if defined (_WIN64)
+extern "C" __declspec(dllimport) void* __stdcall GetCurrentThread(void);
+extern "C" __declspec(dllimport) unsigned long __stdcall GetCurrentProcessorNumber(void);
+extern "C" __declspec(dllimport) unsigned __int64 __stdcall SetThreadAffinityMask(void*, unsigned __int64);
+#endif
+
+namespace gw5
+{
+    /*
+    ==============================================================================
+    Name: JobPool
+    Purpose: One process-wide pool of worker threads shared by every node for
+             background work (blend, preview, mip build, file import).
+             - Bounded concurrency: a few workers regardless of instance count,
+               started on the first submit.
+             - Priorities: HIGH runs before NORMAL before LOW, FIFO within one.
+             - Keys: jobs submitted with the same key never run concurrently.
+               Submitting while a job with that key is still queued replaces
+               it (the earlier due time is kept, so a stream of submits can't
+               starve it); a running one is flagged as cancelled.
+             - Delays: a job may be held back for a while (debounce).
+             - parallelFor: splits an index range over the workers; the caller
+               takes part, so a job may use it without deadlocking the pool.
+             - Affinity: workers keep off the core the audio thread was last
+               seen on (Linux, Windows; a no-op elsewhere).
+    ==============================================================================
+    */
+    class JobPool final
+    {
+    public:
+        enum Priority
+        {
+            Priority_HIGH = 0,
+            Priority_NORMAL,
+            Priority_LOW,
+
+            Priority_NBR_ELT
+        };
+
+        /* handed to the job function; long jobs should poll isCancelled() */
+        class Job
+        {
+        public:
+            bool isCancelled() const noexcept { return _cancelled->load(std::memory_order_acquire); }
+
+        private:
+            friend class JobPool;
+            std::shared_ptr<std::atomic<bool>> _cancelled;
+        };
+
+        using Fn = std::function<void(const Job&)>;
+
+        /* singleton access */
+        static JobPool& instance()
+        {
+            static JobPool s;
+            return s;
+        }
+
+        /* must be called before the first submit to have an effect */
+        void setMaxWorkers(int n)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_workers.empty())
+                _maxWorkers = std::max(1, n);
+        }
+
+        int getMaxWorkers() const noexcept { return _maxWorkers; }
+
+        void submit(Fn fn, Priority prio = Priority_NORMAL, const void* key = nullptr, double delayMs = 0.0)
+        {
+            const auto due = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double, std::milli>(delayMs));
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            startWorkersLocked();
+
+            if (key != nullptr)
+            {
+                for (Running& r : _running)
+                    if (r.key == key)
+                        r.cancelled->store(true, std::memory_order_release);
+
+                for (Entry& e : _queue)
+                {
+                    if (e.key == key)
+                    {
+                        e.fn = std::move(fn);
+                        e.prio = std::min(e.prio, prio);
+                        e.due = std::min(e.due, due);
+                        _cv.notify_all();
+                        return;
+                    }
+                }
+            }
+
+            _queue.push_back(Entry{ std::move(fn), prio, key, due, _seq++ });
+            _cv.notify_all();
+        }
+
+        /* drops queued jobs with this key and flags the running one; with
+           waitForRunning the call returns once no job with the key runs */
+        void cancel(const void* key, bool waitForRunning)
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+
+            _queue.erase(std::remove_if(_queue.begin(), _queue.end(),
+                [key](const Entry& e) { return e.key == key; }), _queue.end());
+
+            for (Running& r : _running)
+                if (r.key == key)
+                    r.cancelled->store(true, std::memory_order_release);
+
+            if (waitForRunning)
+                _idleCv.wait(lock, [this, key] { return !isRunningLocked(key); });
+        }
+
+        /* fn(begin, end) over [0, n) in chunks of grain, on up to all workers
+           plus the calling thread; returns once every chunk has been run */
+        void parallelFor(int n, const std::function<void(int, int)>& fn, int grain = 1)
+        {
+            if (n <= 0)
+                return;
+
+            struct State
+            {
+                std::function<void(int, int)> fn;
+                int                     n;
+                int                     grain;
+                std::atomic<int>        next{ 0 };
+                std::atomic<int>        done{ 0 };
+                std::mutex              mutex;
+                std::condition_variable cv;
+            };
+
+            grain = std::max(1, grain);
+            auto st = std::make_shared<State>();
+            st->fn = fn;
+            st->n = n;
+            st->grain = grain;
+
+            // helpers starting after the range is exhausted return immediately
+            auto work = [st]
+            {
+                for (;;)
+                {
+                    const int b = st->next.fetch_add(st->grain);
+                    if (b >= st->n)
+                        return;
+                    const int e = std::min(b + st->grain, st->n);
+                    st->fn(b, e);
+                    if (st->done.fetch_add(e - b) + (e - b) == st->n)
+                    {
+                        std::lock_guard<std::mutex> lock(st->mutex);
+                        st->cv.notify_all();
+                    }
+                }
+            };
+
+            const int chunks = (n + grain - 1) / grain;
+            const int helpers = std::min(_maxWorkers, chunks - 1);
+            for (int h = 0; h < helpers; ++h)
+                submit([work](const Job&) { work(); }, Priority_HIGH);
+
+            work();
+
+            std::unique_lock<std::mutex> lock(st->mutex);
+            st->cv.wait(lock, [&] { return st->done.load() == st->n; });
+        }
+
+        /* called from the audio thread, cheap enough for every block */
+        void noteAudioCore() noexcept
+        {
+            const int core = currentCore();
+            if (core >= 0 && core != _audioCore.load(std::memory_order_relaxed))
+            {
+                _audioCore.store(core, std::memory_order_relaxed);
+                _affinityGen.fetch_add(1, std::memory_order_release);
+            }
+        }
+
+        int getNumPending()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return int(_queue.size());
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Entry
+        {
+            Fn                fn;
+            Priority          prio;
+            const void*       key;
+            Clock::time_point due;
+            uint64_t          seq;
+        };
+
+        struct Running
+        {
+            const void*                        key;
+            std::shared_ptr<std::atomic<bool>> cancelled;
+        };
+
+        JobPool()
+        {
+            const int hw = int(std::thread::hardware_concurrency());
+            _maxWorkers = std::max(1, std::min(4, hw - 2));
+        }
+
+        ~JobPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+                _queue.clear();
+                for (Running& r : _running)
+                    r.cancelled->store(true, std::memory_order_release);
+            }
+            _cv.notify_all();
+            for (std::thread& t : _workers)
+                t.join();
+        }
+
+        JobPool(const JobPool&) = delete;
+        JobPool& operator=(const JobPool&) = delete;
+
+        void startWorkersLocked()
+        {
+            if (!_workers.empty() || _stop)
+                return;
+            for (int i = 0; i < _maxWorkers; ++i)
+                _workers.emplace_back([this, i] { workerLoop(i); });
+        }
+
+        bool isRunningLocked(const void* key) const
+        {
+            for (const Running& r : _running)
+                if (r.key == key)
+                    return true;
+            return false;
+        }
+
+        void workerLoop(int index)
+        {
+#if GW5_TRACE
+            static const char* names[] = { "JobPool 0", "JobPool 1", "JobPool 2", "JobPool 3", "JobPool n" };
+            GW5_TRACE_THREAD(names[std::min(index, 4)]);
+#else
+            (void)index;
+#endif
+            ScopedNoDenormals noDenormals;
+            uint64_t affinityGen = 0;
+
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (!_stop)
+            {
+                const uint64_t gen = _affinityGen.load(std::memory_order_acquire);
+                if (gen != affinityGen)
+                {
+                    affinityGen = gen;
+                    avoidCore(_audioCore.load(std::memory_order_relaxed));
+                }
+
+                /* pick the eligible job: due, key idle, best priority, oldest */
+                const auto now = Clock::now();
+                auto best = _queue.end();
+                auto nextDue = Clock::time_point::max();
+                for (auto it = _queue.begin(); it != _queue.end(); ++it)
+                {
+                    if (it->key != nullptr && isRunningLocked(it->key))
+                        continue;
+                    if (it->due > now)
+                    {
+                        nextDue = std::min(nextDue, it->due);
+                        continue;
+                    }
+                    if (best == _queue.end()
+                        || it->prio < best->prio
+                        || (it->prio == best->prio && it->seq < best->seq))
+                        best = it;
+                }
+
+                if (best == _queue.end())
+                {
+                    if (nextDue == Clock::time_point::max())
+                        _cv.wait(lock);
+                    else
+                        _cv.wait_until(lock, nextDue);
+                    continue;
+                }
+
+                Entry entry = std::move(*best);
+                _queue.erase(best);
+
+                Job job;
+                job._cancelled = std::make_shared<std::atomic<bool>>(false);
+                _running.push_back(Running{ entry.key, job._cancelled });
+
+                lock.unlock();
+                entry.fn(job);
+                entry.fn = nullptr;          // release captures outside the lock
+                lock.lock();
+
+                for (auto it = _running.begin(); it != _running.end(); ++it)
+                {
+                    if (it->cancelled == job._cancelled)
+                    {
+                        _running.erase(it);
+                        break;
+                    }
+                }
+                _idleCv.notify_all();
+                _cv.notify_all();            // a job blocked on this key may run now
+            }
+        }
+
+        static int currentCore() noexcept
+        {
+#if defined (__linux__)
+            return sched_getcpu();
+#elif defined (_WIN64)
+            return int(GetCurrentProcessorNumber());
+#else
+            return -1;
+#endif
+        }
+
+        static void avoidCore(int core) noexcept
+        {
+            const int hw = int(std::thread::hardware_concurrency());
+            if (core < 0 || hw < 2)
+                return;
+#if defined (__linux__)
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int c = 0; c < hw && c < CPU_SETSIZE; ++c)
+                if (c != core)
+                    CPU_SET(c, &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#elif defined (_WIN64)
+            if (hw <= 64 && core < 64)
+            {
+                const unsigned __int64 all = (hw == 64) ? ~0ULL : ((1ULL << hw) - 1);
+                SetThreadAffinityMask(GetCurrentThread(), all & ~(1ULL << core));
+            }
+#endif
+        }
+
+        std::mutex               _mutex;
+        std::condition_variable  _cv;          // work available / stop
+        std::condition_variable  _idleCv;      // a job finished
+        std::vector<Entry>       _queue;
+        std::vector<Running>     _running;
+        std::vector<std::thread> _workers;
+        uint64_t                 _seq = 0;
+        int                      _maxWorkers = 1;
+        bool                     _stop = false;
+
+        std::atomic<int>         _audioCore{ -1 };
+        std::atomic<uint64_t>    _affinityGen{ 0 };
+    };
+
+} // namespace gw5
@@ -0,0 +1,144 @@
+// MappedFile.h   (read-only memory-mapped file)
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined (__unix__) || defined (__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define GW5_MAPPED_FILE_POSIX 1
+#elif defined (_WIN64)
+struct _SECURITY_ATTRIBUTES;
+extern "C" __declspec(dllimport) int __stdcall MultiByteToWideChar(unsigned int, unsigned long, const char*, int, wchar_t*, int);
+extern "C" __declspec(dllimport) void* __stdcall CreateFileW(const wchar_t*, unsigned long, unsigned long, _SECURITY_ATTRIBUTES*, unsigned long, unsigned long, void*);
+extern "C" __declspec(dllimport) unsigned long __stdcall GetFileSize(void*, unsigned long*);
+extern "C" __declspec(dllimport) void* __stdcall CreateFileMappingW(void*, _SECURITY_ATTRIBUTES*, unsigned long, unsigned long, unsigned long, const wchar_t*);
+extern "C" __declspec(dllimport) void* __stdcall MapViewOfFile(void*, unsigned long, unsigned long, unsigned long, unsigned __int64);
+extern "C" __declspec(dllimport) int __stdcall UnmapViewOfFile(const void*);
+extern "C" __declspec(dllimport) int __stdcall CloseHandle(void*);
+    #define GW5_MAPPED_FILE_WIN64 1
+#endif
+
+namespace gw5
+{
+    /*
+    ==============================================================================
+    Name: MappedFile
+    Purpose: Maps a whole file read-only so parsers and converters read it in
+             place; pages come in on first touch, so loading a large table is
+             bound by I/O rather than by copies. POSIX mmap and Win64 file
+             mappings; elsewhere the file is read into memory once.
+             Paths are UTF-8.
+    ==============================================================================
+    */
+    class MappedFile final
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile() { close(); }
+
+        bool open(const char* path)
+        {
+            close();
+#if defined (GW5_MAPPED_FILE_POSIX)
+            const int fd = ::open(path, O_RDONLY);
+            if (fd < 0)
+                return false;
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0 || st.st_size <= 0)
+            {
+                ::close(fd);
+                return false;
+            }
+
+            void* p = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);                                  // the mapping keeps the file
+            if (p == MAP_FAILED)
+                return false;
+
+            ::madvise(p, size_t(st.st_size), MADV_WILLNEED);
+            _data = static_cast<const uint8_t*>(p);
+            _size = size_t(st.st_size);
+            return true;
+#elif defined (GW5_MAPPED_FILE_WIN64)
+            const int wlen = MultiByteToWideChar(65001 /* CP_UTF8 */, 0, path, -1, nullptr, 0);
+            if (wlen <= 0)
+                return false;
+            std::wstring wpath(size_t(wlen), L'\0');
+            MultiByteToWideChar(65001, 0, path, -1, &wpath[0], wlen);
+
+            void* const invalid = reinterpret_cast<void*>(intptr_t(-1));
+            void* file = CreateFileW(wpath.c_str(), 0x80000000 /* GENERIC_READ */, 1 /* FILE_SHARE_READ */,
+                nullptr, 3 /* OPEN_EXISTING */, 0x80 /* FILE_ATTRIBUTE_NORMAL */, nullptr);
+            if (file == invalid)
+                return false;
+
+            unsigned long high = 0;
+            const unsigned long low = GetFileSize(file, &high);
+            const uint64_t size = (uint64_t(high) << 32) | low;
+            void* mapping = (size > 0) ? CreateFileMappingW(file, nullptr, 2 /* PAGE_READONLY */, 0, 0, nullptr) : nullptr;
+            CloseHandle(file);
+            if (mapping == nullptr)
+                return false;
+
+            void* p = MapViewOfFile(mapping, 4 /* FILE_MAP_READ */, 0, 0, 0);
+            CloseHandle(mapping);                         // the view keeps the mapping
+            if (p == nullptr)
+                return false;
+
+            _data = static_cast<const uint8_t*>(p);
+            _size = size_t(size);
+            return true;
+#else
+            std::ifstream f(path, std::ios::binary | std::ios::ate);
+            if (!f)
+                return false;
+            const std::streamoff len = f.tellg();
+            if (len <= 0)
+                return false;
+            _copy.resize(size_t(len));
+            f.seekg(0);
+            if (!f.read(reinterpret_cast<char*>(_copy.data()), len))
+                return false;
+            _data = _copy.data();
+            _size = _copy.size();
+            return true;
+#endif
+        }
+
+        void close() noexcept
+        {
+            if (_data == nullptr)
+                return;
+#if defined (GW5_MAPPED_FILE_POSIX)
+            ::munmap(const_cast<uint8_t*>(_data), _size);
+#elif defined (GW5_MAPPED_FILE_WIN64)
+            UnmapViewOfFile(_data);
+#else
+            std::vector<uint8_t>().swap(_copy);
+#endif
+            _data = nullptr;
+            _size = 0;
+        }
+
+        bool           isOpen() const noexcept { return _data != nullptr; }
+        const uint8_t* data() const noexcept { return _data; }
+        size_t         size() const noexcept { return _size; }
+
+    private:
+        const uint8_t*       _data = nullptr;
+        size_t               _size = 0;
+        std::vector<uint8_t> _copy;          // fallback only
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+    };
+
+} // namespace gw5
@@ -0,0 +1,92 @@
+// MemStats.h   (memory accounting for wavetable resources)
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace gw5
+{
+    /*
+    ==============================================================================
+    Name: MemStats
+    Purpose: Process-wide byte counters for every large allocation made by the
+             wavetable engine (mip pyramids, builder slot, WaveMaker buffers,
+             resampler lanes). Counters are lock-free and may be queried from
+             any thread; the peak tracks the highest total ever observed, which
+             is reached while a new pyramid is built next to the live one.
+    ==============================================================================
+    */
+    class MemStats final
+    {
+    public:
+        enum Category
+        {
+            Category_MIP_TABLES = 0,   // every MipMapFlt level, incl. builtin
+            Category_BUILDER_SLOT,     // AsyncMipBuilder producer slot
+            Category_WAVEMAKER,        // Griffin_WaveMaker work buffers
+            Category_RESAMPLER,        // ResamplerFlt oversampling buffers
+            Category_VOICE_ENGINE,     // VoiceEngine output slots
+
+            Category_NBR_ELT
+        };
+
+        struct Snapshot
+        {
+            int64_t bytes[Category_NBR_ELT] = {};
+            int64_t total = 0;
+            int64_t peak = 0;
+        };
+
+        /* singleton access */
+        static MemStats& instance() noexcept
+        {
+            static MemStats s;
+            return s;
+        }
+
+        /* delta may be negative (release) */
+        void add(Category cat, int64_t delta) noexcept
+        {
+            if (delta == 0)
+                return;
+
+            _bytes[cat].fetch_add(delta, std::memory_order_relaxed);
+            const int64_t now = _total.fetch_add(delta, std::memory_order_relaxed) + delta;
+
+            int64_t prev = _peak.load(std::memory_order_relaxed);
+            while (now > prev
+                && !_peak.compare_exchange_weak(prev, now, std::memory_order_relaxed))
+            {
+                // retry with refreshed prev
+            }
+        }
+
+        int64_t get(Category cat) const noexcept { return _bytes[cat].load(std::memory_order_relaxed); }
+        int64_t total() const noexcept { return _total.load(std::memory_order_relaxed); }
+        int64_t peak() const noexcept { return _peak.load(std::memory_order_relaxed); }
+
+        /* restart peak tracking from the current total */
+        void resetPeak() noexcept { _peak.store(total(), std::memory_order_relaxed); }
+
+        Snapshot snapshot() const noexcept
+        {
+            Snapshot s;
+            for (int c = 0; c < Category_NBR_ELT; ++c)
+                s.bytes[c] = get(static_cast<Category>(c));
+            s.total = total();
+            s.peak = peak();
+            return s;
+        }
+
+    private:
+        MemStats() = default;
+
+        MemStats(const MemStats&) = delete;
+        MemStats& operator=(const MemStats&) = delete;
+
+        std::atomic<int64_t> _bytes[Category_NBR_ELT] = {};
+        std::atomic<int64_t> _total{ 0 };
+        std::atomic<int64_t> _peak{ 0 };
+    };
+
+} // namespace gw5
@@ -2,6 +2,8 @@
 
 This is the sample data container. It parses original data, makes MIP-maps
 with the help of the provided filter and store them into memory.
+Multichannel samples are stored interleaved (LRLR for stereo): lengths and
+positions count sample frames, a table pointer addresses the first channel.
 How to use this class:
  1. Build an instance of it.
  2. Call init_sample()
@@ -13,6 +15,8 @@ How to use this class:
 #pragma once
 
 #include "rspl.hpp"
+#include "MemStats.h"
+#include "SimdKernels.h"
 #include <vector>
 #include <cassert>
 
@@ -37,7 +41,7 @@ public:
     Throws: Nothing
     ==============================================================================
     */
-    inline ~MipMapFlt() = default;
+    inline ~MipMapFlt();
 
     /*
     ==============================================================================
@@ -55,11 +59,12 @@ public:
       - nbr_tables: Number of desired mip‑map levels. 1 = just provided data. > 0.
       - imp_ptr: Pointer on impulse data.
       - nbr_taps: Number of taps. > 0 and odd.
+      - nbr_chn: Number of interleaved channels. > 0.
     Returns: true if more data are needed to fill the sample.
     Throws: std::vector related exceptions
     ==============================================================================
     */
-    inline bool init_sample (long len, long add_len_pre, long add_len_post, int nbr_tables, const double imp_ptr[], int nbr_taps);
+    inline bool init_sample (long len, long add_len_pre, long add_len_post, int nbr_tables, const double imp_ptr[], int nbr_taps, int nbr_chn = 1);
 
     /*
     ==============================================================================
@@ -68,14 +73,73 @@ public:
       Provide sample data. Must be called after init_sample() and before using
       data. Multiple calls allowed to fill in blocks. Total length must match.
     Input parameters:
-      - data_ptr: Pointer on sample data.
-      - nbr_spl: Number of samples to load.
+      - data_ptr: Pointer on sample data, interleaved if multichannel.
+      - nbr_spl: Number of sample frames to load.
     Returns: true if more data are needed.
     Throws: Nothing.
     ==============================================================================
     */
     inline bool fill_sample (const float data_ptr[], long nbr_spl);
 
+    /*
+    ==============================================================================
+    Name: init_sample_direct
+    Description:
+      Alternative to init_sample() / fill_sample() for callers that compute all
+      mip-map levels themselves (e.g. band-limited by truncating harmonics).
+      Allocates every level cleared to zero and no filter. Write the levels via
+      use_table_direct(), then call commit_direct(). Each level must hold the
+      same data the half-band filter would produce: sample i of level n is
+      aligned with sample i << n of level 0.
+    Input parameters:
+      - len: Length of the sample, in samples. >= 0
+      - add_len_pre: Required data before each integer sample position. >= 0.
+      - add_len_post: Same as add_len_pre, but after sample. >= 0.
+      - nbr_tables: Number of desired mip-map levels. > 0.
+      - nbr_chn: Number of interleaved channels. > 0.
+    Throws: std::vector related exceptions
+    ==============================================================================
+    */
+    inline void init_sample_direct (long len, long add_len_pre, long add_len_post, int nbr_tables, int nbr_chn = 1);
+
+    /*
+    ==============================================================================
+    Name: init_sample_direct_from
+    Description:
+      Same as init_sample_direct(), but the levels start as a copy of another
+      ready object (same length, padding and number of levels), so a direct
+      fill only has to rewrite the parts that changed.
+    Input parameters:
+      - other: Ready object to copy.
+    Throws: std::vector related exceptions
+    ==============================================================================
+    */
+    inline void init_sample_direct_from (const MipMapFlt &other);
+
+    /*
+    ==============================================================================
+    Name: use_table_direct
+    Description:
+      Write access to a level between init_sample_direct() and commit_direct().
+      Distinct ranges may be written from several threads at once.
+    Input:
+      - table: table index.
+    Returns: Pointer to the first sample of the level (padding precedes it).
+    Throws: assert if not in direct fill or index invalid.
+    ==============================================================================
+    */
+    inline float * use_table_direct (int table);
+
+    /*
+    ==============================================================================
+    Name: commit_direct
+    Description:
+      Ends a direct fill; the object is ready afterwards.
+    Throws: Nothing
+    ==============================================================================
+    */
+    inline void commit_direct ();
+
     /*
     ==============================================================================
     Name: clear_sample
@@ -127,6 +191,15 @@ public:
     */
     inline const int get_nbr_tables () const;
 
+    /*
+    ==============================================================================
+    Name: get_nbr_chn
+    Returns: Number of interleaved channels, 1 for mono.
+    Throws: Nothing
+    ==============================================================================
+    */
+    inline int get_nbr_chn () const;
+
     /*
     ==============================================================================
     Name: use_table
@@ -138,6 +211,18 @@ public:
     */
     inline const float * use_table (int table) const;
 
+    /*
+    ==============================================================================
+    Name: get_mem_bytes
+    Description:
+      Heap memory held by the object (all mip-map levels, padding included, plus
+      the pending filter impulse if the sample is not complete yet).
+    Returns: Size in bytes.
+    Throws: Nothing
+    ==============================================================================
+    */
+    inline long long get_mem_bytes () const;
+
 /*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
 private:
     class TableData
@@ -154,7 +239,9 @@ private:
     void resize_and_clear_tables ();
     bool check_sample_and_build_mip_map ();
     void build_mip_map_level (int level);
-    float filter_sample (const TableData::SplData &table, long pos) const;
+    template <class K>
+    void filter_level (int level);
+    void update_mem_stats ();
 
     TableArr _table_arr;
     SplData  _filter;         // First stored coef is the "center".
@@ -163,6 +250,8 @@ private:
     long     _add_len_post;   // >= 0
     long     _filled_len;     // >= 0
     int      _nbr_tables;     // > 0
+    int      _nbr_chn;        // > 0, interleaved
+    long long _mem_bytes;     // Last value reported to MemStats
 
     MipMapFlt (const MipMapFlt &)            = delete;
     MipMapFlt & operator = (const MipMapFlt &) = delete;
@@ -182,13 +271,21 @@ inline MipMapFlt::MipMapFlt()
 , _add_len_post(0)
 , _filled_len(0)
 , _nbr_tables(0)
+, _nbr_chn(1)
+, _mem_bytes(0)
 {
     // Nothing
 }
 
-inline bool MipMapFlt::init_sample (long len, long add_len_pre, long add_len_post, int nbr_tables, const double imp_ptr[], int nbr_taps)
+inline MipMapFlt::~MipMapFlt()
+{
+    MemStats::instance().add(MemStats::Category_MIP_TABLES, -_mem_bytes);
+}
+
+inline bool MipMapFlt::init_sample (long len, long add_len_pre, long add_len_post, int nbr_tables, const double imp_ptr[], int nbr_taps, int nbr_chn)
 {
     assert (len >= 0);
+    assert (nbr_chn > 0);
     assert (add_len_pre >= 0);
     assert (add_len_post >= 0);
     assert (nbr_tables > 0);
@@ -208,9 +305,12 @@ inline bool MipMapFlt::init_sample (long len, long add_len_pre, long add_len_pos
     _add_len_post  = std::max(add_len_post, filter_sup);
     _filled_len    = 0;
     _nbr_tables    = nbr_tables;
+    _nbr_chn       = nbr_chn;
 
     resize_and_clear_tables();
-    return (check_sample_and_build_mip_map());
+    const bool more_flag = check_sample_and_build_mip_map();
+    update_mem_stats();
+    return (more_flag);
 }
 
 inline bool MipMapFlt::fill_sample (const float data_ptr[], long nbr_spl)
@@ -223,15 +323,73 @@ inline bool MipMapFlt::fill_sample (const float data_ptr[], long nbr_spl)
     assert (nbr_spl <= _len - _filled_len);
 
     TableData::SplData &sample = _table_arr[0]._data;
-    const long offset = _add_len_pre + _filled_len;
+    const long offset = (_add_len_pre + _filled_len) * _nbr_chn;
     const long work_len = std::min(nbr_spl, _len - _filled_len);
 
-    for (long pos = 0; pos < work_len; ++pos)
+    for (long pos = 0; pos < work_len * _nbr_chn; ++pos)
     {
         sample[offset + pos] = data_ptr[pos];
     }
     _filled_len += work_len;
-    return (check_sample_and_build_mip_map());
+    const bool more_flag = check_sample_and_build_mip_map();
+    update_mem_stats();
+    return (more_flag);
+}
+
+inline void MipMapFlt::init_sample_direct (long len, long add_len_pre, long add_len_post, int nbr_tables, int nbr_chn)
+{
+    assert (len >= 0);
+    assert (nbr_chn > 0);
+    assert (add_len_pre >= 0);
+    assert (add_len_post >= 0);
+    assert (nbr_tables > 0);
+
+    SplData().swap(_filter);
+    _len           = len;
+    _add_len_pre   = add_len_pre;
+    _add_len_post  = add_len_post;
+    _filled_len    = 0;
+    _nbr_tables    = nbr_tables;
+    _nbr_chn       = nbr_chn;
+
+    resize_and_clear_tables();
+    update_mem_stats();
+}
+
+inline void MipMapFlt::init_sample_direct_from (const MipMapFlt &other)
+{
+    assert (other.is_ready());
+    assert (&other != this);
+
+    SplData().swap(_filter);
+    _len           = other._len;
+    _add_len_pre   = other._add_len_pre;
+    _add_len_post  = other._add_len_post;
+    _filled_len    = 0;
+    _nbr_tables    = other._nbr_tables;
+    _nbr_chn       = other._nbr_chn;
+
+    _table_arr = other._table_arr;
+    for (TableData &tbl : _table_arr)
+    {
+        tbl._data_ptr = &tbl._data[_add_len_pre * _nbr_chn];
+    }
+    update_mem_stats();
+}
+
+inline float * MipMapFlt::use_table_direct (int table)
+{
+    assert (_len >= 0 && _filled_len < _len);
+    assert (_filter.empty());
+    assert (table >= 0 && table < _nbr_tables);
+    return _table_arr[table]._data_ptr;
+}
+
+inline void MipMapFlt::commit_direct ()
+{
+    assert (_len >= 0);
+    assert (_filter.empty());
+    _filled_len = _len;
 }
 
 inline void MipMapFlt::clear_sample ()
@@ -241,8 +399,10 @@ inline void MipMapFlt::clear_sample ()
     _add_len_post  = 0;
     _filled_len = 0;
     _nbr_tables = 0;
+    _nbr_chn    = 1;
     TableArr().swap(_table_arr);
     SplData().swap(_filter);
+    update_mem_stats();
 }
 
 inline bool MipMapFlt::is_ready () const
@@ -263,6 +423,11 @@ inline const int MipMapFlt::get_nbr_tables () const
     return _nbr_tables;
 }
 
+inline int MipMapFlt::get_nbr_chn () const
+{
+    return _nbr_chn;
+}
+
 inline long MipMapFlt::get_lev_len (int level) const
 {
     assert (_len >= 0);
@@ -278,16 +443,33 @@ inline const float * MipMapFlt::use_table (int table) const
     return _table_arr[table]._data_ptr;
 }
 
+inline long long MipMapFlt::get_mem_bytes () const
+{
+    long long bytes = static_cast<long long>(_filter.capacity()) * sizeof(float);
+    for (const TableData &tbl : _table_arr)
+    {
+        bytes += static_cast<long long>(tbl._data.capacity()) * sizeof(float);
+    }
+    return bytes;
+}
+
+inline void MipMapFlt::update_mem_stats ()
+{
+    const long long bytes = get_mem_bytes();
+    MemStats::instance().add(MemStats::Category_MIP_TABLES, bytes - _mem_bytes);
+    _mem_bytes = bytes;
+}
+
 inline void MipMapFlt::resize_and_clear_tables ()
 {
     _table_arr.resize(_nbr_tables);
     for (int i = 0; i < _nbr_tables; ++i)
     {
         const long lev_len = get_lev_len(i);
-        const long tbl_len = _add_len_pre + lev_len + _add_len_post;
+        const long tbl_len = (_add_len_pre + lev_len + _add_len_post) * _nbr_chn;
         TableData &tbl = _table_arr[i];
         SplData(tbl_len, 0.0f).swap(tbl._data);
-        tbl._data_ptr = &tbl._data[_add_len_pre];
+        tbl._data_ptr = &tbl._data[_add_len_pre * _nbr_chn];
     }
 }
 
@@ -305,36 +487,54 @@ inline bool MipMapFlt::check_sample_and_build_mip_map ()
 }
 
 inline void MipMapFlt::build_mip_map_level (int level)
+{
+    simd::dispatch ([this, level] (auto k) { filter_level <decltype (k)> (level); });
+}
+
+// Half-band filter and decimation of level - 1 into level. Mono and stereo
+// go through the kernel variant K, other channel counts stay scalar.
+template <class K>
+void MipMapFlt::filter_level (int level)
 {
     assert (level > 0 && level < _nbr_tables);
-    SplData &ref = _table_arr[level - 1]._data;
+    const SplData &ref = _table_arr[level - 1]._data;
     SplData &dst = _table_arr[level]._data;
 
+    const float *flt = _filter.data();
     const long half = _filter.size() - 1;
     const long quarter = half / 2;
     const long end_pos = get_lev_len(level) + quarter;
+    const long stride = _nbr_chn;
 
     for (long pos = -quarter; pos < end_pos; ++pos)
     {
-        const long ref_pos = _add_len_pre + pos * 2;
-        float val = filter_sample(ref, ref_pos);
-        const long dst_pos = _add_len_pre + pos;
-        dst[dst_pos] = val;
-    }
-}
+        const long ref_pos = (_add_len_pre + pos * 2) * stride;
+        const long dst_pos = (_add_len_pre + pos) * stride;
+        assert (ref_pos - half * stride >= 0);
+        assert (ref_pos + half * stride + stride <= static_cast<long>(ref.size()));
+        const float *src = ref.data() + ref_pos;
 
-inline float MipMapFlt::filter_sample (const TableData::SplData &tbl, long pos) const
-{
-    const long half = _filter.size() - 1;
-    assert (pos - half >= 0 && pos + half < static_cast<long>(tbl.size()));
-
-    float sum = tbl[pos] * _filter[0];
-    for (long i = 1; i <= half; ++i)
-    {
-        float s2 = tbl[pos - i] + tbl[pos + i];
-        sum += s2 * _filter[i];
+        if (stride == 1)
+        {
+            dst[dst_pos] = K::fir_sym(src, flt, half);
+        }
+        else if (stride == 2)
+        {
+            K::fir_sym_stereo(src, flt, half, dst[dst_pos], dst[dst_pos + 1]);
+        }
+        else
+        {
+            for (long chn = 0; chn < stride; ++chn)
+            {
+                float sum = src[chn] * flt[0];
+                for (long i = 1; i <= half; ++i)
+                {
+                    sum += (src[chn - i * stride] + src[chn + i * stride]) * flt[i];
+                }
+                dst[dst_pos + chn] = sum;
+            }
+        }
     }
-    return sum;
 }
 
 } // namespace rspl
@@ -0,0 +1,273 @@
+// PeriodSlicer.h   (arbitrary audio -> one pitch period per frame)
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "FftReal.h"
+#include "JobPool.h"
+#include "Trace.h"
+
+namespace gw5
+{
+    /*
+    ==============================================================================
+    Name: PeriodSlicer
+    Purpose: Turns a mono recording into a wavetable: nbrFrames analysis points
+             evenly spaced over the audio, a YIN pitch estimate at each (the
+             difference function taken from an FFT cross-correlation), then one
+             period per point, starting at an upward zero crossing, resampled
+             to frameSize with its end tilted onto its start so it loops.
+             Points without a clear pitch borrow the nearest detected period.
+             Both the analysis and the slicing run in parallel on the JobPool;
+             workers only count finished steps, progress (0..1) is sent from
+             the calling thread alone, so it never goes backwards.
+    ==============================================================================
+    */
+    class PeriodSlicer final
+    {
+    public:
+        enum { WINDOW = 2048 };            // YIN integration window
+        enum { MAX_PERIOD = 2048 };        // longest period searched, samples
+        enum { MIN_PERIOD = 8 };
+        enum { CHUNK = 8 };
+
+        using Progress = std::function<void(double)>;
+
+        static long getMinLength() noexcept { return WINDOW + MAX_PERIOD + 1; }
+
+        /* false if cancelled or the audio is shorter than getMinLength() */
+        static bool slice(const float x[], long n, float dst[], int frameSize, int nbrFrames,
+            const JobPool::Job& job, const Progress& progress)
+        {
+            GW5_TRACE_SCOPE("PeriodSlicer::slice");
+
+            if (n < getMinLength() || nbrFrames <= 0)
+                return false;
+
+            const long span = n - getMinLength();
+            std::vector<long>  pos(nbrFrames);
+            std::vector<float> period(nbrFrames, 0.0f);
+            for (int j = 0; j < nbrFrames; ++j)
+                pos[j] = (nbrFrames > 1) ? long(double(span) * j / (nbrFrames - 1)) : 0;
+
+            const int steps = 2 * nbrFrames;
+            std::atomic<int>  done{ 0 };
+            std::atomic<bool> cancelled{ false };
+            const auto caller = std::this_thread::get_id();
+            int reported = 0;                          // caller thread only
+            auto report = [&]
+            {
+                const int d = done.load(std::memory_order_relaxed);
+                if (progress && (d * 32 / steps) != (reported * 32 / steps))
+                    progress(double(d) / double(steps));
+                reported = d;
+            };
+            auto tick = [&](int count)
+            {
+                done.fetch_add(count, std::memory_order_relaxed);
+                if (std::this_thread::get_id() == caller)
+                    report();
+            };
+
+            /* --- 1. pitch at every point --------------------------------- */
+            JobPool::instance().parallelFor(nbrFrames, [&](int begin, int end)
+            {
+                GW5_TRACE_SCOPE("PeriodSlicer::pitch");
+                Yin yin;
+                for (int j = begin; j < end && !cancelled.load(std::memory_order_relaxed); ++j)
+                {
+                    if (job.isCancelled())
+                    {
+                        cancelled.store(true, std::memory_order_relaxed);
+                        return;
+                    }
+                    period[j] = yin.estimate(x + pos[j]);
+                }
+                tick(end - begin);
+            }, CHUNK);
+            report();
+
+            if (cancelled.load())
+                return false;
+
+            /* --- 2. unvoiced points take the nearest detected period ------ */
+            if (!fillGaps(period))
+                std::fill(period.begin(), period.end(), float(frameSize));   // nothing pitched at all
+
+            /* --- 3. one period per frame --------------------------------- */
+            JobPool::instance().parallelFor(nbrFrames, [&](int begin, int end)
+            {
+                GW5_TRACE_SCOPE("PeriodSlicer::frames");
+                for (int j = begin; j < end; ++j)
+                {
+                    if (job.isCancelled())
+                    {
+                        cancelled.store(true, std::memory_order_relaxed);
+                        return;
+                    }
+                    cutPeriod(x, n, pos[j], period[j], dst + long(j) * frameSize, frameSize);
+                }
+                tick(end - begin);
+            }, CHUNK);
+            report();
+
+            return !cancelled.load();
+        }
+
+    private:
+        /* YIN on x[0 .. WINDOW + MAX_PERIOD); 0 = no clear pitch */
+        class Yin
+        {
+        public:
+            enum { FFT_LEN = WINDOW + MAX_PERIOD };   // no wrap for lags <= MAX_PERIOD
+
+            Yin()
+                : _fft(FFT_LEN)
+                , _buf(FFT_LEN)
+                , _aRe(FFT_LEN / 2 + 1), _aIm(FFT_LEN / 2 + 1)
+                , _yRe(FFT_LEN / 2 + 1), _yIm(FFT_LEN / 2 + 1)
+                , _corr(FFT_LEN)
+                , _energy(FFT_LEN + 1)
+                , _cmnd(MAX_PERIOD + 1)
+            {
+            }
+
+            float estimate(const float x[])
+            {
+                /* cross-correlation of the window with the whole segment */
+                std::copy(x, x + WINDOW, _buf.begin());
+                std::fill(_buf.begin() + WINDOW, _buf.end(), 0.0f);
+                _fft.forward(_buf.data(), _aRe.data(), _aIm.data());
+                _fft.forward(x, _yRe.data(), _yIm.data());
+                for (size_t h = 0; h < _aRe.size(); ++h)
+                {
+                    const float re = _aRe[h] * _yRe[h] + _aIm[h] * _yIm[h];
+                    const float im = _aRe[h] * _yIm[h] - _aIm[h] * _yRe[h];
+                    _aRe[h] = re;
+                    _aIm[h] = im;
+                }
+                _fft.inverse(_aRe.data(), _aIm.data(), _corr.data());
+
+                _energy[0] = 0.0;
+                for (int i = 0; i < FFT_LEN; ++i)
+                    _energy[i + 1] = _energy[i] + double(x[i]) * x[i];
+
+                /* cumulative mean normalised difference */
+                const double e0 = _energy[WINDOW];
+                if (e0 <= 1e-9)
+                    return 0.0f;
+
+                double sum = 0.0;
+                _cmnd[0] = 1.0f;
+                for (int tau = 1; tau <= MAX_PERIOD; ++tau)
+                {
+                    const double et = _energy[tau + WINDOW] - _energy[tau];
+                    const double d = std::max(0.0, e0 + et - 2.0 * _corr[tau]);
+                    sum += d;
+                    _cmnd[tau] = (sum > 0.0) ? float(d * tau / sum) : 1.0f;
+                }
+
+                int best = -1;
+                for (int tau = MIN_PERIOD; tau < MAX_PERIOD; ++tau)
+                {
+                    if (_cmnd[tau] < THRESHOLD)
+                    {
+                        while (tau + 1 < MAX_PERIOD && _cmnd[tau + 1] < _cmnd[tau])
+                            ++tau;
+                        best = tau;
+                        break;
+                    }
+                }
+                if (best < 0)
+                    return 0.0f;
+
+                /* parabolic refinement */
+                const float a = _cmnd[best - 1], b = _cmnd[best], c = _cmnd[best + 1];
+                const float den = a - 2.0f * b + c;
+                const float off = (std::fabs(den) > 1e-12f) ? 0.5f * (a - c) / den : 0.0f;
+                return float(best) + std::max(-0.5f, std::min(0.5f, off));
+            }
+
+        private:
+            static constexpr float THRESHOLD = 0.15f;
+
+            FftReal             _fft;
+            std::vector<float>  _buf;
+            std::vector<float>  _aRe, _aIm, _yRe, _yIm;
+            std::vector<float>  _corr;
+            std::vector<double> _energy;     // prefix sums of x^2
+            std::vector<float>  _cmnd;
+        };
+
+        static bool fillGaps(std::vector<float>& period)
+        {
+            const int n = int(period.size());
+            int last = -1;
+            for (int j = 0; j < n; ++j)
+                if (period[j] > 0.0f)
+                    last = j;
+            if (last < 0)
+                return false;
+
+            // backwards then forwards: every gap gets the closest earlier or,
+            // at the start, the first later period
+            float next = period[last];
+            for (int j = n - 1; j >= 0; --j)
+            {
+                if (period[j] > 0.0f) next = period[j];
+                else                  period[j] = -next;    // provisional
+            }
+            float prev = 0.0f;
+            for (int j = 0; j < n; ++j)
+            {
+                if (period[j] > 0.0f) prev = period[j];
+                else                  period[j] = (prev > 0.0f) ? prev : -period[j];
+            }
+            return true;
+        }
+
+        /* one period from the first upward zero crossing at or after p */
+        static void cutPeriod(const float x[], long n, long p, float period, float dst[], int frameSize)
+        {
+            const long lim = std::min(n - long(std::ceil(period)) - 3, p + long(std::ceil(period)));
+            double start = double(p);
+            for (long i = std::max(p, 1L); i < lim; ++i)
+            {
+                if (x[i - 1] < 0.0f && x[i] >= 0.0f)
+                {
+                    start = double(i - 1) + double(-x[i - 1]) / double(x[i] - x[i - 1]);
+                    break;
+                }
+            }
+
+            const double step = double(period) / double(frameSize);
+            for (int i = 0; i < frameSize; ++i)
+                dst[i] = hermite(x, n, start + step * i);
+
+            // tilt the end onto the start so the frame loops without a step
+            const float drift = hermite(x, n, start + period) - dst[0];
+            for (int i = 0; i < frameSize; ++i)
+                dst[i] -= drift * float(i) / float(frameSize);
+        }
+
+        static float hermite(const float x[], long n, double pos) noexcept
+        {
+            const long i = long(std::floor(pos));
+            const float f = float(pos - double(i));
+            auto at = [&](long k) { return x[std::max(0L, std::min(n - 1, k))]; };
+            const float xm1 = at(i - 1), x0 = at(i), x1 = at(i + 1), x2 = at(i + 2);
+            const float c = 0.5f * (x1 - xm1);
+            const float v = x0 - x1;
+            const float w = c + v;
+            const float a = w + v + 0.5f * (x2 - x0);
+            const float b = w + a;
+            return (((a * f) - b) * f + c) * f + x0;
+        }
+    };
+
+} // namespace gw5
@@ -23,8 +23,12 @@
 #include	"InterpPack.h"
 #include	"MipMapFlt.hpp"
 #include	"ResamplerFlt.h"
+#include	"MemStats.h"
+#include	"Trace.h"
 
 #include	<cassert>
+#include	<cmath>
+#include	<cstring>
 
 
 
@@ -48,19 +52,35 @@ namespace gw5
 
 	ResamplerFlt::ResamplerFlt()
 		: _buf()
+		, _buf_r()
 		, _mip_map_ptr(0)
 		, _interp_ptr(0)
 		, _dwnspl()
+		, _dwnspl_r()
 		, _voice_arr()
+		, _sync()
+		, _fm_start(0)
+		, _fm_len(0)
 		, _pitch(0)
 		, _buf_len(128)
 		, _fade_pos(0)
 		, _fade_flag(false)
 		, _fade_needed_flag(false)
 		, _can_use_flag(false)
+		, _low_quality_flag(false)
 	{
 		_dwnspl.set_coefs(_dwnspl_coef_arr);
+		_dwnspl_r.set_coefs(_dwnspl_coef_arr);
 		_buf.resize(_buf_len * 2);
+		_buf_r.resize(_buf_len * 2);
+		MemStats::instance().add(MemStats::Category_RESAMPLER, get_mem_bytes());
+	}
+
+
+
+	ResamplerFlt::~ResamplerFlt()
+	{
+		MemStats::instance().add(MemStats::Category_RESAMPLER, -get_mem_bytes());
 	}
 
 
@@ -71,6 +91,9 @@ namespace gw5
 	Description:
 		Set the resampler interpolator.
 		This function has to be called at least once before using the resampler.
+		The downsampler follows the kernel set of the pack: the short set gets
+		the 3-coefficient filter, so both halves of the group delay shrink
+		together. Call it again after changing the pack's kernel set.
 	Input parameters:
 		- interp:
 	Throws: ?
@@ -82,6 +105,17 @@ namespace gw5
 		assert(&interp != 0);
 
 		_interp_ptr = &interp;
+
+		if (interp.get_kernel_set() == InterpPack::KernelSet_SHORT)
+		{
+			_dwnspl.set_coefs(_dwnspl_short_coef_arr, Downsampler2Flt::NBR_COEFS_SHORT);
+			_dwnspl_r.set_coefs(_dwnspl_short_coef_arr, Downsampler2Flt::NBR_COEFS_SHORT);
+		}
+		else
+		{
+			_dwnspl.set_coefs(_dwnspl_coef_arr);
+			_dwnspl_r.set_coefs(_dwnspl_coef_arr);
+		}
 	}
 
 
@@ -156,7 +190,7 @@ namespace gw5
 
 		_pitch = pitch;
 		const int		new_table = compute_table(pitch);
-		const bool		new_ovrspl_flag = (_pitch >= 0);
+		const bool		new_ovrspl_flag = use_ovrspl(_pitch);
 		_fade_needed_flag = (new_table != cur_voc._table
 			|| new_ovrspl_flag != cur_voc._ovrspl_flag);
 
@@ -189,6 +223,34 @@ namespace gw5
 
 
 
+	/*
+	==============================================================================
+	Name: set_low_quality
+	Description:
+		Selects the 1x interpolator for every pitch. Above pitch 0 this skips
+		the oversampled kernel and the half-band downsampler, trading aliasing
+		for about half the cost. The switch happens at the next set_pitch()
+		and goes through the MIP-map crossfade.
+	Input parameters:
+		- flag: true for low quality.
+	Throws: Nothing.
+	==============================================================================
+	*/
+
+	void	ResamplerFlt::set_low_quality(bool flag)
+	{
+		_low_quality_flag = flag;
+	}
+
+
+
+	bool	ResamplerFlt::is_low_quality() const
+	{
+		return (_low_quality_flag);
+	}
+
+
+
 	/*
 	==============================================================================
 	Name: set_playback_pos
@@ -245,6 +307,74 @@ namespace gw5
 
 
 
+	/*
+	==============================================================================
+	Name: set_sync
+	Description:
+		Turns hard sync on or off. A master phase advances by master_step per
+		output sample; every time it completes a cycle the playback position
+		restarts at the reset position (see set_sync_reset_pos()), with a
+		band-limited correction of the jump. The pitch set with set_pitch()
+		is the slave's.
+	Input parameters:
+		- master_step: master cycles per output sample, 0.32 fixed point.
+			0 disables sync. Must be < 0x80000000.
+	Throws: Nothing
+	==============================================================================
+	*/
+
+	void	ResamplerFlt::set_sync(UInt32 master_step)
+	{
+		assert(master_step < 0x80000000UL);
+
+		_sync._step = master_step;
+	}
+
+
+
+	/*
+	==============================================================================
+	Name: set_sync_phase / get_sync_phase
+	Description:
+		Position in the master cycle, 0x100000000 being a full cycle. Copy it
+		between resamplers that must restart together.
+	==============================================================================
+	*/
+
+	void	ResamplerFlt::set_sync_phase(UInt32 phase)
+	{
+		_sync._phase = phase;
+	}
+
+
+
+	UInt32	ResamplerFlt::get_sync_phase() const
+	{
+		return (_sync._phase);
+	}
+
+
+
+	/*
+	==============================================================================
+	Name: set_sync_reset_pos
+	Description:
+		Where the slave restarts at each master cycle.
+	Input parameters:
+		- pos: 32:32 fixed point, same range as set_playback_pos().
+	Throws: Nothing
+	==============================================================================
+	*/
+
+	void	ResamplerFlt::set_sync_reset_pos(Int64 pos)
+	{
+		assert(pos >= 0);
+
+		_sync._reset_pos = pos;
+	}
+
+
+
 	/*
 	==============================================================================
 	Name: interpolate_block
@@ -253,6 +383,8 @@ namespace gw5
 		the playback position overtake the sample length. Except during MIP-map
 		crossfading, CPU load per output sample is roughly constant and not
 		dependent on the resampling ratio.
+		The table must be mono, stereo tables go through the two-channel
+		overload.
 	Input parameters:
 		- dest_ptr: Pointer on the location where the data must be written.
 		- nbr_spl: Number of samples to generate. > 0.
@@ -262,11 +394,18 @@ namespace gw5
 
 	void	ResamplerFlt::interpolate_block(float dest_ptr[], long nbr_spl)
 	{
+		assert(_mip_map_ptr == 0 || _mip_map_ptr->get_nbr_chn() == 1);
 		assert(_mip_map_ptr != 0);
 		assert(_interp_ptr != 0);
 		assert(dest_ptr != 0);
 		assert(nbr_spl > 0);
 
+		if (_sync._step != 0)
+		{
+			interpolate_sync(dest_ptr, 0, nbr_spl);
+			return;
+		}
+
 		if (_fade_needed_flag && !_fade_flag)
 		{
 			begin_mip_map_fading();
@@ -322,6 +461,240 @@ namespace gw5
 
 
 
+	/*
+	==============================================================================
+	Name: interpolate_block (stereo)
+	Description:
+		Same as the mono version, one output per channel. Stereo tables are
+		interleaved, so both channels share the position update, the address
+		computation and the interpolation coefficients; only the multiply-adds
+		and the downsampler are doubled. A mono table is rendered once and
+		copied to the right channel.
+	Input parameters:
+		- dest_l_ptr: Left output.
+		- dest_r_ptr: Right output.
+		- nbr_spl: Number of samples to generate. > 0.
+	Throws: Nothing.
+	==============================================================================
+	*/
+
+	void	ResamplerFlt::interpolate_block(float dest_l_ptr[], float dest_r_ptr[], long nbr_spl)
+	{
+		assert(_mip_map_ptr != 0);
+		assert(_interp_ptr != 0);
+		assert(dest_l_ptr != 0);
+		assert(dest_r_ptr != 0);
+		assert(nbr_spl > 0);
+
+		if (_mip_map_ptr->get_nbr_chn() == 1)
+		{
+			interpolate_block(dest_l_ptr, nbr_spl);
+			using namespace std;
+			memcpy(dest_r_ptr, dest_l_ptr, sizeof(dest_r_ptr[0]) * nbr_spl);
+			return;
+		}
+		assert(_mip_map_ptr->get_nbr_chn() == 2);
+
+		if (_sync._step != 0)
+		{
+			interpolate_sync(dest_l_ptr, dest_r_ptr, nbr_spl);
+			return;
+		}
+
+		if (_fade_needed_flag && !_fade_flag)
+		{
+			begin_mip_map_fading();
+		}
+
+		long				block_pos = 0;
+		while (block_pos < nbr_spl)
+		{
+			long				work_len = nbr_spl - block_pos;
+
+			// Fading
+			if (_fade_flag)
+			{
+				work_len = min(work_len, _buf_len);
+				work_len = min(work_len, BaseVoiceState::FADE_LEN - _fade_pos);
+				fade_block_stereo(&dest_l_ptr[block_pos], &dest_r_ptr[block_pos], work_len);
+			}
+
+			// Oversampling required
+			else if (_voice_arr[VoiceInfo_CURRENT]._ovrspl_flag)
+			{
+				work_len = min(work_len, _buf_len);
+				_interp_ptr->interp_ovrspl_stereo(
+					&_buf[0],
+					&_buf_r[0],
+					work_len * 2,
+					_voice_arr[VoiceInfo_CURRENT]
+				);
+				_dwnspl.downsample_block(&dest_l_ptr[block_pos], &_buf[0], work_len);
+				_dwnspl_r.downsample_block(&dest_r_ptr[block_pos], &_buf_r[0], work_len);
+			}
+
+			// No oversampling
+			else
+			{
+				_interp_ptr->interp_norm_stereo(
+					&dest_l_ptr[block_pos],
+					&dest_r_ptr[block_pos],
+					work_len,
+					_voice_arr[VoiceInfo_CURRENT]
+				);
+				_dwnspl.phase_block(&dest_l_ptr[block_pos], &dest_l_ptr[block_pos], work_len);
+				_dwnspl_r.phase_block(&dest_r_ptr[block_pos], &dest_r_ptr[block_pos], work_len);
+			}
+
+			block_pos += work_len;
+		}
+	}
+
+
+
+	/*
+	==============================================================================
+	Name: interpolate_block_dual
+	Description:
+		Renders this resampler and a second one playing the same table (the
+		second oscillator of a voice) summed into one output. The two voices
+		share the oversampled buffer and the downsampler, and when neither is
+		MIP-fading and both are oversampled, one interpolation loop.
+		Otherwise each voice is ramp-added into the buffer as during a fade.
+		The second resampler's own buffers are not used. Sync and FM are not
+		applied; render such voices separately.
+	Input parameters:
+		- dest_ptr: Pointer on the location where the data must be written.
+		- second: The other voice, same MipMapFlt.
+		- gain: Level of the second voice, 0..1.
+		- nbr_spl: Number of samples to generate. > 0.
+	Throws: Nothing.
+	==============================================================================
+	*/
+
+	void	ResamplerFlt::interpolate_block_dual(float dest_ptr[], ResamplerFlt& second, float gain, long nbr_spl)
+	{
+		assert(_mip_map_ptr != 0);
+		assert(_mip_map_ptr->get_nbr_chn() == 1);
+
+		dual_block(dest_ptr, 0, second, gain, nbr_spl);
+	}
+
+
+
+	void	ResamplerFlt::interpolate_block_dual(float dest_l_ptr[], float dest_r_ptr[], ResamplerFlt& second, float gain, long nbr_spl)
+	{
+		assert(_mip_map_ptr != 0);
+		assert(dest_r_ptr != 0);
+
+		if (_mip_map_ptr->get_nbr_chn() == 1)
+		{
+			dual_block(dest_l_ptr, 0, second, gain, nbr_spl);
+			using namespace std;
+			memcpy(dest_r_ptr, dest_l_ptr, sizeof(dest_r_ptr[0]) * nbr_spl);
+			return;
+		}
+
+		dual_block(dest_l_ptr, dest_r_ptr, second, gain, nbr_spl);
+	}
+
+
+
+	/*
+	==============================================================================
+	Name: set_fm_cycle
+	Description:
+		The cycle FM playback stays in. Steps may be negative, so the position
+		wraps at both ends.
+	Input parameters:
+		- start: first sample of the cycle, 32:32 fixed point.
+		- len: cycle length in samples, a power of 2.
+	Throws: Nothing
+	==============================================================================
+	*/
+
+	void	ResamplerFlt::set_fm_cycle(Int64 start, long len)
+	{
+		assert(start >= 0);
+		assert(len > 0);
+		assert((len & (len - 1)) == 0);
+
+		_fm_start = start;
+		_fm_len = len;
+	}
+
+
+
+	/*
+	==============================================================================
+	Name: interpolate_block_fm
+	Description:
+		Generates a block with linear through-zero FM: sample i advances by
+		(1 + depth * mod_ptr[i]) times the step of the current pitch, in
+		either direction. The MIP-map level follows the instantaneous step
+		inside the interpolation loop, so no set_pitch() is needed per sample;
+		the MIP-map crossfade state is left untouched. The stereo overload
+		renders mono tables once and copies them, as interpolate_block().
+	Input parameters:
+		- dest_ptr: Pointer on the location where the data must be written.
+		- mod_ptr: Modulator, nbr_spl values.
+		- depth: Modulation index; the step crosses zero where
+			depth * mod < -1.
+		- nbr_spl: Number of samples to generate. > 0.
+	Throws: Nothing.
+	==============================================================================
+	*/
+
+	void	ResamplerFlt::interpolate_block_fm(float dest_ptr[], const float mod_ptr[], float depth, long nbr_spl)
+	{
+		assert(_mip_map_ptr != 0);
+		assert(_mip_map_ptr->get_nbr_chn() == 1);
+		assert(_interp_ptr != 0);
+		assert(_fm_len > 0);
+
+		GW5_TRACE_SCOPE("ResamplerFlt::fm");
+
+		const Int64		cycle_len = static_cast<Int64>(_fm_len) << 32;
+		Int64				pos = _fm_start + ((get_playback_pos() - _fm_start) & (cycle_len - 1));
+		const double	step = std::exp2(double(_pitch) / double(1L << NBR_BITS_PER_OCT));
+
+		_interp_ptr->interp_fm(dest_ptr, 0, nbr_spl, *_mip_map_ptr, pos, _fm_start, cycle_len, step, mod_ptr, depth);
+		_dwnspl.phase_block(dest_ptr, dest_ptr, nbr_spl);
+
+		set_playback_pos(pos);
+	}
+
+
+
+	void	ResamplerFlt::interpolate_block_fm(float dest_l_ptr[], float dest_r_ptr[], const float mod_ptr[], float depth, long nbr_spl)
+	{
+		assert(_mip_map_ptr != 0);
+		assert(_interp_ptr != 0);
+		assert(_fm_len > 0);
+
+		if (_mip_map_ptr->get_nbr_chn() == 1)
+		{
+			interpolate_block_fm(dest_l_ptr, mod_ptr, depth, nbr_spl);
+			using namespace std;
+			memcpy(dest_r_ptr, dest_l_ptr, sizeof(dest_r_ptr[0]) * nbr_spl);
+			return;
+		}
+
+		GW5_TRACE_SCOPE("ResamplerFlt::fm");
+
+		const Int64		cycle_len = static_cast<Int64>(_fm_len) << 32;
+		Int64				pos = _fm_start + ((get_playback_pos() - _fm_start) & (cycle_len - 1));
+		const double	step = std::exp2(double(_pitch) / double(1L << NBR_BITS_PER_OCT));
+
+		_interp_ptr->interp_fm(dest_l_ptr, dest_r_ptr, nbr_spl, *_mip_map_ptr, pos, _fm_start, cycle_len, step, mod_ptr, depth);
+		_dwnspl.phase_block(dest_l_ptr, dest_l_ptr, nbr_spl);
+		_dwnspl_r.phase_block(dest_r_ptr, dest_r_ptr, nbr_spl);
+
+		set_playback_pos(pos);
+	}
+
+
+
 	/*
 	==============================================================================
 	Name: clear_buffers
@@ -337,6 +710,9 @@ namespace gw5
 	void	ResamplerFlt::clear_buffers()
 	{
 		_dwnspl.clear_buffers();
+		_dwnspl_r.clear_buffers();
+		_voice_arr[VoiceInfo_CURRENT].clear_blep();
+		_voice_arr[VoiceInfo_FADEOUT].clear_blep();
 
 		if (_mip_map_ptr != 0)
 		{
@@ -349,6 +725,24 @@ namespace gw5
 
 
 
+	/*
+	==============================================================================
+	Name: get_mem_bytes
+	Description:
+		Heap memory owned by this resampler (the oversampling buffers). The mip-map
+		is shared and accounted by MipMapFlt itself.
+	Returns: Size in bytes.
+	Throws: Nothing
+	==============================================================================
+	*/
+
+	long long	ResamplerFlt::get_mem_bytes() const
+	{
+		return (static_cast<long long>(_buf.capacity() + _buf_r.capacity()) * sizeof(_buf[0]));
+	}
+
+
+
 	// Specs:
 	// Half-band FIR LPF
 	// 81 coefficients
@@ -402,7 +796,7 @@ namespace gw5
 		cur_voc._table = compute_table(_pitch);
 		cur_voc._table_len = _mip_map_ptr->get_lev_len(cur_voc._table);
 		cur_voc._table_ptr = _mip_map_ptr->use_table(cur_voc._table);
-		cur_voc._ovrspl_flag = (_pitch >= 0);
+		cur_voc._ovrspl_flag = use_ovrspl(_pitch);
 		cur_voc.compute_step(_pitch);
 	}
 
@@ -414,6 +808,8 @@ namespace gw5
 		assert(nbr_spl <= BaseVoiceState::FADE_LEN - _fade_pos);
 		assert(nbr_spl <= _buf_len);
 
+		GW5_TRACE_SCOPE("ResamplerFlt::mipFade");
+
 		const long		nbr_spl_ovr = nbr_spl * 2;
 		const float		vol_step = 1.0f / (BaseVoiceState::FADE_LEN * 2);
 		const float		vol = _fade_pos * (vol_step * 2);
@@ -423,65 +819,346 @@ namespace gw5
 		using namespace std;
 		memset(&_buf[0], 0, sizeof(_buf[0]) * nbr_spl_ovr);
 
-		assert(old_voc._ovrspl_flag || cur_voc._ovrspl_flag);
+		// Each voice picks its own interpolator; both may be on the 1x
+		// path when the low quality mode fades between two tables
+		BaseVoiceState* const voc_arr[2] = { &cur_voc, &old_voc };
+		const float		vol_arr[2] = { vol, 1.0f - vol };
+		const float		step_arr[2] = { vol_step, -vol_step };
+		for (int v = 0; v < 2; ++v)
+		{
+			if (voc_arr[v]->_ovrspl_flag)
+			{
+				_interp_ptr->interp_ovrspl_ramp_add(
+					&_buf[0], nbr_spl_ovr, *voc_arr[v], vol_arr[v], step_arr[v]);
+			}
+			else
+			{
+				_interp_ptr->interp_norm_ramp_add(
+					&_buf[0], nbr_spl_ovr, *voc_arr[v], vol_arr[v], step_arr[v]);
+			}
+		}
+
+		_dwnspl.downsample_block(&dest_ptr[0], &_buf[0], nbr_spl);
+
+		_fade_pos += nbr_spl;
+		_fade_flag = (_fade_pos < BaseVoiceState::FADE_LEN);
+	}
+
+
+
+	void	ResamplerFlt::fade_block_stereo(float dest_l_ptr[], float dest_r_ptr[], long nbr_spl)
+	{
+		assert(dest_l_ptr != 0);
+		assert(dest_r_ptr != 0);
+		assert(nbr_spl <= BaseVoiceState::FADE_LEN - _fade_pos);
+		assert(nbr_spl <= _buf_len);
+
+		GW5_TRACE_SCOPE("ResamplerFlt::mipFade");
 
-		if (cur_voc._ovrspl_flag
-			&& old_voc._ovrspl_flag)
+		const long		nbr_spl_ovr = nbr_spl * 2;
+		const float		vol_step = 1.0f / (BaseVoiceState::FADE_LEN * 2);
+		const float		vol = _fade_pos * (vol_step * 2);
+		BaseVoiceState& old_voc = _voice_arr[VoiceInfo_FADEOUT];
+		BaseVoiceState& cur_voc = _voice_arr[VoiceInfo_CURRENT];
+
+		using namespace std;
+		memset(&_buf[0], 0, sizeof(_buf[0]) * nbr_spl_ovr);
+		memset(&_buf_r[0], 0, sizeof(_buf_r[0]) * nbr_spl_ovr);
+
+		// Same pairing as fade_block(): each voice picks its own interpolator
+		BaseVoiceState* const voc_arr[2] = { &cur_voc, &old_voc };
+		const float		vol_arr[2] = { vol, 1.0f - vol };
+		const float		step_arr[2] = { vol_step, -vol_step };
+		for (int v = 0; v < 2; ++v)
 		{
-			_interp_ptr->interp_ovrspl_ramp_add(
-				&_buf[0],
-				nbr_spl_ovr,
-				cur_voc,
-				vol,
-				vol_step
-			);
-			_interp_ptr->interp_ovrspl_ramp_add(
-				&_buf[0],
-				nbr_spl_ovr,
-				old_voc,
-				1.0f - vol,
-				-vol_step
-			);
+			if (voc_arr[v]->_ovrspl_flag)
+			{
+				_interp_ptr->interp_ovrspl_ramp_add_stereo(
+					&_buf[0], &_buf_r[0], nbr_spl_ovr, *voc_arr[v], vol_arr[v], step_arr[v]);
+			}
+			else
+			{
+				_interp_ptr->interp_norm_ramp_add_stereo(
+					&_buf[0], &_buf_r[0], nbr_spl_ovr, *voc_arr[v], vol_arr[v], step_arr[v]);
+			}
 		}
 
-		else if (!cur_voc._ovrspl_flag
-			&& old_voc._ovrspl_flag)
+		_dwnspl.downsample_block(&dest_l_ptr[0], &_buf[0], nbr_spl);
+		_dwnspl_r.downsample_block(&dest_r_ptr[0], &_buf_r[0], nbr_spl);
+
+		_fade_pos += nbr_spl;
+		_fade_flag = (_fade_pos < BaseVoiceState::FADE_LEN);
+	}
+
+
+
+	/*
+	==============================================================================
+	Name: interpolate_sync
+	Description:
+		interpolate_block() with hard sync on, mono (dest_r_ptr == 0) or
+		interleaved stereo tables. Same block structure; the synced loops of
+		InterpPack advance the master phase and restart the slave.
+	==============================================================================
+	*/
+
+	void	ResamplerFlt::interpolate_sync(float dest_l_ptr[], float dest_r_ptr[], long nbr_spl)
+	{
+		GW5_TRACE_SCOPE("ResamplerFlt::sync");
+
+		const bool		stereo_flag = (dest_r_ptr != 0);
+
+		if (_fade_needed_flag && !_fade_flag)
 		{
-			_interp_ptr->interp_norm_ramp_add(
-				&_buf[0],
-				nbr_spl_ovr,
-				cur_voc,
-				vol,
-				vol_step
-			);
-			_interp_ptr->interp_ovrspl_ramp_add(
-				&_buf[0],
-				nbr_spl_ovr,
-				old_voc,
-				1.0f - vol,
-				-vol_step
-			);
+			begin_mip_map_fading();
 		}
 
-		else
+		long				block_pos = 0;
+		while (block_pos < nbr_spl)
 		{
-			_interp_ptr->interp_ovrspl_ramp_add(
-				&_buf[0],
-				nbr_spl_ovr,
-				cur_voc,
-				vol,
-				vol_step
-			);
-			_interp_ptr->interp_norm_ramp_add(
-				&_buf[0],
-				nbr_spl_ovr,
-				old_voc,
-				1.0f - vol,
-				-vol_step
-			);
+			long				work_len = nbr_spl - block_pos;
+			float* const	l_ptr = &dest_l_ptr[block_pos];
+			float* const	r_ptr = stereo_flag ? &dest_r_ptr[block_pos] : 0;
+
+			// Fading
+			if (_fade_flag)
+			{
+				work_len = min(work_len, _buf_len);
+				work_len = min(work_len, BaseVoiceState::FADE_LEN - _fade_pos);
+				fade_block_sync(l_ptr, r_ptr, work_len);
+			}
+
+			// Oversampling required
+			else if (_voice_arr[VoiceInfo_CURRENT]._ovrspl_flag)
+			{
+				work_len = min(work_len, _buf_len);
+				_interp_ptr->interp_ovrspl_sync(
+					&_buf[0],
+					stereo_flag ? &_buf_r[0] : 0,
+					work_len * 2,
+					_voice_arr[VoiceInfo_CURRENT],
+					_sync
+				);
+				_dwnspl.downsample_block(l_ptr, &_buf[0], work_len);
+				if (stereo_flag)
+				{
+					_dwnspl_r.downsample_block(r_ptr, &_buf_r[0], work_len);
+				}
+			}
+
+			// No oversampling
+			else
+			{
+				_interp_ptr->interp_norm_sync(
+					l_ptr,
+					r_ptr,
+					work_len,
+					_voice_arr[VoiceInfo_CURRENT],
+					_sync
+				);
+				_dwnspl.phase_block(l_ptr, l_ptr, work_len);
+				if (stereo_flag)
+				{
+					_dwnspl_r.phase_block(r_ptr, r_ptr, work_len);
+				}
+			}
+
+			block_pos += work_len;
 		}
+	}
 
-		_dwnspl.downsample_block(&dest_ptr[0], &_buf[0], nbr_spl);
+
+
+	void	ResamplerFlt::dual_block(float dest_l_ptr[], float dest_r_ptr[], ResamplerFlt& second, float gain, long nbr_spl)
+	{
+		assert(_mip_map_ptr != 0);
+		assert(_interp_ptr != 0);
+		assert(second._mip_map_ptr == _mip_map_ptr);
+		assert(dest_l_ptr != 0);
+		assert(nbr_spl > 0);
+		assert(gain >= 0);
+		assert(gain <= 1);
+
+		GW5_TRACE_SCOPE("ResamplerFlt::dual");
+
+		const bool		stereo_flag = (dest_r_ptr != 0);
+		float* const	buf_r_ptr = stereo_flag ? &_buf_r[0] : 0;
+
+		if (_fade_needed_flag && !_fade_flag)
+		{
+			begin_mip_map_fading();
+		}
+		if (second._fade_needed_flag && !second._fade_flag)
+		{
+			second.begin_mip_map_fading();
+		}
+
+		long				block_pos = 0;
+		while (block_pos < nbr_spl)
+		{
+			long				work_len = min(nbr_spl - block_pos, _buf_len);
+			if (_fade_flag)
+			{
+				work_len = min(work_len, BaseVoiceState::FADE_LEN - _fade_pos);
+			}
+			if (second._fade_flag)
+			{
+				work_len = min(work_len, BaseVoiceState::FADE_LEN - second._fade_pos);
+			}
+			const long		nbr_spl_ovr = work_len * 2;
+
+			// Fused: both steady and oversampled
+			if (   !_fade_flag && !second._fade_flag
+			    && _voice_arr[VoiceInfo_CURRENT]._ovrspl_flag
+			    && second._voice_arr[VoiceInfo_CURRENT]._ovrspl_flag)
+			{
+				_interp_ptr->interp_ovrspl_dual(
+					&_buf[0],
+					buf_r_ptr,
+					nbr_spl_ovr,
+					_voice_arr[VoiceInfo_CURRENT],
+					second._voice_arr[VoiceInfo_CURRENT],
+					gain
+				);
+			}
+
+			// One voice fading or single rate: ramp-add both
+			else
+			{
+				using namespace std;
+				memset(&_buf[0], 0, sizeof(_buf[0]) * nbr_spl_ovr);
+				if (stereo_flag)
+				{
+					memset(&_buf_r[0], 0, sizeof(_buf_r[0]) * nbr_spl_ovr);
+				}
+				add_block_ovr(&_buf[0], buf_r_ptr, nbr_spl_ovr, 1.0f);
+				second.add_block_ovr(&_buf[0], buf_r_ptr, nbr_spl_ovr, gain);
+			}
+
+			_dwnspl.downsample_block(&dest_l_ptr[block_pos], &_buf[0], work_len);
+			if (stereo_flag)
+			{
+				_dwnspl_r.downsample_block(&dest_r_ptr[block_pos], &_buf_r[0], work_len);
+			}
+
+			block_pos += work_len;
+		}
+	}
+
+
+
+	// Adds this resampler's voices, times gain, to an oversampled buffer and
+	// moves its MIP-map crossfade on; nbr_spl is in oversampled samples.
+	void	ResamplerFlt::add_block_ovr(float buf_l_ptr[], float buf_r_ptr[], long nbr_spl, float gain)
+	{
+		const bool		stereo_flag = (buf_r_ptr != 0);
+		BaseVoiceState& cur_voc = _voice_arr[VoiceInfo_CURRENT];
+		BaseVoiceState& old_voc = _voice_arr[VoiceInfo_FADEOUT];
+
+		const int		nbr_voc = _fade_flag ? 2 : 1;
+		BaseVoiceState* const voc_arr[2] = { &cur_voc, &old_voc };
+		float				vol_arr[2] = { gain, 0 };
+		float				step_arr[2] = { 0, 0 };
+		if (_fade_flag)
+		{
+			const float		vol_step = 1.0f / (BaseVoiceState::FADE_LEN * 2);
+			const float		vol = _fade_pos * (vol_step * 2);
+			vol_arr[0] = vol * gain;
+			vol_arr[1] = (1.0f - vol) * gain;
+			step_arr[0] = vol_step * gain;
+			step_arr[1] = -vol_step * gain;
+		}
+
+		for (int v = 0; v < nbr_voc; ++v)
+		{
+			if (voc_arr[v]->_ovrspl_flag)
+			{
+				if (stereo_flag)
+				{
+					_interp_ptr->interp_ovrspl_ramp_add_stereo(
+						buf_l_ptr, buf_r_ptr, nbr_spl, *voc_arr[v], vol_arr[v], step_arr[v]);
+				}
+				else
+				{
+					_interp_ptr->interp_ovrspl_ramp_add(
+						buf_l_ptr, nbr_spl, *voc_arr[v], vol_arr[v], step_arr[v]);
+				}
+			}
+			else
+			{
+				if (stereo_flag)
+				{
+					_interp_ptr->interp_norm_ramp_add_stereo(
+						buf_l_ptr, buf_r_ptr, nbr_spl, *voc_arr[v], vol_arr[v], step_arr[v]);
+				}
+				else
+				{
+					_interp_ptr->interp_norm_ramp_add(
+						buf_l_ptr, nbr_spl, *voc_arr[v], vol_arr[v], step_arr[v]);
+				}
+			}
+		}
+
+		if (_fade_flag)
+		{
+			_fade_pos += nbr_spl / 2;
+			_fade_flag = (_fade_pos < BaseVoiceState::FADE_LEN);
+		}
+	}
+
+
+
+	// MIP-map crossfade with sync: both voices see the same master cycles, so
+	// the fade-out voice runs on a copy of the master phase.
+	void	ResamplerFlt::fade_block_sync(float dest_l_ptr[], float dest_r_ptr[], long nbr_spl)
+	{
+		assert(dest_l_ptr != 0);
+		assert(nbr_spl <= BaseVoiceState::FADE_LEN - _fade_pos);
+		assert(nbr_spl <= _buf_len);
+
+		GW5_TRACE_SCOPE("ResamplerFlt::mipFade");
+
+		const bool		stereo_flag = (dest_r_ptr != 0);
+		const long		nbr_spl_ovr = nbr_spl * 2;
+		const float		vol_step = 1.0f / (BaseVoiceState::FADE_LEN * 2);
+		const float		vol = _fade_pos * (vol_step * 2);
+		float* const	buf_r_ptr = stereo_flag ? &_buf_r[0] : 0;
+
+		using namespace std;
+		memset(&_buf[0], 0, sizeof(_buf[0]) * nbr_spl_ovr);
+		if (stereo_flag)
+		{
+			memset(&_buf_r[0], 0, sizeof(_buf_r[0]) * nbr_spl_ovr);
+		}
+
+		const SyncState	master = _sync;
+		BaseVoiceState* const voc_arr[2] =
+		{
+			&_voice_arr[VoiceInfo_CURRENT], &_voice_arr[VoiceInfo_FADEOUT]
+		};
+		const float		vol_arr[2] = { vol, 1.0f - vol };
+		const float		step_arr[2] = { vol_step, -vol_step };
+		for (int v = 0; v < 2; ++v)
+		{
+			SyncState		sync = master;
+			if (voc_arr[v]->_ovrspl_flag)
+			{
+				_interp_ptr->interp_ovrspl_ramp_add_sync(
+					&_buf[0], buf_r_ptr, nbr_spl_ovr, *voc_arr[v], sync, vol_arr[v], step_arr[v]);
+			}
+			else
+			{
+				_interp_ptr->interp_norm_ramp_add_sync(
+					&_buf[0], buf_r_ptr, nbr_spl_ovr, *voc_arr[v], sync, vol_arr[v], step_arr[v]);
+			}
+			_sync._phase = sync._phase;
+		}
+
+		_dwnspl.downsample_block(dest_l_ptr, &_buf[0], nbr_spl);
+		if (stereo_flag)
+		{
+			_dwnspl_r.downsample_block(dest_r_ptr, &_buf_r[0], nbr_spl);
+		}
 
 		_fade_pos += nbr_spl;
 		_fade_flag = (_fade_pos < BaseVoiceState::FADE_LEN);
@@ -489,6 +1166,13 @@ namespace gw5
 
 
 
+	bool	ResamplerFlt::use_ovrspl(long pitch) const
+	{
+		return (pitch >= 0 && !_low_quality_flag);
+	}
+
+
+
 	int	ResamplerFlt::compute_table(long pitch)
 	{
 		int				table = 0;
@@ -530,6 +1214,13 @@ namespace gw5
 		0.0457281, 0.168088, 0.332501, 0.504486, 0.663202, 0.803781, 0.933856
 	};
 
+	// Transition band 0.1: 53 dB rejection, DC group delay 0.9 sample
+	// (1.65 for the set above)
+	const double	ResamplerFlt::_dwnspl_short_coef_arr[Downsampler2Flt::NBR_COEFS_SHORT] =
+	{
+		0.128456, 0.429567, 0.790676
+	};
+
 
 
 }	// namespace rspl
@@ -30,6 +30,9 @@ needed, making it handy for polyponic synthesiser implementation.
 
 In any case, NEVER EVER let the playback position exceed the sample length.
 
+Render from a thread running with ScopedNoDenormals (Denormals.h): the
+downsampler states decay into denormals when the output goes quiet.
+
 
 
 *Tab=3***********************************************************************/
@@ -65,7 +68,7 @@ namespace gw5
         enum { NBR_BITS_PER_OCT = BaseVoiceState::NBR_BITS_PER_OCT };
 
         ResamplerFlt();
-        virtual ~ResamplerFlt() = default;
+        virtual ~ResamplerFlt();
 
         /* --- original API (unchanged) --------------------------------------- */
         void set_interp(const InterpPack& interp);
@@ -75,12 +78,41 @@ namespace gw5
         void set_pitch(long pitch);
         long get_pitch() const;
 
+        /* drops the 2x path (and its downsampler) above pitch 0: about half
+           the cost, with more aliasing. Takes effect at the next set_pitch(),
+           through the usual MIP fade */
+        void set_low_quality(bool flag);
+        bool is_low_quality() const;
+
         void set_playback_pos(Int64 pos);
         Int64 get_playback_pos() const;
 
-        void interpolate_block(float dest_ptr[], long nbr_spl);
+        /* hard sync: master_step is the master cycle fraction per output
+           sample (0.32 fixed, 0 = off); the slave restarts at pos (level 0,
+           32:32) whenever the master wraps */
+        void set_sync(UInt32 master_step);
+        void set_sync_phase(UInt32 phase);
+        UInt32 get_sync_phase() const;
+        void set_sync_reset_pos(Int64 pos);
+
+        void interpolate_block(float dest_ptr[], long nbr_spl);     // mono tables
+        void interpolate_block(float dest_l_ptr[], float dest_r_ptr[], long nbr_spl);
+
+        /* this resampler plus second * gain (0..1) in one pass and through
+           one downsampler; both must play the same table */
+        void interpolate_block_dual(float dest_ptr[], ResamplerFlt& second, float gain, long nbr_spl);
+        void interpolate_block_dual(float dest_l_ptr[], float dest_r_ptr[], ResamplerFlt& second, float gain, long nbr_spl);
+
+        /* through-zero linear FM around the current pitch, mod_ptr at audio
+           rate; playback wraps inside the cycle given to set_fm_cycle().
+           Hard sync does not apply to these blocks. */
+        void set_fm_cycle(Int64 start, long len);
+        void interpolate_block_fm(float dest_ptr[], const float mod_ptr[], float depth, long nbr_spl);
+        void interpolate_block_fm(float dest_l_ptr[], float dest_r_ptr[], const float mod_ptr[], float depth, long nbr_spl);
         void clear_buffers();
 
+        long long get_mem_bytes() const;
+
         static const double _fir_mip_map_coef_arr[MIP_MAP_FIR_LEN];
 
         /* --- new helper: pass a shared_ptr ---------------------------------- */
@@ -98,23 +130,36 @@ namespace gw5
 
         void reset_pitch_cur_voice();
         void fade_block(float dest_ptr[], long nbr_spl);
+        void fade_block_stereo(float dest_l_ptr[], float dest_r_ptr[], long nbr_spl);
+        void fade_block_sync(float dest_l_ptr[], float dest_r_ptr[], long nbr_spl);
+        void interpolate_sync(float dest_l_ptr[], float dest_r_ptr[], long nbr_spl);
+        void dual_block(float dest_l_ptr[], float dest_r_ptr[], ResamplerFlt& second, float gain, long nbr_spl);
+        void add_block_ovr(float buf_l_ptr[], float buf_r_ptr[], long nbr_spl, float gain);
         inline int compute_table(long pitch);
+        inline bool use_ovrspl(long pitch) const;
         void begin_mip_map_fading();
 
         SplData            _buf;
+        SplData            _buf_r;                                // stereo tables
         const MipMapFlt* _mip_map_ptr = nullptr;               // fast raw access
         std::shared_ptr<const MipMapFlt> _mip_guard;             // lifetime guard
         const InterpPack* _interp_ptr = nullptr;
         Downsampler2Flt    _dwnspl;
+        Downsampler2Flt    _dwnspl_r;
         BaseVoiceState     _voice_arr[VoiceInfo_NBR_ELT];
+        SyncState          _sync;
+        Int64              _fm_start = 0;                         // level 0, 32:32
+        long               _fm_len = 0;                           // samples, power of 2
         long               _pitch = 0;
         long               _buf_len = 0;
         long               _fade_pos = 0;
         bool               _fade_flag = false;
         bool               _fade_needed_flag = false;
         bool               _can_use_flag = false;
+        bool               _low_quality_flag = false;
 
         static const double _dwnspl_coef_arr[Downsampler2Flt::NBR_COEFS];
+        static const double _dwnspl_short_coef_arr[Downsampler2Flt::NBR_COEFS_SHORT];
 
         /* no copy */
         ResamplerFlt(const ResamplerFlt&) = delete;
@@ -0,0 +1,84 @@
+// Semaphore.h   (counting semaphore whose post() never blocks)
+#pragma once
+
+#if defined (__APPLE__)
+    #include <dispatch/dispatch.h>
+#elif defined (__linux__)
+    #include <cerrno>
+    #include <semaphore.h>
+#elif defined (_WIN64)
+    struct _SECURITY_ATTRIBUTES;
+    extern "C" __declspec(dllimport) void* __stdcall CreateSemaphoreW(_SECURITY_ATTRIBUTES*, long, long, const wchar_t*);
+    extern "C" __declspec(dllimport) int __stdcall ReleaseSemaphore(void*, long, long*);
+    extern "C" __declspec(dllimport) unsigned long __stdcall WaitForSingleObject(void*, unsigned long);
+    extern "C" __declspec(dllimport) int __stdcall CloseHandle(void*);
+#else
+    #include <condition_variable>
+    #include <mutex>
+#endif
+
+namespace gw5
+{
+    /*
+    ==============================================================================
+    Name: Semaphore
+    Purpose: Lets a thread sleep until another wakes it, with no polling and
+             no missed wake-up: a post() before the wait() is kept as a count.
+             post() takes no lock and does not block, so an audio thread may
+             call it (a single kernel call when a thread is asleep). Uses the
+             OS semaphore (dispatch on Apple, POSIX on Linux, Win32); other
+             platforms fall back to a mutex and a condition variable.
+    ==============================================================================
+    */
+    class Semaphore final
+    {
+    public:
+#if defined (__APPLE__)
+        Semaphore() : _sem(dispatch_semaphore_create(0)) {}
+        ~Semaphore() { dispatch_release(_sem); }
+        void post() noexcept { dispatch_semaphore_signal(_sem); }
+        void wait() noexcept { dispatch_semaphore_wait(_sem, DISPATCH_TIME_FOREVER); }
+#elif defined (__linux__)
+        Semaphore() { sem_init(&_sem, 0, 0); }
+        ~Semaphore() { sem_destroy(&_sem); }
+        void post() noexcept { sem_post(&_sem); }
+        void wait() noexcept { while (sem_wait(&_sem) != 0 && errno == EINTR) {} }
+#elif defined (_WIN64)
+        Semaphore() : _sem(CreateSemaphoreW(nullptr, 0, 0x7fffffff, nullptr)) {}
+        ~Semaphore() { CloseHandle(_sem); }
+        void post() noexcept { ReleaseSemaphore(_sem, 1, nullptr); }
+        void wait() noexcept { WaitForSingleObject(_sem, 0xffffffffu); }   // INFINITE
+#else
+        void post() noexcept
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            ++_count;
+            _cv.notify_one();
+        }
+
+        void wait() noexcept
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv.wait(lock, [this] { return _count > 0; });
+            --_count;
+        }
+#endif
+
+        Semaphore(const Semaphore&) = delete;
+        Semaphore& operator=(const Semaphore&) = delete;
+
+    private:
+#if defined (__APPLE__)
+        dispatch_semaphore_t    _sem;
+#elif defined (__linux__)
+        sem_t                   _sem;
+#elif defined (_WIN64)
+        void*                   _sem;
+#else
+        std::mutex              _mutex;
+        std::condition_variable _cv;
+        int                     _count = 0;
+#endif
+    };
+
+} // namespace gw5
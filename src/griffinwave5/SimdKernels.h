@@ -0,0 +1,372 @@
+// SimdKernels.h   (per instruction set variants of the inner DSP loops)
+#pragma once
+
+#include "CpuFeatures.h"
+#include "rspl.hpp"
+
+namespace gw5
+{
+namespace simd
+{
+    /*
+    ==============================================================================
+    Name: Generic, Avx2, Avx512
+    Purpose: The inner loops the table readers and the MIP-map builder spend
+             their time in, one struct per instruction set:
+               convolve         one phase of InterpFltPhase, mono
+               convolve_stereo  same, interleaved stereo
+               fir_sym          symmetric FIR around x[0] (MIP-map half-band),
+                                mono or interleaved stereo
+               scale_bias       dst (+)= s * g + bias (WaveMaker blend), mono
+                                or two planar inputs into interleaved stereo
+             The block loops are templates on one of these, and dispatch()
+             runs a block loop with the variant CpuFeatures selected. The
+             wide variants add in a different order, so they agree with
+             Generic to rounding, not bit for bit.
+    ==============================================================================
+    */
+    struct Generic
+    {
+        template <class PH>
+        static rspl_FORCEINLINE float convolve(const PH& ph, const float x[], float q)
+        {
+            return ph.convolve(x, q);
+        }
+
+        template <class PH>
+        static rspl_FORCEINLINE void convolve_stereo(const PH& ph, const float x[], float q, float& l, float& r)
+        {
+            ph.convolve_stereo(x, q, l, r);
+        }
+
+        static rspl_FORCEINLINE float fir_sym(const float x[], const float f[], long half)
+        {
+            float sum = x[0] * f[0];
+            for (long i = 1; i <= half; ++i)
+                sum += (x[-i] + x[i]) * f[i];
+            return sum;
+        }
+
+        static rspl_FORCEINLINE void fir_sym_stereo(const float x[], const float f[], long half, float& l, float& r)
+        {
+            float sl = x[0] * f[0];
+            float sr = x[1] * f[0];
+            for (long i = 1; i <= half; ++i)
+            {
+                sl += (x[-i * 2] + x[i * 2]) * f[i];
+                sr += (x[-i * 2 + 1] + x[i * 2 + 1]) * f[i];
+            }
+            l = sl;
+            r = sr;
+        }
+
+        static rspl_FORCEINLINE void scale_bias(float dst[], const float s[], long n, float g, float bias, bool add)
+        {
+            if (add) for (long i = 0; i < n; ++i) dst[i] += s[i] * g + bias;
+            else     for (long i = 0; i < n; ++i) dst[i] = s[i] * g + bias;
+        }
+
+        static rspl_FORCEINLINE void scale_bias_stereo(float dst[], const float l[], const float r[], long n,
+                                                       float g, float biasL, float biasR, bool add)
+        {
+            for (long i = 0; i < n; ++i)
+            {
+                const float vl = l[i] * g + biasL;
+                const float vr = r[i] * g + biasR;
+                dst[i * 2] = add ? dst[i * 2] + vl : vl;
+                dst[i * 2 + 1] = add ? dst[i * 2 + 1] + vr : vr;
+            }
+        }
+    };
+
+#if GW5_ISA_X86
+
+    struct Avx2
+    {
+        /* sum of (imp + dif * q) * x over [0, len), len a multiple of 4 */
+        GW5_TARGET_AVX2 static rspl_FORCEINLINE
+        float dot_lerp(const float imp[], const float dif[], const float x[], float q, int len)
+        {
+            const __m256 q8 = _mm256_set1_ps(q);
+            __m256 acc = _mm256_setzero_ps();
+            int i = 0;
+            for (; i + 8 <= len; i += 8)
+            {
+                const __m256 c = _mm256_fmadd_ps(_mm256_loadu_ps(dif + i), q8, _mm256_loadu_ps(imp + i));
+                acc = _mm256_fmadd_ps(c, _mm256_loadu_ps(x + i), acc);
+            }
+            __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+            if (i < len)
+            {
+                const __m128 c = _mm_fmadd_ps(_mm_loadu_ps(dif + i), _mm_set1_ps(q), _mm_loadu_ps(imp + i));
+                s = _mm_fmadd_ps(c, _mm_loadu_ps(x + i), s);
+            }
+            return hsum(s);
+        }
+
+        /* stereo dot_lerp from tap begin, lanes alternate L R */
+        GW5_TARGET_AVX2 static rspl_FORCEINLINE
+        __m256 dot_lerp_stereo(const float imp[], const float dif[], const float x[], float q, int begin, int len, __m256 acc)
+        {
+            const __m128 q4 = _mm_set1_ps(q);
+            for (int i = begin; i < len; i += 4)
+            {
+                const __m128 c = _mm_fmadd_ps(_mm_loadu_ps(dif + i), q4, _mm_loadu_ps(imp + i));
+                const __m256 c2 = _mm256_insertf128_ps(
+                    _mm256_castps128_ps256(_mm_unpacklo_ps(c, c)), _mm_unpackhi_ps(c, c), 1);
+                acc = _mm256_fmadd_ps(c2, _mm256_loadu_ps(x + i * 2), acc);
+            }
+            return acc;
+        }
+
+        template <class PH>
+        GW5_TARGET_AVX2 static rspl_FORCEINLINE
+        float convolve(const PH& ph, const float x[], float q)
+        {
+            static_assert((PH::FIR_LEN & 3) == 0, "Multiple of 4 taps expected");
+            return dot_lerp(ph._imp, ph._dif, x, q, PH::FIR_LEN);
+        }
+
+        template <class PH>
+        GW5_TARGET_AVX2 static rspl_FORCEINLINE
+        void convolve_stereo(const PH& ph, const float x[], float q, float& l, float& r)
+        {
+            static_assert((PH::FIR_LEN & 3) == 0, "Multiple of 4 taps expected");
+            const __m256 acc = dot_lerp_stereo(ph._imp, ph._dif, x, q, 0, PH::FIR_LEN, _mm256_setzero_ps());
+            hsum_stereo(acc, l, r);
+        }
+
+        /* sum of (x[-i] + x[i]) * f[i] for i in [begin, end] */
+        GW5_TARGET_AVX2 static rspl_FORCEINLINE
+        float fir_sym_part(const float x[], const float f[], long begin, long end)
+        {
+            const __m256i rev = _mm256_set_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            __m256 acc = _mm256_setzero_ps();
+            long i = begin;
+            for (; i + 7 <= end; i += 8)
+            {
+                const __m256 a = _mm256_loadu_ps(x + i);
+                const __m256 b = _mm256_permutevar8x32_ps(_mm256_loadu_ps(x - i - 7), rev);
+                acc = _mm256_fmadd_ps(_mm256_add_ps(a, b), _mm256_loadu_ps(f + i), acc);
+            }
+            float sum = hsum(_mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1)));
+            for (; i <= end; ++i)
+                sum += (x[-i] + x[i]) * f[i];
+            return sum;
+        }
+
+        GW5_TARGET_AVX2 static rspl_FORCEINLINE
+        float fir_sym(const float x[], const float f[], long half)
+        {
+            return x[0] * f[0] + fir_sym_part(x, f, 1, half);
+        }
+
+        GW5_TARGET_AVX2 static rspl_FORCEINLINE
+        void fir_sym_stereo(const float x[], const float f[], long half, float& l, float& r)
+        {
+            const __m256i rev = _mm256_set_epi32(1, 0, 3, 2, 5, 4, 7, 6);   // frames reversed, L R kept
+            __m256 acc = _mm256_setzero_ps();
+            long i = 1;
+            for (; i + 3 <= half; i += 4)
+            {
+                const __m256 a = _mm256_loadu_ps(x + i * 2);
+                const __m256 b = _mm256_permutevar8x32_ps(_mm256_loadu_ps(x - i * 2 - 6), rev);
+                const __m128 c = _mm_loadu_ps(f + i);
+                const __m256 c2 = _mm256_insertf128_ps(
+                    _mm256_castps128_ps256(_mm_unpacklo_ps(c, c)), _mm_unpackhi_ps(c, c), 1);
+                acc = _mm256_fmadd_ps(_mm256_add_ps(a, b), c2, acc);
+            }
+            hsum_stereo(acc, l, r);
+            l += x[0] * f[0];
+            r += x[1] * f[0];
+            for (; i <= half; ++i)
+            {
+                l += (x[-i * 2] + x[i * 2]) * f[i];
+                r += (x[-i * 2 + 1] + x[i * 2 + 1]) * f[i];
+            }
+        }
+
+        GW5_TARGET_AVX2 static rspl_FORCEINLINE
+        void scale_bias(float dst[], const float s[], long n, float g, float bias, bool add)
+        {
+            const __m256 g8 = _mm256_set1_ps(g);
+            const __m256 b8 = _mm256_set1_ps(bias);
+            long i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                __m256 v = _mm256_fmadd_ps(_mm256_loadu_ps(s + i), g8, b8);
+                if (add) v = _mm256_add_ps(_mm256_loadu_ps(dst + i), v);
+                _mm256_storeu_ps(dst + i, v);
+            }
+            Generic::scale_bias(dst + i, s + i, n - i, g, bias, add);
+        }
+
+        /* eight frames of both channels per step, interleaved on the way out */
+        GW5_TARGET_AVX2 static rspl_FORCEINLINE
+        void scale_bias_stereo(float dst[], const float l[], const float r[], long n,
+                               float g, float biasL, float biasR, bool add)
+        {
+            const __m256 g8 = _mm256_set1_ps(g);
+            const __m256 bl8 = _mm256_set1_ps(biasL);
+            const __m256 br8 = _mm256_set1_ps(biasR);
+            long i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                const __m256 vl = _mm256_fmadd_ps(_mm256_loadu_ps(l + i), g8, bl8);
+                const __m256 vr = _mm256_fmadd_ps(_mm256_loadu_ps(r + i), g8, br8);
+                const __m256 lo = _mm256_unpacklo_ps(vl, vr);     // l0 r0 l1 r1 | l4 r4 l5 r5
+                const __m256 hi = _mm256_unpackhi_ps(vl, vr);     // l2 r2 l3 r3 | l6 r6 l7 r7
+                __m256 a = _mm256_permute2f128_ps(lo, hi, 0x20);
+                __m256 b = _mm256_permute2f128_ps(lo, hi, 0x31);
+                if (add)
+                {
+                    a = _mm256_add_ps(_mm256_loadu_ps(dst + i * 2), a);
+                    b = _mm256_add_ps(_mm256_loadu_ps(dst + i * 2 + 8), b);
+                }
+                _mm256_storeu_ps(dst + i * 2, a);
+                _mm256_storeu_ps(dst + i * 2 + 8, b);
+            }
+            Generic::scale_bias_stereo(dst + i * 2, l + i, r + i, n - i, g, biasL, biasR, add);
+        }
+
+        GW5_TARGET_AVX2 static rspl_FORCEINLINE float hsum(__m128 s)
+        {
+            s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+            s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+            return _mm_cvtss_f32(s);
+        }
+
+        GW5_TARGET_AVX2 static rspl_FORCEINLINE void hsum_stereo(__m256 acc, float& l, float& r)
+        {
+            __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+            s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+            l = _mm_cvtss_f32(s);
+            r = _mm_cvtss_f32(_mm_shuffle_ps(s, s, 1));
+        }
+    };
+
+    struct Avx512 : Avx2
+    {
+        // GCC 12 builds the unmasked permutes, extracts, inserts, 512 <-> 256
+        // casts and _mm512_reduce_add_ps from undefined lanes and reports
+        // them as maybe-uninitialized under -Wall; the zero-masked forms
+        // with every lane set compile to the same instructions
+        static constexpr __mmask16 ALL = 0xffff;
+        static constexpr __mmask8  LOW8 = 0xff;    // 8 floats
+        static constexpr __mmask8  PD4 = 0x0f;     // 4 doubles, half a register
+
+        template <class PH>
+        GW5_TARGET_AVX512 static rspl_FORCEINLINE
+        float convolve(const PH& ph, const float x[], float q)
+        {
+            constexpr int LEN = PH::FIR_LEN;
+            constexpr int WIDE = LEN & ~15;
+            static_assert((LEN & 3) == 0, "Multiple of 4 taps expected");
+
+            float sum = 0.0f;
+            if (WIDE > 0)
+            {
+                const __m512 q16 = _mm512_set1_ps(q);
+                __m512 acc = _mm512_setzero_ps();
+                for (int i = 0; i < WIDE; i += 16)
+                {
+                    const __m512 c = _mm512_fmadd_ps(_mm512_loadu_ps(ph._dif + i), q16, _mm512_loadu_ps(ph._imp + i));
+                    acc = _mm512_fmadd_ps(c, _mm512_loadu_ps(x + i), acc);
+                }
+                sum = hsum16(acc);
+            }
+            if (WIDE < LEN)
+                sum += dot_lerp(ph._imp + WIDE, ph._dif + WIDE, x + WIDE, q, LEN - WIDE);
+            return sum;
+        }
+
+        template <class PH>
+        GW5_TARGET_AVX512 static rspl_FORCEINLINE
+        void convolve_stereo(const PH& ph, const float x[], float q, float& l, float& r)
+        {
+            constexpr int LEN = PH::FIR_LEN;
+            constexpr int WIDE = LEN & ~7;
+            static_assert((LEN & 3) == 0, "Multiple of 4 taps expected");
+
+            const __m512i dup = _mm512_set_epi32(7, 7, 6, 6, 5, 5, 4, 4, 3, 3, 2, 2, 1, 1, 0, 0);
+            const __m512 q16 = _mm512_set1_ps(q);
+            __m512 acc = _mm512_setzero_ps();
+            for (int i = 0; i < WIDE; i += 8)
+            {
+                const __m512 c = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(LOW8, ph._dif + i), q16,
+                    _mm512_maskz_loadu_ps(LOW8, ph._imp + i));   // 8 taps, upper lanes unused
+                const __m512 c2 = _mm512_maskz_permutexvar_ps(ALL, dup, c);
+                acc = _mm512_fmadd_ps(c2, _mm512_loadu_ps(x + i * 2), acc);
+            }
+            __m256 acc8 = fold8(acc);
+            acc8 = dot_lerp_stereo(ph._imp, ph._dif, x, q, WIDE, LEN, acc8);
+            hsum_stereo(acc8, l, r);
+        }
+
+        GW5_TARGET_AVX512 static rspl_FORCEINLINE
+        float fir_sym(const float x[], const float f[], long half)
+        {
+            const __m512i rev = _mm512_set_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+            __m512 acc = _mm512_setzero_ps();
+            long i = 1;
+            for (; i + 15 <= half; i += 16)
+            {
+                const __m512 a = _mm512_loadu_ps(x + i);
+                const __m512 b = _mm512_maskz_permutexvar_ps(ALL, rev, _mm512_loadu_ps(x - i - 15));
+                acc = _mm512_fmadd_ps(_mm512_add_ps(a, b), _mm512_loadu_ps(f + i), acc);
+            }
+            return x[0] * f[0] + hsum16(acc) + fir_sym_part(x, f, i, half);
+        }
+
+        // upper half onto the lower
+        GW5_TARGET_AVX512 static rspl_FORCEINLINE __m256 fold8(__m512 acc)
+        {
+            const __m512d a = _mm512_castps_pd(acc);
+            return _mm256_add_ps(_mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(PD4, a, 0)),
+                _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(PD4, a, 1)));
+        }
+
+        GW5_TARGET_AVX512 static rspl_FORCEINLINE float hsum16(__m512 acc)
+        {
+            const __m256 s = fold8(acc);
+            return hsum(_mm_add_ps(_mm256_castps256_ps128(s), _mm256_extractf128_ps(s, 1)));
+        }
+    };
+
+    template <class F>
+    GW5_TARGET_AVX2 GW5_FLATTEN void run_avx2(const F& f)
+    {
+        f(Avx2());
+    }
+
+    template <class F>
+    GW5_TARGET_AVX512 GW5_FLATTEN void run_avx512(const F& f)
+    {
+        f(Avx512());
+    }
+
+#endif // GW5_ISA_X86
+
+    /* f(kernels) with the variant CpuFeatures selected. f is usually a
+       generic lambda running one block loop templated on the kernels. */
+    template <class F>
+    void dispatch(const F& f)
+    {
+        switch (CpuFeatures::getActive())
+        {
+#if GW5_ISA_X86
+        case CpuFeatures::Isa_AVX512:
+            run_avx512(f);
+            break;
+        case CpuFeatures::Isa_AVX2:
+            run_avx2(f);
+            break;
+#endif
+        default:
+            f(Generic());
+            break;
+        }
+    }
+
+} // namespace simd
+} // namespace gw5
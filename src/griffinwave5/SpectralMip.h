@@ -0,0 +1,98 @@
+// SpectralMip.h   (mip-map levels straight from frame spectra)
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "FftReal.h"
+#include "InterpPack.h"
+#include "MipMapFlt.hpp"
+
+namespace gw5
+{
+    /*
+    ==============================================================================
+    Name: SpectralMip
+    Purpose: Fills a tripled-layout MipMapFlt from per-frame spectra. Level n of
+             a frame is the inverse FFT of the bins below its own Nyquist at
+             frameSize >> n points, so every level is band-limited by harmonic
+             truncation instead of the 81-tap half-band FIR cascade, and no
+             level 0 round trip through the builder slot is needed.
+             Spectra are bins 0..frameSize/2 of an unnormalised forward DFT
+             of frameSize points (FftReal::forward()).
+    ==============================================================================
+    */
+    class SpectralMip final
+    {
+    public:
+        enum { TRIP = 3 };
+
+        /* per-thread inverse transforms and work buffers */
+        class Scratch
+        {
+        public:
+            Scratch(int frameSize, int nbrTables)
+                : _frameSize(frameSize)
+                , _re(frameSize / 2 + 1)
+                , _im(frameSize / 2 + 1)
+                , _out(frameSize)
+            {
+                assert((frameSize >> (nbrTables - 1)) >= 1);
+                for (int lvl = 0; lvl < nbrTables; ++lvl)
+                    _fft.emplace_back(new FftReal(frameSize >> lvl));
+            }
+
+        private:
+            friend class SpectralMip;
+
+            int                                   _frameSize;
+            std::vector<std::unique_ptr<FftReal>> _fft;
+            std::vector<float>                    _re;
+            std::vector<float>                    _im;
+            std::vector<float>                    _out;
+        };
+
+        /* empty pyramid ready for writeFrame() calls, then commit_direct() */
+        static std::shared_ptr<MipMapFlt> create(int frameSize, int nbrFrames, int nbrTables)
+        {
+            auto mp = std::make_shared<MipMapFlt>();
+            mp->init_sample_direct(long(frameSize) * TRIP * nbrFrames,
+                InterpPack::get_len_pre(), InterpPack::get_len_post(), nbrTables);
+            return mp;
+        }
+
+        /* all levels of one frame; distinct frames may be written concurrently */
+        static void writeFrame(MipMapFlt& mp, int frame, const float re[], const float im[], Scratch& s) noexcept
+        {
+            const int nbrTables = int(s._fft.size());
+            for (int lvl = 0; lvl < nbrTables; ++lvl)
+            {
+                const int   len = s._frameSize >> lvl;
+                const int   keep = std::max(len / 2, 1);            // DC always, Nyquist never
+                const float scale = float(len) / float(s._frameSize);
+
+                for (int h = 0; h < keep; ++h)
+                {
+                    s._re[h] = re[h] * scale;
+                    s._im[h] = im[h] * scale;
+                }
+                for (int h = keep; h <= len / 2; ++h)
+                {
+                    s._re[h] = 0.0f;
+                    s._im[h] = 0.0f;
+                }
+
+                s._fft[lvl]->inverse(s._re.data(), s._im.data(), s._out.data());
+
+                float* dst = mp.use_table_direct(lvl) + long(frame) * TRIP * len;
+                const size_t bytes = sizeof(float) * len;
+                for (int c = 0; c < TRIP; ++c)
+                    std::memcpy(dst + c * len, s._out.data(), bytes);
+            }
+        }
+    };
+
+} // namespace gw5
@@ -0,0 +1,148 @@
+// SpectralMorph.h   (FFT-domain blend of WaveMaker inputs)
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "FftReal.h"
+#include "JobPool.h"
+#include "MipMapFlt.hpp"
+#include "SpectralMip.h"
+#include "TableBlend.h"
+#include "Trace.h"
+
+namespace gw5
+{
+    /*
+    ==============================================================================
+    Name: SpectralMorph
+    Purpose: Per-frame spectral morph of the WaveMaker inputs. Magnitudes are
+             interpolated with the input gains (expected to sum to 1). Phases
+             are unwrapped against the strongest contribution of each bin and
+             averaged weighted by gain * magnitude, so frames whose harmonics
+             differ in phase don't cancel the way a time-domain crossfade does.
+             Frames are spread over the JobPool and written straight into a
+             SpectralMip pyramid.
+    ==============================================================================
+    */
+    class SpectralMorph final
+    {
+    public:
+        enum { FRAMES_PER_CHUNK = 16 };
+
+        /* nullptr if the job was cancelled on the way */
+        static std::shared_ptr<MipMapFlt> build(const TableBlend::Input in[], int nbrInputs,
+            int frameSize, int nbrFrames, int nbrTables, const JobPool::Job& job)
+        {
+            GW5_TRACE_SCOPE("SpectralMorph::build");
+
+            auto mp = SpectralMip::create(frameSize, nbrFrames, nbrTables);
+            std::atomic<bool> cancelled{ false };
+
+            JobPool::instance().parallelFor(nbrFrames, [&](int begin, int end)
+            {
+                GW5_TRACE_SCOPE("SpectralMorph::frames");
+
+                const int bins = frameSize / 2 + 1;
+                FftReal              fft(frameSize);
+                SpectralMip::Scratch mipScratch(frameSize, nbrTables);
+                std::vector<float>   inRe(size_t(bins) * nbrInputs), inIm(size_t(bins) * nbrInputs);
+                std::vector<float>   outRe(bins), outIm(bins);
+                std::vector<float>   frameBuf(frameSize);
+
+                for (int f = begin; f < end; ++f)
+                {
+                    if (job.isCancelled())
+                    {
+                        cancelled.store(true, std::memory_order_relaxed);
+                        return;
+                    }
+                    morphFrame(in, nbrInputs, f, frameSize, nbrFrames, fft,
+                        inRe.data(), inIm.data(), outRe.data(), outIm.data(), frameBuf.data());
+                    SpectralMip::writeFrame(*mp, f, outRe.data(), outIm.data(), mipScratch);
+                }
+            }, FRAMES_PER_CHUNK);
+
+            if (cancelled.load(std::memory_order_relaxed))
+                return nullptr;
+
+            mp->commit_direct();
+            return mp;
+        }
+
+    private:
+        static float wrapPi(float x) noexcept
+        {
+            const float twoPi = 6.2831853071795865f;
+            return x - twoPi * std::floor((x + 3.1415926535897932f) / twoPi);
+        }
+
+        static void morphFrame(const TableBlend::Input in[], int nbrInputs, int f, int frameSize, int nbrFrames,
+            FftReal& fft, float inRe[], float inIm[], float outRe[], float outIm[], float frameBuf[]) noexcept
+        {
+            const int bins = frameSize / 2 + 1;
+
+            /* spectra of the contributing inputs */
+            float gain[TableBlend::MAX_INPUTS];
+            int   nbrAct = 0;
+            for (int k = 0; k < nbrInputs && nbrAct < TableBlend::MAX_INPUTS; ++k)
+            {
+                if (in[k].data == nullptr || in[k].gain == 0.0f)
+                    continue;
+                const float* src = TableBlend::conditionedFrame(in[k], in[k].sourceFrame(f, nbrFrames), frameSize, frameBuf);
+                fft.forward(src, inRe + nbrAct * bins, inIm + nbrAct * bins);
+                gain[nbrAct] = in[k].gain;
+                ++nbrAct;
+            }
+
+            for (int h = 0; h < bins; ++h)
+            {
+                /* DC and Nyquist are real: plain weighted sum */
+                if (h == 0 || h == bins - 1)
+                {
+                    float re = 0.0f;
+                    for (int a = 0; a < nbrAct; ++a)
+                        re += gain[a] * inRe[a * bins + h];
+                    outRe[h] = re;
+                    outIm[h] = 0.0f;
+                    continue;
+                }
+
+                float mag[TableBlend::MAX_INPUTS];
+                float magSum = 0.0f;
+                int   ref = -1;
+                for (int a = 0; a < nbrAct; ++a)
+                {
+                    mag[a] = gain[a] * std::hypot(inRe[a * bins + h], inIm[a * bins + h]);
+                    magSum += mag[a];
+                    if (ref < 0 || mag[a] > mag[ref])
+                        ref = a;
+                }
+
+                if (magSum <= 1e-20f)
+                {
+                    outRe[h] = 0.0f;
+                    outIm[h] = 0.0f;
+                    continue;
+                }
+
+                const float phRef = std::atan2(inIm[ref * bins + h], inRe[ref * bins + h]);
+                float dev = 0.0f;
+                for (int a = 0; a < nbrAct; ++a)
+                {
+                    if (a == ref || mag[a] == 0.0f)
+                        continue;
+                    const float ph = std::atan2(inIm[a * bins + h], inRe[a * bins + h]);
+                    dev += mag[a] * wrapPi(ph - phRef);
+                }
+                const float ph = phRef + dev / magSum;
+
+                outRe[h] = magSum * std::cos(ph);
+                outIm[h] = magSum * std::sin(ph);
+            }
+        }
+    };
+
+} // namespace gw5
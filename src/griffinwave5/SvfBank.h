@@ -0,0 +1,170 @@
+// SvfBank.h   (state-variable filters for every voice of a node)
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "Trace.h"
+
+namespace gw5
+{
+    /*
+    ==============================================================================
+    Name: SvfBank
+    Purpose: One trapezoidal (zero-delay feedback) state-variable filter per
+             voice, stored as structure-of-arrays so a sample of every voice
+             is filtered in one pass of the inner loop. The caller renders the
+             voices into a sample-major slice (x[s * NBR_VOICES + v]), the bank
+             filters it in place and the caller sums the lanes into the mix.
+             The loop over voices has no dependencies between iterations and
+             is left to the compiler's vectoriser. That only pays when one
+             render holds several voices (a node rendering all its voices per
+             call); under HISE per-voice rendering there is one, and
+             processVoice() filters its buffer directly, with no slice.
+             Coefficients are only recomputed when a voice's cutoff moves.
+    ==============================================================================
+    */
+    template <int NBR_VOICES>
+    class SvfBank final
+    {
+    public:
+        enum Mode
+        {
+            Mode_OFF = 0,
+            Mode_LP,
+            Mode_BP,
+            Mode_HP,
+
+            Mode_NBR_ELT
+        };
+
+        static constexpr float MIN_HZ = 20.0f;
+        static constexpr float MAX_RATIO = 0.45f;   // highest cutoff, relative to the sample rate
+
+        void setSampleRate(double sr) noexcept
+        {
+            _sr = float(sr);
+            _cutoff.fill(-1.0f);
+        }
+
+        /* resonance 0..1 (1 is just short of self-oscillation) */
+        void setMode(int mode, float resonance) noexcept
+        {
+            _mode = std::clamp(mode, int(Mode_OFF), int(Mode_NBR_ELT) - 1);
+            _damp = 2.0f - 1.98f * std::clamp(resonance, 0.0f, 1.0f);
+            _cutoff.fill(-1.0f);
+        }
+
+        int getMode() const noexcept { return _mode; }
+
+        void resetVoice(int v) noexcept
+        {
+            _ic1[v] = _ic2[v] = _ic1R[v] = _ic2R[v] = 0.0f;
+        }
+
+        void setCutoff(int v, float hz) noexcept
+        {
+            hz = std::clamp(hz, MIN_HZ, MAX_RATIO * _sr);
+            if (hz == _cutoff[v])
+                return;
+            _cutoff[v] = hz;
+
+            const float g = std::tan(3.14159265f * hz / _sr);
+            const float a1 = 1.0f / (1.0f + g * (g + _damp));
+            _a1[v] = a1;
+            _a2[v] = g * a1;
+            _a3[v] = g * g * a1;
+        }
+
+        /* filters voices [0, nbrVoices) of a len x NBR_VOICES slice in place;
+           xR may be null (mono) */
+        void process(float x[], float xR[], int len, int nbrVoices) noexcept
+        {
+            GW5_TRACE_SCOPE("SvfBank::process");
+
+            float m0, m1, m2;
+            if (!getMix(m0, m1, m2))
+                return;
+
+            runChannel(x, _ic1.data(), _ic2.data(), len, nbrVoices, m0, m1, m2);
+            if (xR != nullptr)
+                runChannel(xR, _ic1R.data(), _ic2R.data(), len, nbrVoices, m0, m1, m2);
+        }
+
+        /* filters voice v's contiguous buffer in place; xR may be null */
+        void processVoice(int v, float x[], float xR[], int len) noexcept
+        {
+            float m0, m1, m2;
+            if (!getMix(m0, m1, m2))
+                return;
+
+            runVoice(v, x, _ic1[v], _ic2[v], len, m0, m1, m2);
+            if (xR != nullptr)
+                runVoice(v, xR, _ic1R[v], _ic2R[v], len, m0, m1, m2);
+        }
+
+    private:
+        bool getMix(float& m0, float& m1, float& m2) const noexcept
+        {
+            switch (_mode)
+            {
+            case Mode_LP: m0 = 0.0f; m1 = 0.0f;   m2 = 1.0f;  return true;
+            case Mode_BP: m0 = 0.0f; m1 = 1.0f;   m2 = 0.0f;  return true;
+            case Mode_HP: m0 = 1.0f; m1 = -_damp; m2 = -1.0f; return true;
+            default: return false;
+            }
+        }
+
+        void runVoice(int v, float x[], float& ic1, float& ic2, int len, float m0, float m1, float m2) noexcept
+        {
+            const float a1 = _a1[v], a2 = _a2[v], a3 = _a3[v];
+            float s1 = ic1, s2 = ic2;
+            for (int s = 0; s < len; ++s)
+            {
+                const float v0 = x[s];
+                const float v3 = v0 - s2;
+                const float v1 = a1 * s1 + a2 * v3;
+                const float v2 = s2 + a2 * s1 + a3 * v3;
+                s1 = 2.0f * v1 - s1;
+                s2 = 2.0f * v2 - s2;
+                x[s] = m0 * v0 + m1 * v1 + m2 * v2;
+            }
+            ic1 = s1;
+            ic2 = s2;
+        }
+
+        void runChannel(float x[], float* __restrict ic1, float* __restrict ic2, int len, int nbrVoices,
+            float m0, float m1, float m2) noexcept
+        {
+            const float* __restrict a1 = _a1.data();
+            const float* __restrict a2 = _a2.data();
+            const float* __restrict a3 = _a3.data();
+
+            for (int s = 0; s < len; ++s)
+            {
+                float* __restrict row = x + s * NBR_VOICES;
+                for (int v = 0; v < nbrVoices; ++v)
+                {
+                    const float v0 = row[v];
+                    const float v3 = v0 - ic2[v];
+                    const float v1 = a1[v] * ic1[v] + a2[v] * v3;
+                    const float v2 = ic2[v] + a2[v] * ic1[v] + a3[v] * v3;
+                    ic1[v] = 2.0f * v1 - ic1[v];
+                    ic2[v] = 2.0f * v2 - ic2[v];
+                    row[v] = m0 * v0 + m1 * v1 + m2 * v2;
+                }
+            }
+        }
+
+        using Lanes = std::array<float, NBR_VOICES>;
+
+        alignas(16) Lanes _a1{}, _a2{}, _a3{};
+        alignas(16) Lanes _ic1{}, _ic2{}, _ic1R{}, _ic2R{};
+        Lanes  _cutoff{};
+        float  _sr = 44100.0f;
+        float  _damp = 2.0f;
+        int    _mode = Mode_OFF;
+    };
+
+} // namespace gw5
@@ -0,0 +1,278 @@
+// TableBlend.h   (WaveMaker blend path, host independent)
+#pragma once
+
+#include <cmath>
+#include <cstring>
+
+#include "FrameConditioner.h"
+#include "SimdKernels.h"
+
+namespace gw5
+{
+    /*
+    ==============================================================================
+    Name: TableBlend
+    Purpose: The stages Griffin_WaveMaker runs on its worker thread, kept free of
+             JUCE/HISE types so headless tools drive exactly the same code.
+    ==============================================================================
+    */
+    struct TableBlend
+    {
+        enum { MAX_INPUTS = 8 };
+
+        /* one weighted source table; frames are read starting at frameOffset
+           (wrapping), in reverse frame order when reverse is set. Stereo
+           inputs are planar (dataR is the right channel), mono ones feed both
+           channels of a stereo blend. cond, if set, holds the input's
+           per-frame DC / gain / rotation (FrameConditioner). */
+        struct Input
+        {
+            const float* data = nullptr;
+            const float* dataR = nullptr;
+            float        gain = 0.0f;
+            int          frameOffset = 0;
+            bool         reverse = false;
+            const FrameConditioning* cond = nullptr;
+
+            /* input frame read for output frame f */
+            int sourceFrame(int f, int nbrFrames) const noexcept
+            {
+                int src = (f + frameOffset) % nbrFrames;
+                if (src < 0) src += nbrFrames;
+                return reverse ? nbrFrames - 1 - src : src;
+            }
+
+            /* gain, DC bias and read rotation of source frame src */
+            void frameTerms(int src, bool right, float& g, float& bias, int& rot) const noexcept
+            {
+                g = gain;
+                bias = 0.0f;
+                rot = 0;
+                if (cond == nullptr)
+                    return;
+
+                g *= cond->gain[src];
+                bias = -(right ? cond->dcR[src] : cond->dc[src]) * g;
+                rot = cond->rotate[src];
+            }
+        };
+
+        /* left / mono source frame src with its conditioning applied, into
+           tmp (frameSize samples) unless there is none; for stages that need
+           the frame whole */
+        static const float* conditionedFrame(const Input& in, int src, int frameSize, float* tmp) noexcept
+        {
+            const float* s = in.data + long(src) * frameSize;
+            if (in.cond == nullptr)
+                return s;
+
+            // the input gain is left to the stage
+            const float g = in.cond->gain[src];
+            simd::dispatch([&](auto k) {
+                accumulate<decltype(k)>(tmp, s, in.cond->rotate[src], frameSize, g, -in.cond->dc[src] * g, true);
+                });
+            return tmp;
+        }
+
+        /* dst[i] (+)= s[(i + rot) % n] * g + bias, in two straight runs */
+        template <class K = simd::Generic>
+        static void accumulate(float* dst, const float* s, int rot, int n, float g, float bias, bool first) noexcept
+        {
+            const int head = n - rot;
+            K::scale_bias(dst, s + rot, head, g, bias, !first);
+            K::scale_bias(dst + head, s, rot, g, bias, !first);
+        }
+
+        /* both channels in one pass, into interleaved dst */
+        template <class K = simd::Generic>
+        static void accumulateStereo(float* dst, const float* l, const float* r, int rot, int n,
+                                     float g, float biasL, float biasR, bool first) noexcept
+        {
+            const int head = n - rot;
+            K::scale_bias_stereo(dst, l + rot, r + rot, head, g, biasL, biasR, !first);
+            K::scale_bias_stereo(dst + head * 2, l, r, rot, g, biasL, biasR, !first);
+        }
+
+        /* equal-power cos/sin gains; a missing input gets 0, a lone input 1 */
+        static void equalPowerGains(double mix, bool has0, bool has1, float& g0, float& g1) noexcept
+        {
+            g0 = 0.0f;
+            g1 = 0.0f;
+            if (has0 && has1)
+            {
+                const double angle = mix * 1.5707963267948966;
+                g0 = static_cast<float>(std::cos(angle));
+                g1 = static_cast<float>(std::sin(angle));
+            }
+            else if (has0) g0 = 1.0f;
+            else if (has1) g1 = 1.0f;
+        }
+
+        /* linear pair for the spectral morph, same missing-input rules */
+        static void linearGains(double mix, bool has0, bool has1, float& g0, float& g1) noexcept
+        {
+            g0 = 0.0f;
+            g1 = 0.0f;
+            if (has0 && has1)
+            {
+                g0 = static_cast<float>(1.0 - mix);
+                g1 = static_cast<float>(mix);
+            }
+            else if (has0) g0 = 1.0f;
+            else if (has1) g1 = 1.0f;
+        }
+
+        /* 2 if any active input is stereo */
+        static int channelsOf(const Input in[], int nbrInputs) noexcept
+        {
+            for (int k = 0; k < nbrInputs; ++k)
+                if (in[k].data != nullptr && in[k].dataR != nullptr && in[k].gain != 0.0f)
+                    return 2;
+            return 1;
+        }
+
+        /* scales the gains down so they sum to 1 at most; below that the
+           weights are absolute levels */
+        static void normalizeSum(Input in[], int nbrInputs) noexcept
+        {
+            double sum = 0.0;
+            for (int k = 0; k < nbrInputs; ++k)
+                sum += in[k].gain;
+            if (sum <= 1.0)
+                return;
+
+            const float scale = static_cast<float>(1.0 / sum);
+            for (int k = 0; k < nbrInputs; ++k)
+                in[k].gain *= scale;
+        }
+
+        /* scales the gains down so their squares sum to 1 at most (the
+           cos/sin pair is already there); below that, a lone input or a
+           quiet mix keeps its Weight as an absolute level */
+        static void normalizePower(Input in[], int nbrInputs) noexcept
+        {
+            double sum = 0.0;
+            for (int k = 0; k < nbrInputs; ++k)
+                sum += double(in[k].gain) * double(in[k].gain);
+            if (sum <= 1.0)
+                return;
+
+            const float scale = static_cast<float>(1.0 / std::sqrt(sum));
+            for (int k = 0; k < nbrInputs; ++k)
+                in[k].gain *= scale;
+        }
+
+        /* Weighted sum of all inputs written straight into the builder slot
+           layout (every frame three times in a row). One output frame at a
+           time: it stays in L1 while the inputs are accumulated into the middle
+           copy, then the outer copies are filled from it. Inputs with a null
+           pointer or zero gain are skipped. With nbrChn == 2 the output is
+           interleaved stereo (the MipMapFlt layout). Runs with the kernel
+           variant CpuFeatures selected. */
+        static void blendTripled(float* dst, const Input in[], int nbrInputs, int frameSize, int nbrFrames, int nbrChn = 1) noexcept
+        {
+            simd::dispatch([&](auto k) {
+                if (nbrChn == 2) blendTripledStereo<decltype(k)>(dst, in, nbrInputs, frameSize, nbrFrames);
+                else             blendTripledMono<decltype(k)>(dst, in, nbrInputs, frameSize, nbrFrames);
+                });
+        }
+
+        template <class K>
+        static void blendTripledMono(float* dst, const Input in[], int nbrInputs, int frameSize, int nbrFrames) noexcept
+        {
+            const size_t bytes = sizeof(float) * frameSize;
+
+            for (int f = 0; f < nbrFrames; ++f)
+            {
+                float* mid = dst + frameSize;
+                bool first = true;
+
+                for (int k = 0; k < nbrInputs; ++k)
+                {
+                    if (in[k].data == nullptr || in[k].gain == 0.0f)
+                        continue;
+
+                    const int    src = in[k].sourceFrame(f, nbrFrames);
+                    const float* s = in[k].data + long(src) * frameSize;
+                    float g, bias;
+                    int   rot;
+                    in[k].frameTerms(src, false, g, bias, rot);
+
+                    accumulate<K>(mid, s, rot, frameSize, g, bias, first);
+                    first = false;
+                }
+
+                if (first)
+                    std::memset(mid, 0, bytes);
+
+                std::memcpy(dst, mid, bytes);
+                std::memcpy(mid + frameSize, mid, bytes);
+                dst += frameSize * 3;
+            }
+        }
+
+        template <class K>
+        static void blendTripledStereo(float* dst, const Input in[], int nbrInputs, int frameSize, int nbrFrames) noexcept
+        {
+            const int    frameLen = frameSize * 2;
+            const size_t bytes = sizeof(float) * frameLen;
+
+            for (int f = 0; f < nbrFrames; ++f)
+            {
+                float* mid = dst + frameLen;
+                bool first = true;
+
+                for (int k = 0; k < nbrInputs; ++k)
+                {
+                    if (in[k].data == nullptr || in[k].gain == 0.0f)
+                        continue;
+
+                    const int    src = in[k].sourceFrame(f, nbrFrames);
+                    const long   ofs = long(src) * frameSize;
+                    const bool   stereoIn = (in[k].dataR != nullptr);
+                    const float* l = in[k].data + ofs;
+                    const float* r = stereoIn ? in[k].dataR + ofs : l;
+                    float g, biasL, biasR;
+                    int   rot;
+                    in[k].frameTerms(src, false, g, biasL, rot);
+                    in[k].frameTerms(src, stereoIn, g, biasR, rot);
+
+                    accumulateStereo<K>(mid, l, r, rot, frameSize, g, biasL, biasR, first);
+                    first = false;
+                }
+
+                if (first)
+                    std::memset(mid, 0, bytes);
+
+                std::memcpy(dst, mid, bytes);
+                std::memcpy(mid + frameLen, mid, bytes);
+                dst += frameLen * 3;
+            }
+        }
+
+        /* every factor-th sample, GUI preview */
+        static void decimate(float* dst, const float* src, long dstLen, int factor) noexcept
+        {
+            for (long i = 0; i < dstLen; ++i)
+                dst[i] = src[i * factor];
+        }
+
+        /* same, reading the middle copy of each frame of a tripled table;
+           interleaved stereo is previewed as the channel average */
+        static void decimateTripled(float* dst, const float* src, int frameSize, int nbrFrames, int factor, int nbrChn = 1) noexcept
+        {
+            for (int f = 0; f < nbrFrames; ++f)
+            {
+                const float* mid = src + frameSize * nbrChn;
+                if (nbrChn == 1)
+                    decimate(dst, mid, frameSize / factor, factor);
+                else
+                    for (int i = 0; i < frameSize / factor; ++i)
+                        dst[i] = 0.5f * (mid[2 * i * factor] + mid[2 * i * factor + 1]);
+                dst += frameSize / factor;
+                src += frameSize * 3 * nbrChn;
+            }
+        }
+    };
+
+} // namespace gw5
@@ -0,0 +1,246 @@
+// Trace.h   (optional span tracing, Chrome/Perfetto JSON export)
+#pragma once
+
+/*
+    Compile with GW5_TRACE=1 to enable. When disabled every GW5_TRACE_SCOPE()
+    and GW5_TRACE_COUNTER() expands to nothing. Define GW5_TRACE_FILE="path.json" to get the trace
+    written automatically at process exit, or call
+    gw5::Trace::instance().writeChromeJsonFile() at any time.
+    Open the result in chrome://tracing or ui.perfetto.dev.
+*/
+#if ! defined (GW5_TRACE)
+    #define GW5_TRACE 0
+#endif
+
+#if GW5_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace gw5
+{
+    /*
+    ==============================================================================
+    Name: Trace
+    Purpose: Collects timed spans and counter values into one ring buffer per
+             thread. Writing one is wait-free for the owning thread (no lock, no
+             allocation once the thread is registered). Older entries are
+             overwritten when a ring is full. Names must be string literals.
+    ==============================================================================
+    */
+    class Trace final
+    {
+    public:
+        enum { RING_SIZE_L2 = 15 };
+        enum { RING_SIZE = 1 << RING_SIZE_L2 };
+
+        /* a counter sample has endNs < 0 and its value in 'value' */
+        struct Span
+        {
+            const char* name;
+            int64_t     beginNs;
+            int64_t     endNs;
+            int64_t     value;
+        };
+
+        /* singleton access */
+        static Trace& instance() noexcept
+        {
+            static Trace s;
+            return s;
+        }
+
+        static int64_t nowNs() noexcept
+        {
+            using namespace std::chrono;
+            return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+        }
+
+        /* optional: register (and name) the calling thread ahead of time so the
+           first span on an audio thread doesn't allocate */
+        void registerThread(const char* threadName)
+        {
+            ThreadRing* r = ring();
+            if (r == nullptr)
+                return;
+            std::lock_guard<std::mutex> lock(_mutex);
+            r->name = threadName;
+        }
+
+        /* allocates rings ahead for threads that can't register themselves
+           (a host's audio thread): call from prepare. The first span on a
+           new thread then takes a spare instead of allocating */
+        void reserveThreads(int nbrThreads)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            while (int(_spares.size()) < nbrThreads)
+                _spares.push_back(std::make_unique<ThreadRing>());
+        }
+
+        void record(const char* name, int64_t beginNs, int64_t endNs) noexcept
+        {
+            ThreadRing* r = ring();
+            if (r == nullptr)
+                return;                                 // no ring could be had: span dropped
+            const uint64_t w = r->head.load(std::memory_order_relaxed);
+            r->spans[w & (RING_SIZE - 1)] = Span{ name, beginNs, endNs, 0 };
+            r->head.store(w + 1, std::memory_order_release);
+        }
+
+        /* a counter's new value, shown as a track in the viewer */
+        void recordCounter(const char* name, int64_t value) noexcept
+        {
+            ThreadRing* r = ring();
+            if (r == nullptr)
+                return;
+            const uint64_t w = r->head.load(std::memory_order_relaxed);
+            r->spans[w & (RING_SIZE - 1)] = Span{ name, nowNs(), -1, value };
+            r->head.store(w + 1, std::memory_order_release);
+        }
+
+        /* Chrome trace event format, complete ("X") and counter ("C") events */
+        void writeChromeJson(std::ostream& os)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            os << "{\"traceEvents\":[\n";
+            bool first = true;
+
+            for (size_t t = 0; t < _rings.size(); ++t)
+            {
+                const ThreadRing& r = *_rings[t];
+
+                os << (first ? "" : ",\n")
+                    << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+                    << ",\"args\":{\"name\":\"" << r.name << "\"}}";
+                first = false;
+
+                const uint64_t head = r.head.load(std::memory_order_acquire);
+                const uint64_t count = head < uint64_t(RING_SIZE) ? head : uint64_t(RING_SIZE);
+                for (uint64_t i = head - count; i < head; ++i)
+                {
+                    const Span& s = r.spans[i & (RING_SIZE - 1)];
+                    if (s.endNs < 0)
+                    {
+                        os << ",\n{\"name\":\"" << s.name << "\",\"ph\":\"C\",\"pid\":1,\"tid\":" << t
+                            << ",\"ts\":" << double(s.beginNs - _originNs) * 1e-3
+                            << ",\"args\":{\"value\":" << s.value << "}}";
+                        continue;
+                    }
+                    os << ",\n{\"name\":\"" << s.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << t
+                        << ",\"ts\":" << double(s.beginNs - _originNs) * 1e-3
+                        << ",\"dur\":" << double(s.endNs - s.beginNs) * 1e-3 << "}";
+                }
+            }
+
+            os << "\n]}\n";
+        }
+
+        bool writeChromeJsonFile(const char* path)
+        {
+            std::ofstream f(path);
+            if (!f)
+                return false;
+            writeChromeJson(f);
+            return bool(f);
+        }
+
+    private:
+        struct ThreadRing
+        {
+            std::string           name;
+            std::atomic<uint64_t> head{ 0 };
+            Span                  spans[RING_SIZE];
+        };
+
+        Trace() : _originNs(nowNs()) {}
+
+        ~Trace()
+        {
+#if defined (GW5_TRACE_FILE)
+            writeChromeJsonFile(GW5_TRACE_FILE);
+#endif
+        }
+
+        Trace(const Trace&) = delete;
+        Trace& operator=(const Trace&) = delete;
+
+        /* the calling thread's ring: a spare if one was reserved, else a new
+           one; nullptr if that allocation fails (spans end in destructors,
+           which must not throw) */
+        ThreadRing* ring() noexcept
+        {
+            thread_local ThreadRing* tl = nullptr;
+            if (tl == nullptr)
+            {
+                try
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _rings.reserve(_rings.size() + 1);
+                    std::unique_ptr<ThreadRing> r;
+                    if (!_spares.empty())
+                    {
+                        r = std::move(_spares.back());
+                        _spares.pop_back();
+                    }
+                    else
+                    {
+                        r = std::make_unique<ThreadRing>();
+                    }
+                    r->name = "thread " + std::to_string(_rings.size());
+                    tl = r.get();
+                    _rings.push_back(std::move(r));
+                }
+                catch (...)
+                {
+                    return nullptr;
+                }
+            }
+            return tl;
+        }
+
+        std::mutex                               _mutex;   // registration and dump only
+        std::vector<std::unique_ptr<ThreadRing>> _rings;   // never shrinks
+        std::vector<std::unique_ptr<ThreadRing>> _spares;  // reserved, not yet taken
+        const int64_t                            _originNs;
+    };
+
+    /* RAII span */
+    class TraceScope final
+    {
+    public:
+        explicit TraceScope(const char* name) noexcept : _name(name), _begin(Trace::nowNs()) {}
+        ~TraceScope() { Trace::instance().record(_name, _begin, Trace::nowNs()); }
+
+    private:
+        const char* _name;
+        int64_t     _begin;
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+    };
+
+} // namespace gw5
+
+#define GW5_TRACE_CONCAT_(a, b) a##b
+#define GW5_TRACE_CONCAT(a, b) GW5_TRACE_CONCAT_(a, b)
+#define GW5_TRACE_SCOPE(name) gw5::TraceScope GW5_TRACE_CONCAT(gw5_trace_scope_, __LINE__)(name)
+#define GW5_TRACE_COUNTER(name, value) gw5::Trace::instance().recordCounter(name, int64_t(value))
+#define GW5_TRACE_THREAD(name) gw5::Trace::instance().registerThread(name)
+#define GW5_TRACE_RESERVE(nbrThreads) gw5::Trace::instance().reserveThreads(nbrThreads)
+
+#else
+
+#define GW5_TRACE_SCOPE(name) ((void)0)
+#define GW5_TRACE_COUNTER(name, value) ((void)0)
+#define GW5_TRACE_THREAD(name) ((void)0)
+#define GW5_TRACE_RESERVE(nbrThreads) ((void)0)
+
+#endif // GW5_TRACE
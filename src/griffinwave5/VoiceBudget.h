@@ -0,0 +1,255 @@
+// VoiceBudget.h   (process-wide voice ceiling shared by every oscillator node)
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+
+#include "Trace.h"
+
+namespace gw5
+{
+    /*
+    ==============================================================================
+    Name: VoiceBudget
+    Purpose: One voice count for the whole process, so stacking layers of
+             oscillator nodes cannot multiply the peak CPU. A node takes a
+             ticket per voice at note-on and returns it when the voice ends.
+             At the ceiling the new voice takes the place of a victim chosen
+             across all nodes:
+               - lowest node priority first (a node may not steal from a
+                 node above it; with no such victim the new voice is refused)
+               - then Policy_QUIETEST (lowest published level, then oldest)
+                 or Policy_OLDEST
+             The victim is only flagged; its node sees the flag at its next
+             block and fades the voice out, so nothing touches another
+             node's voices. A flagged voice no longer counts.
+             Lock-free: the ceiling is a reservation counter, tickets and
+             steals are compare-and-swaps on a fixed table. Every entry
+             carries a generation, so a steal only lands on the voice it
+             chose, never on one that took the entry meanwhile. Safe from any
+             number of audio threads; the ceiling and the policy may be set
+             from any thread. A ceiling of 0 turns the budget off.
+    ==============================================================================
+    */
+    class VoiceBudget final
+    {
+    public:
+        enum Policy
+        {
+            Policy_QUIETEST = 0,
+            Policy_OLDEST,
+
+            Policy_NBR_ELT
+        };
+
+        static constexpr int MAX_VOICES = 512;         // highest ceiling
+        static constexpr int TABLE_LEN = MAX_VOICES * 2;   // + voices still fading out
+        static constexpr int NO_TICKET = -1;           // budget off, the voice is not counted
+        static constexpr int REFUSED = -2;             // at the ceiling, no victim allowed
+
+        struct Stats
+        {
+            int           limit = 0;
+            int           live = 0;                     // counted voices, all nodes
+            int           peak = 0;
+            std::uint32_t steals = 0;
+            std::uint32_t refusals = 0;
+        };
+
+        static VoiceBudget& instance()
+        {
+            static VoiceBudget s;
+            return s;
+        }
+
+        /* lowering it flags victims right away down to the new ceiling */
+        void setLimit(int nbrVoices) noexcept
+        {
+            const int limit = std::clamp(nbrVoices, 0, MAX_VOICES);
+            _limit.store(limit, std::memory_order_relaxed);
+            if (limit == 0)
+                return;
+            int live = _live.load(std::memory_order_relaxed);
+            while (live > limit)
+            {
+                if (stealVictim(INT_MAX) < 0)
+                    break;
+                _steals.fetch_add(1, std::memory_order_relaxed);
+                live = _live.fetch_sub(1, std::memory_order_acq_rel) - 1;
+            }
+        }
+
+        void setPolicy(int policy) noexcept
+        {
+            _policy.store(std::clamp(policy, 0, int(Policy_NBR_ELT) - 1), std::memory_order_relaxed);
+        }
+
+        bool isEnabled() const noexcept { return _limit.load(std::memory_order_relaxed) > 0; }
+
+        /* ticket for a new voice of 'owner', or NO_TICKET / REFUSED */
+        int acquire(const void* owner, int priority) noexcept
+        {
+            const int limit = _limit.load(std::memory_order_relaxed);
+            if (limit == 0)
+                return NO_TICKET;
+
+            // reserve a place under the ceiling, or take a victim's
+            int live = _live.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                if (live >= limit)
+                {
+                    if (stealVictim(priority) < 0)
+                    {
+                        _refusals.fetch_add(1, std::memory_order_relaxed);
+                        return REFUSED;
+                    }
+                    _steals.fetch_add(1, std::memory_order_relaxed);
+                    break;
+                }
+                if (_live.compare_exchange_weak(live, live + 1, std::memory_order_acq_rel))
+                {
+                    live += 1;
+                    break;
+                }
+            }
+
+            int peak = _peak.load(std::memory_order_relaxed);
+            while (live > peak && !_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+
+            for (int t = 0; t < TABLE_LEN; ++t)
+            {
+                Entry& e = _table[t];
+                const void* expected = nullptr;
+                if (e.owner.load(std::memory_order_relaxed) == nullptr
+                    && e.owner.compare_exchange_strong(expected, owner, std::memory_order_acq_rel))
+                {
+                    e.priority.store(priority, std::memory_order_relaxed);
+                    e.level.store(0.0f, std::memory_order_relaxed);
+                    e.start.store(_clock.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+                    const std::uint32_t gen = (e.state.load(std::memory_order_relaxed) | STOLEN) + 1;
+                    e.state.store(gen, std::memory_order_release);   // new generation, counted
+                    return t;
+                }
+            }
+
+            // table full of voices still fading: give the place back
+            _live.fetch_sub(1, std::memory_order_acq_rel);
+            _refusals.fetch_add(1, std::memory_order_relaxed);
+            return REFUSED;
+        }
+
+        /* when the voice has ended (stolen or not); negative tickets are ignored */
+        void release(int ticket) noexcept
+        {
+            if (ticket < 0)
+                return;
+            Entry& e = _table[ticket];
+            if ((e.state.fetch_or(STOLEN, std::memory_order_acq_rel) & STOLEN) == 0)
+                _live.fetch_sub(1, std::memory_order_acq_rel);
+            e.owner.store(nullptr, std::memory_order_release);
+        }
+
+        /* peak of the voice's last block, for Policy_QUIETEST */
+        void setLevel(int ticket, float level) noexcept
+        {
+            if (ticket >= 0)
+                _table[ticket].level.store(level, std::memory_order_relaxed);
+        }
+
+        /* true once another voice took this one's place: fade it out */
+        bool isStolen(int ticket) const noexcept
+        {
+            return ticket >= 0 && (_table[ticket].state.load(std::memory_order_acquire) & STOLEN) != 0;
+        }
+
+        Stats getStats() const noexcept
+        {
+            Stats s;
+            s.limit = _limit.load(std::memory_order_relaxed);
+            s.live = _live.load(std::memory_order_relaxed);
+            s.peak = _peak.load(std::memory_order_relaxed);
+            s.steals = _steals.load(std::memory_order_relaxed);
+            s.refusals = _refusals.load(std::memory_order_relaxed);
+            return s;
+        }
+
+    private:
+        static constexpr std::uint32_t STOLEN = 1;      // state bit 0: not counted
+
+        struct Entry
+        {
+            std::atomic<const void*>   owner{ nullptr };    // nullptr = free
+            std::atomic<std::uint32_t> state{ STOLEN };     // generation << 1 | STOLEN
+            std::atomic<int>           priority{ 0 };
+            std::atomic<float>         level{ 0.0f };
+            std::atomic<std::uint64_t> start{ 0 };
+        };
+
+        VoiceBudget() = default;
+        VoiceBudget(const VoiceBudget&) = delete;
+        VoiceBudget& operator=(const VoiceBudget&) = delete;
+
+        /* flags the best victim at or below 'priority'; its place in the
+           count passes to the caller. -1 if there is none */
+        int stealVictim(int priority) noexcept
+        {
+            GW5_TRACE_SCOPE("VoiceBudget::steal");
+
+            const bool oldest = (_policy.load(std::memory_order_relaxed) == Policy_OLDEST);
+            for (;;)
+            {
+                int   best = -1;
+                std::uint32_t bestState = 0;
+                int   bestPrio = 0;
+                float bestLevel = 0.0f;
+                std::uint64_t bestStart = 0;
+                for (int t = 0; t < TABLE_LEN; ++t)
+                {
+                    const Entry& e = _table[t];
+                    const std::uint32_t st = e.state.load(std::memory_order_acquire);
+                    if ((st & STOLEN) != 0 || e.owner.load(std::memory_order_acquire) == nullptr)
+                        continue;
+                    const int   p = e.priority.load(std::memory_order_relaxed);
+                    const float l = e.level.load(std::memory_order_relaxed);
+                    const std::uint64_t s = e.start.load(std::memory_order_relaxed);
+                    if (p > priority)
+                        continue;
+                    const bool better = (best < 0) || (p != bestPrio ? p < bestPrio
+                        : (!oldest && l != bestLevel) ? l < bestLevel
+                        : s < bestStart);
+                    if (better)
+                    {
+                        best = t;
+                        bestState = st;
+                        bestPrio = p;
+                        bestLevel = l;
+                        bestStart = s;
+                    }
+                }
+
+                if (best < 0)
+                    return -1;
+                // fails if the voice ended, was stolen, or the entry went to a
+                // new voice (new generation, maybe a higher priority) since
+                // the scan: look again
+                if (_table[best].state.compare_exchange_strong(bestState, bestState | STOLEN,
+                        std::memory_order_acq_rel))
+                    return best;
+            }
+        }
+
+        std::array<Entry, TABLE_LEN> _table{};
+        std::atomic<int>           _limit{ 0 };
+        std::atomic<int>           _policy{ Policy_QUIETEST };
+        std::atomic<int>           _live{ 0 };
+        std::atomic<int>           _peak{ 0 };
+        std::atomic<std::uint64_t> _clock{ 0 };
+        std::atomic<std::uint32_t> _steals{ 0 };
+        std::atomic<std::uint32_t> _refusals{ 0 };
+    };
+
+} // namespace gw5
@@ -0,0 +1,419 @@
+// VoiceEngine.h   (process-wide voice renderer shared by every node)
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined (__linux__) || defined (__APPLE__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+#include "Denormals.h"
+#include "MemStats.h"
+#include "Semaphore.h"
+#include "Trace.h"
+
+#if defined (_MSC_VER)
+    #include <intrin.h>
+#endif
+
+#if defined (_WIN64)
+extern "C" __declspec(dllimport) void* __stdcall GetCurrentThread(void);
+extern "C" __declspec(dllimport) int __stdcall GetThreadPriority(void*);
+extern "C" __declspec(dllimport) int __stdcall SetThreadPriority(void*, int);
+#endif
+
+namespace gw5
+{
+    /*
+    ==============================================================================
+    Name: VoiceEngine
+    Purpose: One renderer for the voices of every oscillator node in the
+             process. A node hands over a batch (one job per active voice,
+             all for the same block) and gets one output slot per job back,
+             which it mixes into its own buffer.
+             - Serial: a batch is rendered on the calling thread. HISE calls a
+               polyphonic node once per voice, so a batch holds one job there
+               and splitting it over threads never paid for the hand-off.
+             - Ahead: a node may post a whole block to be rendered by a
+               helper between two callbacks (lookahead mode). It is only
+               handed over while the helpers run at the audio thread's
+               priority (see noteAudioThread); otherwise it runs right away.
+               finish() runs it inline if no helper has claimed it, so the
+               audio thread only ever waits on a helper at its own priority.
+             - Shared: the helper threads belong to the engine, so layering
+               more nodes adds no threads. Each node renders into its own
+               slots (a few KB), so nodes on different audio threads never
+               share scratch.
+             - Real-time safe on the audio side: no locks, no allocation;
+               posting is an atomic store plus a semaphore post when a helper
+               sleeps. Idle helpers sleep on the semaphore without a timeout.
+             Slots and helpers are set up from prepare(), never from the
+             audio thread.
+    ==============================================================================
+    */
+    class VoiceEngine final
+    {
+    public:
+        /* renders job 'job' of 'ctx' into l / r (r only for stereo) */
+        using RenderFn = void (*)(void* ctx, int job, float l[], float r[], int nbrSpl);
+
+        static constexpr int SPIN_ROUNDS = 2000;   // helper polls before sleeping
+        static constexpr int MAX_AHEAD = 64;       // nodes in lookahead mode at once
+
+        /* one output slot (L and R) per job */
+        class Slots
+        {
+        public:
+            void reserve(int nbrJobs, int nbrSpl)
+            {
+                if (nbrJobs <= _maxJobs && nbrSpl <= _maxSpl)
+                    return;
+                const long long before = getMemBytes();
+                _maxJobs = std::max(_maxJobs, nbrJobs);
+                _maxSpl = std::max(_maxSpl, nbrSpl);
+                _mem.assign(size_t(_maxJobs) * size_t(_maxSpl) * 2, 0.0f);
+                MemStats::instance().add(MemStats::Category_VOICE_ENGINE, getMemBytes() - before);
+            }
+
+            float* l(int job) noexcept { return _mem.data() + size_t(job) * size_t(_maxSpl) * 2; }
+            float* r(int job) noexcept { return l(job) + _maxSpl; }
+
+            int getMaxJobs() const noexcept { return _maxJobs; }
+            int getMaxSpl() const noexcept { return _maxSpl; }
+
+            long long getMemBytes() const noexcept
+            {
+                return static_cast<long long>(_mem.capacity() * sizeof(float));
+            }
+
+            Slots() = default;
+            ~Slots() { MemStats::instance().add(MemStats::Category_VOICE_ENGINE, -getMemBytes()); }
+            Slots(const Slots&) = delete;
+            Slots& operator=(const Slots&) = delete;
+
+        private:
+            std::vector<float> _mem;
+            int                _maxJobs = 0;
+            int                _maxSpl = 0;
+        };
+
+        /* a block posted for rendering ahead; owned by the node */
+        struct Ahead
+        {
+            enum State
+            {
+                State_IDLE = 0,
+                State_POSTED,
+                State_RUNNING
+            };
+
+            void*             ctx = nullptr;
+            void              (*fn)(void* ctx) = nullptr;
+            Slots             slots;
+            std::atomic<int>  state{ State_IDLE };
+            bool              attached = false;
+        };
+
+        static VoiceEngine& instance()
+        {
+            static VoiceEngine s;
+            return s;
+        }
+
+        /* grows a node's slots to at least nbrJobs x nbrSpl; call from
+           prepare, not the audio thread */
+        void prepare(Slots& slots, int nbrJobs, int nbrSpl)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            slots.reserve(nbrJobs, nbrSpl);
+        }
+
+        /* must be called before the first attach to have an effect; 0 keeps
+           all rendering on the calling thread */
+        void setNbrHelpers(int n)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_helpers.empty())
+                _nbrHelpers = std::max(0, n);
+        }
+
+        int getNbrHelpers() const noexcept { return _nbrHelpers; }
+
+        /* renders jobs [0, nbrJobs) into 'slots'; they stay valid until the
+           next render into the same slots */
+        void render(void* ctx, RenderFn fn, int nbrJobs, int nbrSpl, bool stereo, Slots& slots) noexcept
+        {
+            GW5_TRACE_SCOPE("VoiceEngine::render");
+            for (int j = 0; j < nbrJobs; ++j)
+                fn(ctx, j, slots.l(j), stereo ? slots.r(j) : nullptr, nbrSpl);
+        }
+
+        /* called from the audio thread, cheap enough for every block: the
+           helpers take over its scheduling policy and priority once */
+        void noteAudioThread() noexcept
+        {
+            int state = Sched_NONE;
+            if (_schedState.load(std::memory_order_relaxed) != Sched_NONE
+                || !_schedState.compare_exchange_strong(state, Sched_READING, std::memory_order_acquire))
+                return;
+            Sched s;
+            if (!readSched(s))
+            {
+                _schedState.store(Sched_NONE, std::memory_order_release);
+                return;
+            }
+            _audioSched = s;
+            _schedState.store(Sched_READY, std::memory_order_release);
+            signal();
+        }
+
+        /* lookahead: registers a node's block task, sizes its slots and
+           starts the helpers on first use; call from prepare. detach
+           before the Ahead is destroyed */
+        void attach(Ahead& a, int nbrJobs, int nbrSpl)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            a.slots.reserve(nbrJobs, nbrSpl);
+            startHelpersLocked();
+            if (a.attached)
+                return;
+            for (auto& p : _ahead)
+                if (p.load(std::memory_order_relaxed) == nullptr)
+                {
+                    p.store(&a, std::memory_order_release);
+                    a.attached = true;
+                    return;
+                }
+        }
+
+        void detach(Ahead& a)
+        {
+            finish(a);
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!a.attached)
+                return;
+            for (auto& p : _ahead)
+                if (p.load(std::memory_order_relaxed) == &a)
+                    p.store(nullptr, std::memory_order_release);
+            a.attached = false;
+            while (_scanning.load() > 0)
+                std::this_thread::yield();
+        }
+
+        /* hands the task to the helpers; runs it right away if it is not
+           attached or the helpers do not run at the audio thread's priority */
+        void post(Ahead& a) noexcept
+        {
+            if (!a.attached || !hasMatchedHelpers())
+            {
+                a.fn(a.ctx);
+                return;
+            }
+            a.state.store(Ahead::State_POSTED, std::memory_order_release);
+            signal();
+        }
+
+        /* returns once the posted task is done: runs it here if no helper
+           has claimed it, else waits for a helper that has (which runs at
+           the audio thread's priority, see post) */
+        void finish(Ahead& a) noexcept
+        {
+            int s = Ahead::State_POSTED;
+            if (a.state.compare_exchange_strong(s, Ahead::State_RUNNING, std::memory_order_acq_rel))
+            {
+                ScopedNoDenormals noDenormals;      // may be a parameter change, off the audio thread
+                a.fn(a.ctx);
+                a.state.store(Ahead::State_IDLE, std::memory_order_release);
+                return;
+            }
+            while (a.state.load(std::memory_order_acquire) != Ahead::State_IDLE)
+                pause();
+        }
+
+        bool isPending(const Ahead& a) const noexcept
+        {
+            return a.state.load(std::memory_order_acquire) != Ahead::State_IDLE;
+        }
+
+        /* true once every helper runs with the audio thread's scheduling */
+        bool hasMatchedHelpers() const noexcept
+        {
+            const int n = _nbrStarted.load(std::memory_order_acquire);
+            return n > 0 && _matched.load(std::memory_order_acquire) == n;
+        }
+
+    private:
+        enum SchedState
+        {
+            Sched_NONE = 0,
+            Sched_READING,
+            Sched_READY
+        };
+
+        struct Sched
+        {
+            int policy = 0;
+            int priority = 0;
+        };
+
+        VoiceEngine()
+        {
+            MemStats::instance();                // outlives the engine
+            const int hw = int(std::thread::hardware_concurrency());
+            _nbrHelpers = std::clamp(hw / 2 - 1, 0, 3);
+        }
+
+        ~VoiceEngine()
+        {
+            _quit.store(true, std::memory_order_release);
+            for (size_t h = 0; h < _helpers.size(); ++h)
+                _sem.post();
+            for (auto& t : _helpers)
+                t.join();
+        }
+
+        VoiceEngine(const VoiceEngine&) = delete;
+        VoiceEngine& operator=(const VoiceEngine&) = delete;
+
+        static void pause() noexcept
+        {
+#if defined (_MSC_VER)
+            _mm_pause();
+#elif defined (__x86_64__) || defined (__i386__)
+            __builtin_ia32_pause();
+#else
+            std::this_thread::yield();
+#endif
+        }
+
+        static bool readSched(Sched& s) noexcept
+        {
+#if defined (__linux__) || defined (__APPLE__)
+            sched_param p{};
+            if (pthread_getschedparam(pthread_self(), &s.policy, &p) != 0)
+                return false;
+            s.priority = p.sched_priority;
+            return true;
+#elif defined (_WIN64)
+            s.priority = GetThreadPriority(GetCurrentThread());
+            return s.priority != 0x7fffffff;       // THREAD_PRIORITY_ERROR_RETURN
+#else
+            (void)s;
+            return false;
+#endif
+        }
+
+        static bool applySched(const Sched& s) noexcept
+        {
+#if defined (__linux__) || defined (__APPLE__)
+            sched_param p{};
+            p.sched_priority = s.priority;
+            return pthread_setschedparam(pthread_self(), s.policy, &p) == 0;
+#elif defined (_WIN64)
+            return SetThreadPriority(GetCurrentThread(), s.priority) != 0;
+#else
+            (void)s;
+            return false;
+#endif
+        }
+
+        void startHelpersLocked()
+        {
+            if (_helpers.empty() && _nbrHelpers > 0)
+            {
+                for (int h = 0; h < _nbrHelpers; ++h)
+                    _helpers.emplace_back([this] { helperLoop(); });
+                _nbrStarted.store(_nbrHelpers, std::memory_order_release);
+            }
+        }
+
+        /* the bump and the sleeper count are both seq_cst: either the
+           helper sees the bump before it sleeps, or this sees the sleeper */
+        void signal() noexcept
+        {
+            _signal.fetch_add(1, std::memory_order_seq_cst);
+            if (_sleepers.load(std::memory_order_seq_cst) > 0)
+                _sem.post();
+        }
+
+        void runAhead() noexcept
+        {
+            _scanning.fetch_add(1);
+            for (auto& p : _ahead)
+            {
+                Ahead* a = p.load(std::memory_order_acquire);
+                int s = Ahead::State_POSTED;
+                if (a != nullptr
+                    && a->state.compare_exchange_strong(s, Ahead::State_RUNNING, std::memory_order_acq_rel))
+                {
+                    a->fn(a->ctx);
+                    a->state.store(Ahead::State_IDLE, std::memory_order_release);
+                }
+            }
+            _scanning.fetch_sub(1);
+        }
+
+        void helperLoop()
+        {
+            GW5_TRACE_THREAD("gw5 voice helper");
+            ScopedNoDenormals noDenormals;
+            bool matched = false;
+            std::uint32_t seen = _signal.load(std::memory_order_acquire);
+            while (!_quit.load(std::memory_order_acquire))
+            {
+                if (!matched && _schedState.load(std::memory_order_acquire) == Sched_READY)
+                {
+                    matched = true;
+                    if (applySched(_audioSched))
+                        _matched.fetch_add(1, std::memory_order_release);
+                }
+
+                std::uint32_t sig = _signal.load(std::memory_order_acquire);
+                for (int i = 0; i < SPIN_ROUNDS && sig == seen; ++i)
+                {
+                    if ((i & 63) == 63) std::this_thread::yield();
+                    else                pause();
+                    sig = _signal.load(std::memory_order_acquire);
+                }
+
+                if (sig == seen)
+                {
+                    _sleepers.fetch_add(1, std::memory_order_seq_cst);
+                    if (_signal.load(std::memory_order_seq_cst) == seen
+                        && !_quit.load(std::memory_order_acquire))
+                        _sem.wait();
+                    _sleepers.fetch_sub(1, std::memory_order_seq_cst);
+                    continue;
+                }
+
+                seen = sig;
+                runAhead();
+            }
+        }
+
+        std::array<std::atomic<Ahead*>, MAX_AHEAD> _ahead{};
+        std::atomic<int>           _scanning{ 0 };
+
+        std::atomic<std::uint32_t> _signal{ 0 };     // bumped by every post
+        std::atomic<int>           _sleepers{ 0 };
+        std::atomic<bool>          _quit{ false };
+        Semaphore                  _sem;
+
+        Sched                      _audioSched;      // written once, before Sched_READY
+        std::atomic<int>           _schedState{ Sched_NONE };
+        std::atomic<int>           _nbrStarted{ 0 };
+        std::atomic<int>           _matched{ 0 };    // helpers running with _audioSched
+
+        int                        _nbrHelpers = 0;
+        std::vector<std::thread>   _helpers;
+        std::mutex                 _mutex;
+    };
+
+} // namespace gw5
@@ -0,0 +1,125 @@
+// VoicePool.h   (fixed-ceiling pool of render lanes, sized at prepare)
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace gw5
+{
+    /*
+    ==============================================================================
+    Name: VoicePool
+    Purpose: Owns up to a ceiling of T (a resampler lane with its buffers) and
+             lends them out one at a time, independently of the host's voice
+             slots. A voice holds only the lanes it plays right now: the
+             crossfade partner while a frame switch fades, the second
+             oscillator while it is on. What is paid for is the ceiling,
+             not slots x lanes per slot; the ceiling caps that memory and
+             does not add voices beyond the host's slots.
+             All allocation happens in prepare(); limit(), acquire() and
+             release() only move pointers and are real-time safe. The
+             pool is not thread-safe: the owner calls it from its audio
+             thread, with no render of its voices in flight.
+    ==============================================================================
+    */
+    template <class T>
+    class VoicePool final
+    {
+    public:
+        struct Stats
+        {
+            int           ceiling = 0;
+            int           allocated = 0;              // T objects alive, >= ceiling after a lowering
+            int           inUse = 0;
+            int           peak = 0;                   // most lent at once since prepare
+            std::uint32_t misses = 0;                 // acquire() calls refused
+        };
+
+        /* every item must be back; storage is trimmed or grown to 'ceiling' */
+        void prepare(int ceiling)
+        {
+            if (_inUse == 0)
+            {
+                _items.resize(std::min(_items.size(), size_t(std::max(0, ceiling))));
+                _free.clear();
+                for (auto& t : _items) _free.push_back(t.get());
+            }
+            _peak = _inUse;
+            _misses = 0;
+            _ceiling = std::max(0, ceiling);
+            _free.reserve(std::max(_items.size(), size_t(_ceiling)));
+            while (int(_items.size()) < _ceiling)
+            {
+                _items.push_back(std::make_unique<T>());
+                _free.push_back(_items.back().get());
+            }
+        }
+
+        /* caps acquire() without allocating: at most what prepare() made,
+           a higher ceiling waits for the next prepare() */
+        void limit(int ceiling) noexcept
+        {
+            _ceiling = std::clamp(ceiling, 0, int(_items.size()));
+        }
+
+        /* nullptr when the ceiling is reached */
+        T* acquire() noexcept
+        {
+            if (_inUse >= _ceiling || _free.empty())
+            {
+                ++_misses;
+                return nullptr;
+            }
+            T* t = _free.back();
+            _free.pop_back();
+            _peak = std::max(_peak, ++_inUse);
+            return t;
+        }
+
+        void release(T* t) noexcept
+        {
+            if (t == nullptr)
+                return;
+            _free.push_back(t);                       // capacity reserved in prepare
+            --_inUse;
+        }
+
+        /* every allocated item, lent or not */
+        template <class F>
+        void forEach(F&& f)
+        {
+            for (auto& t : _items) f(*t);
+        }
+
+        template <class F>
+        void forEach(F&& f) const
+        {
+            for (const auto& t : _items) f(*t);
+        }
+
+        int getCeiling() const noexcept { return _ceiling; }
+        int getInUse() const noexcept { return _inUse; }
+
+        Stats getStats() const noexcept
+        {
+            Stats s;
+            s.ceiling = _ceiling;
+            s.allocated = int(_items.size());
+            s.inUse = _inUse;
+            s.peak = _peak;
+            s.misses = _misses;
+            return s;
+        }
+
+    private:
+        std::vector<std::unique_ptr<T>> _items;
+        std::vector<T*> _free;
+        int           _ceiling = 0;
+        int           _inUse = 0;
+        int           _peak = 0;
+        std::uint32_t _misses = 0;
+    };
+
+} // namespace gw5
@@ -0,0 +1,149 @@
+// WavReader.h   (RIFF/WAVE parser working on mapped memory)
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace gw5
+{
+    /*
+    ==============================================================================
+    Name: WavReader
+    Purpose: Parses a WAV image in memory (usually a MappedFile) without copying
+             it: PCM 8/16/24/32 bit, IEEE float 32/64, WAVE_FORMAT_EXTENSIBLE.
+             Picks up the wavetable frame size from a 'clm ' chunk
+             ("<!>2048 ..." as written by common wavetable synths).
+             Sample reads convert on the fly and are safe from several threads.
+    ==============================================================================
+    */
+    class WavReader final
+    {
+    public:
+        /* false if the image isn't a WAV this reader understands */
+        bool parse(const uint8_t* data, size_t size) noexcept
+        {
+            *this = WavReader();
+            if (data == nullptr || size < 12
+                || std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0)
+                return false;
+
+            bool haveFmt = false;
+            size_t pos = 12;
+            while (pos + 8 <= size)
+            {
+                const uint8_t* ck = data + pos;
+                const size_t   len = readU32(ck + 4);
+                const uint8_t* body = ck + 8;
+                const size_t   avail = size - pos - 8;
+
+                if (std::memcmp(ck, "fmt ", 4) == 0 && len >= 16 && len <= avail)
+                {
+                    uint16_t tag = readU16(body);
+                    _nbrChannels = readU16(body + 2);
+                    _sampleRate = readU32(body + 4);
+                    _bits = readU16(body + 14);
+                    if (tag == 0xFFFE && len >= 26)           // WAVE_FORMAT_EXTENSIBLE
+                        tag = readU16(body + 24);
+                    _float = (tag == 3);
+                    haveFmt = (tag == 1 || tag == 3);
+                }
+                else if (std::memcmp(ck, "data", 4) == 0)
+                {
+                    _samples = body;
+                    _dataBytes = (len <= avail) ? len : avail;   // tolerate truncated files
+                }
+                else if (std::memcmp(ck, "clm ", 4) == 0 && len >= 4 && len <= avail
+                    && std::memcmp(body, "<!>", 3) == 0)
+                {
+                    _frameLength = parseInt(body + 3, len - 3);
+                }
+
+                pos += 8 + len + (len & 1);
+            }
+
+            const int bytesPerSample = _bits / 8;
+            const bool supported = _float ? (_bits == 32 || _bits == 64)
+                                          : (_bits == 8 || _bits == 16 || _bits == 24 || _bits == 32);
+            if (!haveFmt || !supported || _nbrChannels <= 0 || _samples == nullptr)
+            {
+                *this = WavReader();
+                return false;
+            }
+
+            _frameBytes = size_t(bytesPerSample) * _nbrChannels;
+            _nbrSamples = long(_dataBytes / _frameBytes);
+            return true;
+        }
+
+        int  getNbrChannels() const noexcept { return _nbrChannels; }
+        long getNbrSamples() const noexcept { return _nbrSamples; }     // per channel
+        int  getSampleRate() const noexcept { return int(_sampleRate); }
+
+        /* from the 'clm ' chunk, 0 if the file has none */
+        int  getFrameLength() const noexcept { return _frameLength; }
+
+        /* channel-averaged samples [start, start + count), clipped to the file */
+        void readMono(long start, long count, float dst[]) const noexcept
+        {
+            const float scale = 1.0f / float(_nbrChannels);
+            for (long i = 0; i < count; ++i)
+            {
+                const long s = start + i;
+                if (s < 0 || s >= _nbrSamples)
+                {
+                    dst[i] = 0.0f;
+                    continue;
+                }
+                const uint8_t* p = _samples + size_t(s) * _frameBytes;
+                float sum = 0.0f;
+                for (int c = 0; c < _nbrChannels; ++c)
+                    sum += readSample(p + size_t(c) * (_bits / 8));
+                dst[i] = sum * scale;
+            }
+        }
+
+    private:
+        static uint16_t readU16(const uint8_t* p) noexcept { return uint16_t(p[0] | (p[1] << 8)); }
+        static uint32_t readU32(const uint8_t* p) noexcept
+        {
+            return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+        }
+
+        static int parseInt(const uint8_t* p, size_t len) noexcept
+        {
+            int v = 0;
+            for (size_t i = 0; i < len && p[i] >= '0' && p[i] <= '9' && v < 1 << 20; ++i)
+                v = v * 10 + (p[i] - '0');
+            return v;
+        }
+
+        float readSample(const uint8_t* p) const noexcept
+        {
+            if (_float)
+            {
+                if (_bits == 32) { float f;  std::memcpy(&f, p, 4); return f; }
+                double d; std::memcpy(&d, p, 8); return float(d);
+            }
+            switch (_bits)
+            {
+            case 8:  return (float(p[0]) - 128.0f) * (1.0f / 128.0f);
+            case 16: return float(int16_t(readU16(p))) * (1.0f / 32768.0f);
+            case 24: return float(int32_t(uint32_t(p[0] << 8) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 24)) >> 8)
+                            * (1.0f / 8388608.0f);
+            default: return float(double(int32_t(readU32(p))) * (1.0 / 2147483648.0));
+            }
+        }
+
+        const uint8_t* _samples = nullptr;
+        size_t         _dataBytes = 0;
+        size_t         _frameBytes = 0;
+        long           _nbrSamples = 0;
+        int            _nbrChannels = 0;
+        uint32_t       _sampleRate = 0;
+        int            _bits = 0;
+        bool           _float = false;
+        int            _frameLength = 0;
+    };
+
+} // namespace gw5
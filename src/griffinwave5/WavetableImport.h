@@ -0,0 +1,208 @@
+// WavetableImport.h   (WAV frames -> internal frame layout)
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "FftReal.h"
+#include "JobPool.h"
+#include "Trace.h"
+#include "WavReader.h"
+
+namespace gw5
+{
+    /*
+    ==============================================================================
+    Name: WavetableImport
+    Purpose: Cuts a WAV into frames of a given length and converts them to
+             nbrFrames frames of frameSize samples, on the JobPool. Source frames
+             are spread evenly over the output (linear interpolation between
+             neighbours when the counts differ). Each frame is resampled as one
+             period: spectrally when both lengths are powers of 2, with a
+             periodic windowed sinc otherwise.
+    ==============================================================================
+    */
+    class WavetableImport final
+    {
+    public:
+        enum { FRAMES_PER_CHUNK = 16 };
+        enum { SINC_ZEROS = 8 };
+
+        /* false if the job was cancelled or the file holds no complete frame */
+        static bool convert(const WavReader& wav, int srcFrameLen, float dst[], int frameSize, int nbrFrames,
+            const JobPool::Job& job)
+        {
+            GW5_TRACE_SCOPE("WavetableImport::convert");
+
+            if (srcFrameLen <= 0 || nbrFrames <= 0)
+                return false;
+            const long srcFrames = wav.getNbrSamples() / srcFrameLen;
+            if (srcFrames <= 0)
+                return false;
+
+            std::atomic<bool> cancelled{ false };
+            JobPool::instance().parallelFor(nbrFrames, [&](int begin, int end)
+            {
+                GW5_TRACE_SCOPE("WavetableImport::frames");
+
+                Resampler rs(srcFrameLen, frameSize);
+                std::vector<float> src(srcFrameLen), tmp(frameSize);
+
+                for (int j = begin; j < end; ++j)
+                {
+                    if (job.isCancelled())
+                    {
+                        cancelled.store(true, std::memory_order_relaxed);
+                        return;
+                    }
+
+                    const double pos = (nbrFrames > 1) ? double(j) * double(srcFrames - 1) / double(nbrFrames - 1) : 0.0;
+                    const long   i0 = std::min(long(pos), srcFrames - 1);
+                    const float  t = float(pos - double(i0));
+                    float*       out = dst + long(j) * frameSize;
+
+                    wav.readMono(i0 * srcFrameLen, srcFrameLen, src.data());
+                    rs.process(src.data(), out);
+
+                    if (t > 1e-6f && i0 + 1 < srcFrames)
+                    {
+                        wav.readMono((i0 + 1) * srcFrameLen, srcFrameLen, src.data());
+                        rs.process(src.data(), tmp.data());
+                        for (int i = 0; i < frameSize; ++i)
+                            out[i] += (tmp[i] - out[i]) * t;
+                    }
+                }
+            }, FRAMES_PER_CHUNK);
+
+            return !cancelled.load(std::memory_order_relaxed);
+        }
+
+        /* one period of srcLen samples -> dstLen samples, per-thread state */
+        class Resampler
+        {
+        public:
+            Resampler(int srcLen, int dstLen)
+                : _srcLen(srcLen)
+                , _dstLen(dstLen)
+            {
+                if (srcLen == dstLen)
+                    return;
+
+                if (isPow2(srcLen) && isPow2(dstLen))
+                {
+                    _srcFft.reset(new FftReal(srcLen));
+                    _dstFft.reset(new FftReal(dstLen));
+                    _re.resize(std::max(srcLen, dstLen) / 2 + 1);
+                    _im.resize(_re.size());
+                }
+                else
+                {
+                    buildSincTable();
+                }
+            }
+
+            void process(const float src[], float dst[])
+            {
+                if (_srcLen == _dstLen)
+                    std::memcpy(dst, src, sizeof(float) * _dstLen);
+                else if (_srcFft != nullptr)
+                    spectral(src, dst);
+                else
+                    sinc(src, dst);
+            }
+
+        private:
+            static bool isPow2(int n) noexcept { return n > 0 && (n & (n - 1)) == 0; }
+
+            /* bins below the smaller Nyquist, rescaled to the new length */
+            void spectral(const float src[], float dst[])
+            {
+                _srcFft->forward(src, _re.data(), _im.data());
+
+                const int   keep = std::max(std::min(_srcLen, _dstLen) / 2, 1);
+                const float scale = float(_dstLen) / float(_srcLen);
+                for (int h = 0; h <= _dstLen / 2; ++h)
+                {
+                    _re[h] = (h < keep) ? _re[h] * scale : 0.0f;
+                    _im[h] = (h < keep) ? _im[h] * scale : 0.0f;
+                }
+
+                _dstFft->inverse(_re.data(), _im.data(), dst);
+            }
+
+            /* Lanczos kernel, cut-off lowered when shrinking, wraps around.
+               The weights only depend on the two lengths, so they are computed
+               once and every frame is a plain FIR pass. */
+            void buildSincTable()
+            {
+                const double ratio = double(_srcLen) / double(_dstLen);
+                const double cut = std::min(1.0, 1.0 / ratio);
+                const int    half = int(std::ceil(SINC_ZEROS / cut));
+
+                _taps = 2 * half;
+                _sincIdx.resize(size_t(_dstLen) * _taps);
+                _sincW.resize(size_t(_dstLen) * _taps);
+
+                for (int i = 0; i < _dstLen; ++i)
+                {
+                    const double x = double(i) * ratio;
+                    const long   base = long(std::floor(x));
+                    int*   idx = &_sincIdx[size_t(i) * _taps];
+                    float* w = &_sincW[size_t(i) * _taps];
+
+                    double wsum = 0.0;
+                    for (int t = 0; t < _taps; ++t)
+                    {
+                        const long   k = base - half + 1 + t;
+                        const double arg = (x - double(k)) * cut;
+                        const double v = (std::fabs(arg) < SINC_ZEROS) ? sincPi(arg) * sincPi(arg / SINC_ZEROS) : 0.0;
+                        long wrapped = k % _srcLen;
+                        if (wrapped < 0) wrapped += _srcLen;
+                        idx[t] = int(wrapped);
+                        w[t] = float(v);
+                        wsum += v;
+                    }
+                    if (wsum != 0.0)
+                        for (int t = 0; t < _taps; ++t)
+                            w[t] = float(w[t] / wsum);
+                }
+            }
+
+            void sinc(const float src[], float dst[]) const noexcept
+            {
+                for (int i = 0; i < _dstLen; ++i)
+                {
+                    const int*   idx = &_sincIdx[size_t(i) * _taps];
+                    const float* w = &_sincW[size_t(i) * _taps];
+                    float sum = 0.0f;
+                    for (int t = 0; t < _taps; ++t)
+                        sum += w[t] * src[idx[t]];
+                    dst[i] = sum;
+                }
+            }
+
+            static double sincPi(double x) noexcept
+            {
+                if (std::fabs(x) < 1e-9)
+                    return 1.0;
+                const double px = 3.141592653589793 * x;
+                return std::sin(px) / px;
+            }
+
+            int                      _srcLen;
+            int                      _dstLen;
+            std::unique_ptr<FftReal> _srcFft;
+            std::unique_ptr<FftReal> _dstFft;
+            std::vector<float>       _re;
+            std::vector<float>       _im;
+            int                      _taps = 0;
+            std::vector<int>         _sincIdx;    // [dst sample][tap]
+            std::vector<float>       _sincW;      // [dst sample][tap], normalised
+        };
+    };
+
+} // namespace gw5
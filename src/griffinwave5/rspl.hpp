@@ -2,13 +2,16 @@
 #ifndef RSPL_HPP
 #define RSPL_HPP
 
+#include <climits>
+#include <cmath>
+
 
 
 namespace gw5
 {
 
 // ————————————————————————————————————————————————————————————————————————
-// Fixed‑width integer typedefs
+// Fixed-width integer typedefs
 // ————————————————————————————————————————————————————————————————————————
 #if defined(_MSC_VER)
 
@@ -22,13 +25,13 @@ namespace gw5
     #if   SHRT_MAX  == 0x7FFF
         typedef short int     Int16;
     #else
-        #error No signed 16‑bit integer type defined for this compiler!
+        #error No signed 16-bit integer type defined for this compiler!
     #endif
 
     #if   INT_MAX   == 0x7FFFFFFF
         typedef int          Int32;
     #else
-        #error No signed 32‑bit integer type defined for this compiler!
+        #error No signed 32-bit integer type defined for this compiler!
     #endif
 
     typedef long long        Int64;
@@ -36,7 +39,7 @@ namespace gw5
     #if   UINT_MAX  == 0xFFFFFFFFUL
         typedef unsigned int UInt32;
     #else
-        #error No unsigned 32‑bit integer type defined for this compiler!
+        #error No unsigned 32-bit integer type defined for this compiler!
     #endif
 
 #else
@@ -63,7 +66,7 @@ const float  ANTI_DENORMAL_FLT = 1e-20f;
 
 
 // ————————————————————————————————————————————————————————————————————————
-// 32.32 fixed‐point representation
+// 32.32 fixed-point representation
 // ————————————————————————————————————————————————————————————————————————
 union Fixed3232
 {
@@ -113,14 +116,15 @@ inline long round_long(double x)
 template <typename T>
 T shift_bidi(T x, int s)
 {
+    // Negative values are shifted by magnitude: << and >> are not defined
+    // for them by every standard we build with. Right shifts round down.
     if (s > 0)
     {
-        x <<= s;
+        x = (x >= 0) ? T(x << s) : T(-((-x) << s));
     }
     else if (s < 0)
     {
-        assert(x >= 0);  // >> has undefined behavior for x < 0
-        x >>= -s;
+        x = (x >= 0) ? T(x >> -s) : T(~((~x) >> -s));
     }
     return x;
 }
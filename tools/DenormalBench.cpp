@@ -0,0 +1,132 @@
+// DenormalBench.cpp   (decaying-tail benchmark for the FTZ/DAZ guard)
+//
+// Plays a decaying sine into silence on a bank of resampler voices, in
+// fixed blocks, and times every block. Once the table has run out the
+// half-band downsampler states decay towards zero and go denormal, which
+// is where an unguarded render slows down. Reports the head (first blocks,
+// signal present) and the tail (last blocks, denormal range) per block,
+// without and with gw5::ScopedNoDenormals, on the 2x (downsampled) and the
+// 1x path.
+//
+// Usage:
+//   DenormalBench [--voices 32] [--block 64] [--blocks 4000]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "../src/griffinwave5/Denormals.h"
+#include "../src/griffinwave5/InterpPack.h"
+#include "../src/griffinwave5/MipMapFlt.hpp"
+#include "../src/griffinwave5/ResamplerFlt.h"
+
+namespace
+{
+    constexpr long TableLen = 1 << 20;
+    constexpr long DecayLen = 4096;         // sine length, silence after it
+    constexpr int  MipLevels = 12;
+    constexpr int  HeadBlocks = 60;
+    constexpr int  TailBlocks = 1000;
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        int voices = 32;
+        int block = 64;
+        int blocks = 4000;
+    };
+
+    Options parseArgs(int argc, char* argv[])
+    {
+        Options o;
+        for (int i = 1; i + 1 < argc; i += 2)
+        {
+            const double v = std::atof(argv[i + 1]);
+            if      (!std::strcmp(argv[i], "--voices")) o.voices = std::max(1, int(v));
+            else if (!std::strcmp(argv[i], "--block"))  o.block = std::max(1, int(v));
+            else if (!std::strcmp(argv[i], "--blocks")) o.blocks = std::max(HeadBlocks + TailBlocks, int(v));
+            else std::fprintf(stderr, "unknown option %s\n", argv[i]);
+        }
+        return o;
+    }
+
+    struct Result
+    {
+        double head = 0.0;      // us per block
+        double tail = 0.0;
+        double tailMax = 0.0;
+    };
+
+    /* pitch 0 plays at the table rate through the 2x path; a negative
+       pitch (an octave and more down) takes the 1x path */
+    Result run(const Options& o, const std::shared_ptr<gw5::MipMapFlt>& mip, long pitch, bool guard)
+    {
+        gw5::InterpPack interp;
+        std::vector<std::unique_ptr<gw5::ResamplerFlt>> voices;
+        for (int v = 0; v < o.voices; ++v)
+        {
+            voices.emplace_back(new gw5::ResamplerFlt);
+            auto& r = *voices.back();
+            r.set_interp(interp);
+            r.set_sample_sp(mip);
+            r.set_pitch(pitch);
+            r.set_playback_pos(0);
+        }
+
+        std::unique_ptr<gw5::ScopedNoDenormals> noDenormals;
+        if (guard)
+            noDenormals.reset(new gw5::ScopedNoDenormals);
+
+        std::vector<float> buf(size_t(o.block));
+        Result res;
+        for (int b = 0; b < o.blocks; ++b)
+        {
+            const auto t0 = Clock::now();
+            for (auto& r : voices)
+                r->interpolate_block(buf.data(), o.block);
+            const double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+
+            if (b < HeadBlocks)
+                res.head += us;
+            else if (b >= o.blocks - TailBlocks)
+            {
+                res.tail += us;
+                res.tailMax = std::max(res.tailMax, us);
+            }
+        }
+        res.head /= HeadBlocks;
+        res.tail /= TailBlocks;
+        return res;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const Options opt = parseArgs(argc, argv);
+
+    std::vector<float> table(TableLen, 0.0f);
+    for (long i = 0; i < DecayLen; ++i)
+        table[i] = float(std::sin(double(i) * 0.05) * (1.0 - double(i) / double(DecayLen)));
+
+    auto mip = std::make_shared<gw5::MipMapFlt>();
+    mip->init_sample(TableLen, gw5::InterpPack::get_len_pre(), gw5::InterpPack::get_len_post(),
+        MipLevels, gw5::ResamplerFlt::_fir_mip_map_coef_arr, gw5::ResamplerFlt::MIP_MAP_FIR_LEN);
+    mip->fill_sample(table.data(), TableLen);
+
+    std::printf("%d voices, %d-sample blocks, %d blocks; us per block\n", opt.voices, opt.block, opt.blocks);
+    std::printf("path  guard   head    tail  tail max\n");
+    for (const long pitch : { 0L, -20000L })
+        for (const bool guard : { false, true })
+        {
+            const Result r = run(opt, mip, pitch, guard);
+            std::printf("%s    %-4s %6.1f  %6.1f  %8.1f\n", pitch == 0 ? "2x" : "1x",
+                guard ? "on" : "off", r.head, r.tail, r.tailMax);
+        }
+    return 0;
+}
@@ -0,0 +1,656 @@
+// OfflineRender.cpp   (headless MIDI -> WAV renderer for Griffin_WT tables)
+//
+// Loads a wavetable (WAV, or raw 32-bit float frames of 2048 samples) and a
+// Standard MIDI File, renders every note through the gw5 voice path the
+// Griffin_WT node uses (same table layout, pitch mapping, start phase and
+// per-slice frame wrap) and writes a stereo WAV. Notes are rendered in
+// parallel on the JobPool, each into its own buffer, and summed in note
+// order so the output doesn't depend on the thread count.
+//
+// Griffin_WT itself needs the HISE host; the node's amplitude envelope lives
+// downstream of it, so each note gets a linear attack/release here, scaled
+// by its velocity.
+//
+// Only the first oscillator on one fixed frame is rendered. Not rendered:
+// the second oscillator, hard sync, FM, the filter, glide and the crossfades
+// of frame changes, so the output is not the node's for patches using them.
+//
+// Usage:
+//   OfflineRender --table in.wav --midi in.mid --out out.wav
+//                 [--sr 48000] [--frame 0] [--frame-len 0] [--semi -12]
+//                 [--volume 0.8] [--attack 2] [--release 50] [--bits 24]
+//                 [--threads 0] [--low-latency 0] [--seed 1] [--isa avx2]
+//
+// --frame-len 0 takes the WAV's 'clm ' frame length, else 2048. --threads 0
+// uses every core. --bits 16, 24 or 32 (float). --isa forces a kernel
+// variant (generic, avx2, avx512) the CPU supports. The summary line gives the
+// render throughput, so the tool doubles as a voice benchmark.
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/griffinwave5/CpuFeatures.h"
+#include "../src/griffinwave5/Denormals.h"
+#include "../src/griffinwave5/InterpPack.h"
+#include "../src/griffinwave5/MipMapFlt.hpp"
+#include "../src/griffinwave5/ResamplerFlt.h"
+#include "../src/griffinwave5/JobPool.h"
+#include "../src/griffinwave5/MappedFile.h"
+#include "../src/griffinwave5/TableBlend.h"
+#include "../src/griffinwave5/WavReader.h"
+#include "../src/griffinwave5/WavetableImport.h"
+
+namespace
+{
+    // table layout and pitch mapping of Griffin_WT
+    constexpr int    FrameSize = 2048;
+    constexpr int    MaxFrames = 256;
+    constexpr int    MaxSamples = FrameSize * MaxFrames;
+    constexpr int    TripledFrame = FrameSize * 3;
+    constexpr int    TripledSamples = MaxSamples * 3;
+    constexpr int    MipLevels = 12;
+    constexpr int    Slice = 8;
+    constexpr int    BitsOct = gw5::BaseVoiceState::NBR_BITS_PER_OCT;
+    constexpr double TargetRootHz = 32.703195;
+    constexpr double Semi2Bits = double(1 << BitsOct) / 12.0;
+
+    constexpr int    NotesPerBatch = 256;      // bounds the per-note buffers held at once
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        std::string table;
+        std::string midi;
+        std::string out;
+        double sr = 48000.0;
+        int    frame = 0;
+        int    frameLen = 0;
+        double semi = -12.0;
+        double volume = 0.8;
+        double attackMs = 2.0;
+        double releaseMs = 50.0;
+        int    bits = 24;
+        int    threads = 0;
+        bool   lowLatency = false;
+        int    seed = 1;
+        std::string isa;
+    };
+
+    bool parseArgs(int argc, char* argv[], Options& o)
+    {
+        for (int i = 1; i + 1 < argc; i += 2)
+        {
+            const char* k = argv[i];
+            const char* v = argv[i + 1];
+            const double x = std::atof(v);
+            if      (!std::strcmp(k, "--table"))       o.table = v;
+            else if (!std::strcmp(k, "--midi"))        o.midi = v;
+            else if (!std::strcmp(k, "--out"))         o.out = v;
+            else if (!std::strcmp(k, "--sr"))          o.sr = std::max(8000.0, x);
+            else if (!std::strcmp(k, "--frame"))       o.frame = std::clamp(int(x), 0, MaxFrames - 1);
+            else if (!std::strcmp(k, "--frame-len"))   o.frameLen = std::max(0, int(x));
+            else if (!std::strcmp(k, "--semi"))        o.semi = x;
+            else if (!std::strcmp(k, "--volume"))      o.volume = x;
+            else if (!std::strcmp(k, "--attack"))      o.attackMs = std::max(0.0, x);
+            else if (!std::strcmp(k, "--release"))     o.releaseMs = std::max(0.0, x);
+            else if (!std::strcmp(k, "--bits"))        o.bits = int(x);
+            else if (!std::strcmp(k, "--threads"))     o.threads = std::max(0, int(x));
+            else if (!std::strcmp(k, "--low-latency")) o.lowLatency = (x != 0.0);
+            else if (!std::strcmp(k, "--seed"))        o.seed = int(x);
+            else if (!std::strcmp(k, "--isa"))         o.isa = v;
+            else std::fprintf(stderr, "unknown option %s\n", k);
+        }
+
+        if (o.table.empty() || o.midi.empty() || o.out.empty())
+        {
+            std::fprintf(stderr, "usage: OfflineRender --table in.wav --midi in.mid --out out.wav [options]\n"
+                "renders oscillator 1 on one frame only: no osc 2, sync, FM, filter, glide\n"
+                "or frame crossfades\n");
+            return false;
+        }
+        if (o.bits != 16 && o.bits != 24 && o.bits != 32)
+        {
+            std::fprintf(stderr, "--bits must be 16, 24 or 32\n");
+            return false;
+        }
+        if (!o.isa.empty())
+        {
+            gw5::CpuFeatures::Isa isa;
+            if (!gw5::CpuFeatures::parse(o.isa.c_str(), isa))
+            {
+                std::fprintf(stderr, "--isa must be generic, avx2 or avx512\n");
+                return false;
+            }
+            gw5::CpuFeatures::force(isa);
+        }
+        return true;
+    }
+
+    /* ---------------------------------------------------------------------- */
+    /*  TABLE                                                                  */
+    /* ---------------------------------------------------------------------- */
+
+    bool loadWavTable(const gw5::WavReader& wav, int frameLen, std::vector<float>& table)
+    {
+        if (frameLen <= 0)
+            frameLen = (wav.getFrameLength() > 0) ? wav.getFrameLength() : FrameSize;
+
+        // convert() takes a pool job for cancellation; run it as one
+        std::promise<bool> done;
+        auto result = done.get_future();
+        gw5::JobPool::instance().submit([&](const gw5::JobPool::Job& job)
+        {
+            done.set_value(gw5::WavetableImport::convert(wav, frameLen, table.data(), FrameSize, MaxFrames, job));
+        }, gw5::JobPool::Priority_HIGH);
+
+        if (!result.get())
+        {
+            std::fprintf(stderr, "table is shorter than one frame of %d\n", frameLen);
+            return false;
+        }
+        return true;
+    }
+
+    /* raw float32 frames of FrameSize, spread over MaxFrames like an import */
+    bool loadRawTable(const uint8_t* data, size_t size, std::vector<float>& table)
+    {
+        const long srcFrames = long(size / (sizeof(float) * FrameSize));
+        if (srcFrames <= 0)
+        {
+            std::fprintf(stderr, "raw table is shorter than one frame of %d floats\n", FrameSize);
+            return false;
+        }
+
+        std::vector<float> src(size_t(srcFrames) * FrameSize);
+        std::memcpy(src.data(), data, src.size() * sizeof(float));
+
+        for (int j = 0; j < MaxFrames; ++j)
+        {
+            const double pos = (MaxFrames > 1) ? double(j) * double(srcFrames - 1) / double(MaxFrames - 1) : 0.0;
+            const long   i0 = std::min(long(pos), srcFrames - 1);
+            const long   i1 = std::min(i0 + 1, srcFrames - 1);
+            const float  t = float(pos - double(i0));
+            const float* a = src.data() + i0 * FrameSize;
+            const float* b = src.data() + i1 * FrameSize;
+            float*       dst = table.data() + long(j) * FrameSize;
+            for (int i = 0; i < FrameSize; ++i)
+                dst[i] = a[i] + (b[i] - a[i]) * t;
+        }
+        return true;
+    }
+
+    bool loadTable(const Options& o, std::vector<float>& table)
+    {
+        gw5::MappedFile file;
+        if (!file.open(o.table.c_str()))
+        {
+            std::fprintf(stderr, "can't open table %s\n", o.table.c_str());
+            return false;
+        }
+
+        gw5::WavReader wav;
+        if (wav.parse(file.data(), file.size()))
+            return loadWavTable(wav, o.frameLen, table);
+        return loadRawTable(file.data(), file.size(), table);
+    }
+
+    std::shared_ptr<const gw5::MipMapFlt> buildMip(const std::vector<float>& table, gw5::InterpPack::KernelSet set)
+    {
+        std::vector<float> tripled(TripledSamples);
+        gw5::TableBlend::Input in;
+        in.data = table.data();
+        in.gain = 1.0f;
+        gw5::TableBlend::blendTripled(tripled.data(), &in, 1, FrameSize, MaxFrames);
+
+        auto mp = std::make_shared<gw5::MipMapFlt>();
+        mp->init_sample(TripledSamples,
+            gw5::InterpPack::get_len_pre(set),
+            gw5::InterpPack::get_len_post(set),
+            MipLevels,
+            gw5::ResamplerFlt::_fir_mip_map_coef_arr,
+            gw5::ResamplerFlt::MIP_MAP_FIR_LEN);
+        mp->fill_sample(tripled.data(), TripledSamples);
+        return mp;
+    }
+
+    /* ---------------------------------------------------------------------- */
+    /*  MIDI                                                                   */
+    /* ---------------------------------------------------------------------- */
+
+    struct Note
+    {
+        double on = 0.0;        // seconds
+        double off = 0.0;
+        int    key = 60;
+        float  vel = 1.0f;
+    };
+
+    class MidiReader
+    {
+    public:
+        /* Standard MIDI File, format 0 or 1; tempo map applied to every track */
+        bool read(const uint8_t* d, size_t size, std::vector<Note>& notes)
+        {
+            _d = d;
+            _size = size;
+            _pos = 0;
+
+            if (!expect("MThd") || u32() != 6)
+                return fail("not a standard MIDI file");
+            u16();                                  // format, every track is merged
+            const int nbrTracks = u16();
+            const int division = u16();
+            if (!_ok || division == 0)
+                return fail("bad MIDI header");
+
+            for (int t = 0; t < nbrTracks && _pos + 8 <= _size; ++t)
+            {
+                if (!expect("MTrk"))
+                    return fail("bad MIDI track header");
+                const size_t len = u32();
+                const size_t end = std::min(_size, _pos + len);
+                if (!readTrack(end))
+                    return fail("truncated MIDI track");
+                _pos = end;
+            }
+
+            std::stable_sort(_events.begin(), _events.end(),
+                [](const Event& a, const Event& b) { return a.tick < b.tick; });
+            std::stable_sort(_tempos.begin(), _tempos.end(),
+                [](const Tempo& a, const Tempo& b) { return a.tick < b.tick; });
+
+            // note-offs close the oldest open note of the same channel and key
+            std::map<int, std::vector<size_t>> open;
+            double last = 0.0;
+            for (const Event& e : _events)
+            {
+                const double t = seconds(e.tick, division);
+                last = std::max(last, t);
+                const int id = e.chn * 128 + e.key;
+                if (e.on)
+                {
+                    open[id].push_back(notes.size());
+                    notes.push_back(Note{ t, t, e.key, float(e.vel) / 127.0f });
+                }
+                else if (!open[id].empty())
+                {
+                    notes[open[id].front()].off = t;
+                    open[id].erase(open[id].begin());
+                }
+            }
+            for (auto& o : open)
+                for (size_t i : o.second)
+                    notes[i].off = last;
+
+            return true;
+        }
+
+    private:
+        struct Event { uint64_t tick; int chn, key, vel; bool on; };
+        struct Tempo { uint64_t tick; double usPerQn; };
+
+        bool expect(const char* tag)
+        {
+            if (_pos + 4 > _size)
+                return _ok = false;
+            const bool match = std::memcmp(_d + _pos, tag, 4) == 0;
+            _pos += 4;
+            return match;
+        }
+
+        int u8()
+        {
+            if (_pos >= _size) { _ok = false; return 0; }
+            return _d[_pos++];
+        }
+
+        int u16() { const int a = u8(); return (a << 8) | u8(); }
+        size_t u32() { const size_t a = size_t(u16()); return (a << 16) | size_t(u16()); }
+
+        uint32_t vlq()
+        {
+            uint32_t v = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                const int b = u8();
+                v = (v << 7) | uint32_t(b & 0x7F);
+                if ((b & 0x80) == 0)
+                    break;
+            }
+            return v;
+        }
+
+        bool readTrack(size_t end)
+        {
+            uint64_t tick = 0;
+            int status = 0;
+            while (_pos < end && _ok)
+            {
+                tick += vlq();
+                int b = u8();
+                if (b & 0x80)
+                    status = b;
+                else if (status != 0)
+                    --_pos;                         // running status
+                else
+                    return false;
+
+                if (status == 0xFF)
+                {
+                    const int type = u8();
+                    const uint32_t len = vlq();
+                    if (_pos + len > end)
+                        return false;
+                    if (type == 0x51 && len == 3)
+                        _tempos.push_back(Tempo{ tick, double((_d[_pos] << 16) | (_d[_pos + 1] << 8) | _d[_pos + 2]) });
+                    _pos += len;
+                    status = 0;
+                    if (type == 0x2F)
+                        break;
+                }
+                else if (status == 0xF0 || status == 0xF7)
+                {
+                    const uint32_t len = vlq();
+                    if (_pos + len > end)
+                        return false;
+                    _pos += len;
+                    status = 0;
+                }
+                else
+                {
+                    const int kind = status & 0xF0;
+                    const int d0 = u8();
+                    const int d1 = (kind == 0xC0 || kind == 0xD0) ? 0 : u8();
+                    if (kind == 0x90 && d1 > 0)
+                        _events.push_back(Event{ tick, status & 0x0F, d0 & 0x7F, d1 & 0x7F, true });
+                    else if (kind == 0x80 || kind == 0x90)
+                        _events.push_back(Event{ tick, status & 0x0F, d0 & 0x7F, 0, false });
+                }
+            }
+            return _ok;
+        }
+
+        /* tick -> seconds through the tempo map (SMPTE divisions have none) */
+        double seconds(uint64_t tick, int division) const
+        {
+            if (division & 0x8000)
+            {
+                const int fps = -int(int8_t(division >> 8));
+                const int tpf = division & 0xFF;
+                return double(tick) / double(std::max(1, fps * tpf));
+            }
+
+            double   t = 0.0;
+            double   usPerQn = 500000.0;
+            uint64_t from = 0;
+            for (const Tempo& tp : _tempos)
+            {
+                if (tp.tick >= tick)
+                    break;
+                t += double(tp.tick - from) * usPerQn;
+                from = tp.tick;
+                usPerQn = tp.usPerQn;
+            }
+            t += double(tick - from) * usPerQn;
+            return t * 1e-6 / double(division);
+        }
+
+        bool fail(const char* msg)
+        {
+            std::fprintf(stderr, "%s\n", msg);
+            return false;
+        }
+
+        const uint8_t*     _d = nullptr;
+        size_t             _size = 0;
+        size_t             _pos = 0;
+        bool               _ok = true;
+        std::vector<Event> _events;
+        std::vector<Tempo> _tempos;
+    };
+
+    /* ---------------------------------------------------------------------- */
+    /*  RENDER                                                                 */
+    /* ---------------------------------------------------------------------- */
+
+    struct Setup
+    {
+        std::shared_ptr<const gw5::MipMapFlt> mip;
+        const gw5::InterpPack* interp = nullptr;
+        double     sr = 48000.0;
+        double     rootOffSemis = 0.0;
+        double     semi = 0.0;
+        float      volume = 1.0f;
+        long       attack = 0;              // samples
+        long       release = 0;
+        gw5::Int64 frameStart = FrameSize;
+        int        maxBits = 0;
+        int        seed = 1;
+    };
+
+    long noteLength(const Note& n, const Setup& s)
+    {
+        return std::max(1L, long(std::ceil((n.off - n.on) * s.sr)) + s.release);
+    }
+
+    /* one note, from its start to the end of its release, into out[] */
+    void renderNote(const Note& n, int idx, const Setup& s, gw5::ResamplerFlt& res, float out[], long len)
+    {
+        GW5_TRACE_SCOPE("OfflineRender::note");
+
+        const double sem = s.rootOffSemis + s.semi + double(n.key - 24);
+        const int bits = std::min(int(std::lround(sem * Semi2Bits)), s.maxBits);
+
+        // random start phase, as the node picks it, from a per-note seed
+        std::mt19937 rng(uint32_t(idx) * 2654435761u + uint32_t(s.seed));
+        const uint32_t   rand32 = rng();
+        const float      noteFrac = float(n.key) / 127.0f;
+        const float      phase = 17.0f + noteFrac * (60.0f - 17.0f);
+        const gw5::Int64 maxR = std::max<gw5::Int64>(1, (FrameSize * gw5::Int64(phase)) / 100);
+        gw5::Int64 pos = ((s.frameStart + gw5::Int64(rand32) % maxR) << 32) | gw5::Int64(rand32);
+
+        res.set_sample_sp(s.mip);
+        res.clear_buffers();
+        res.set_pitch(bits);
+
+        for (long base = 0; base < len; base += Slice)
+        {
+            const long n2 = std::min<long>(Slice, len - base);
+            const gw5::Int64 ip = pos >> 32;
+            pos = ((((ip - s.frameStart) & (FrameSize - 1)) + s.frameStart) << 32) | (pos & 0xffffffff);
+            res.set_playback_pos(pos);
+            res.interpolate_block(out + base, n2);
+            pos = res.get_playback_pos();
+        }
+
+        // stand-in for the envelope after the node
+        const long  held = len - s.release;
+        const float g = s.volume * n.vel;
+        for (long i = 0; i < len; ++i)
+        {
+            float e = 1.0f;
+            if (i < s.attack)
+                e = float(i) / float(s.attack);
+            if (i >= held && s.release > 0)
+                e *= float(len - i) / float(s.release);
+            out[i] *= g * e;
+        }
+    }
+
+    /* ---------------------------------------------------------------------- */
+    /*  WAV OUT                                                                */
+    /* ---------------------------------------------------------------------- */
+
+    void put(std::vector<uint8_t>& b, uint32_t v, int bytes)
+    {
+        for (int i = 0; i < bytes; ++i)
+            b.push_back(uint8_t(v >> (8 * i)));
+    }
+
+    /* mono buffer, written to both channels like the node does */
+    bool writeWav(const char* path, const std::vector<float>& x, int sr, int bits)
+    {
+        const int      chn = 2;
+        const int      bps = bits / 8;
+        const uint32_t dataBytes = uint32_t(x.size() * chn * bps);
+
+        std::vector<uint8_t> b;
+        b.reserve(44 + dataBytes);
+        b.insert(b.end(), { 'R', 'I', 'F', 'F' });
+        put(b, 36 + dataBytes, 4);
+        b.insert(b.end(), { 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ' });
+        put(b, 16, 4);
+        put(b, bits == 32 ? 3 : 1, 2);
+        put(b, chn, 2);
+        put(b, uint32_t(sr), 4);
+        put(b, uint32_t(sr * chn * bps), 4);
+        put(b, chn * bps, 2);
+        put(b, bits, 2);
+        b.insert(b.end(), { 'd', 'a', 't', 'a' });
+        put(b, dataBytes, 4);
+
+        const double scale = double((1 << (bits - 1)) - 1);
+        for (float v : x)
+        {
+            uint32_t w;
+            if (bits == 32)
+                std::memcpy(&w, &v, 4);
+            else
+                w = uint32_t(int32_t(std::lround(std::clamp(double(v), -1.0, 1.0) * scale)));
+            for (int c = 0; c < chn; ++c)
+                put(b, w, bps);
+        }
+
+        FILE* f = std::fopen(path, "wb");
+        if (f == nullptr)
+            return false;
+        const bool ok = std::fwrite(b.data(), 1, b.size(), f) == b.size();
+        return (std::fclose(f) == 0) && ok;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    if (!parseArgs(argc, argv, opt))
+        return 1;
+
+    const int cores = std::max(1, int(std::thread::hardware_concurrency()));
+    const int threads = (opt.threads > 0) ? opt.threads : cores;
+    gw5::JobPool::instance().setMaxWorkers(std::max(1, threads - 1));   // the caller renders too
+
+    const auto t0 = Clock::now();
+
+    std::vector<float> table(MaxSamples);
+    if (!loadTable(opt, table))
+        return 1;
+
+    std::vector<Note> notes;
+    {
+        gw5::MappedFile file;
+        MidiReader midi;
+        if (!file.open(opt.midi.c_str()))
+        {
+            std::fprintf(stderr, "can't open MIDI file %s\n", opt.midi.c_str());
+            return 1;
+        }
+        if (!midi.read(file.data(), file.size(), notes))
+            return 1;
+    }
+
+    const auto set = opt.lowLatency ? gw5::InterpPack::KernelSet_SHORT : gw5::InterpPack::KernelSet_LINEAR;
+    gw5::InterpPack interp;
+    interp.set_kernel_set(set);
+
+    Setup s;
+    s.mip = buildMip(table, set);
+    s.interp = &interp;
+    s.sr = opt.sr;
+    s.rootOffSemis = 12.0 * std::log2(TargetRootHz / (opt.sr / double(FrameSize)));
+    s.semi = opt.semi;
+    s.volume = float(opt.volume);
+    s.attack = long(opt.attackMs * 0.001 * opt.sr);
+    s.release = long(opt.releaseMs * 0.001 * opt.sr);
+    s.frameStart = gw5::Int64(opt.frame) * TripledFrame + FrameSize;
+    s.maxBits = (s.mip->get_nbr_tables() << BitsOct) - 1;
+    s.seed = opt.seed;
+
+    long total = 0;
+    for (const Note& n : notes)
+        total = std::max(total, long(n.on * opt.sr) + noteLength(n, s));
+    std::vector<float> mix(size_t(total), 0.0f);
+
+    const auto t1 = Clock::now();
+
+    // batches of notes: rendered in parallel, summed in note order
+    std::vector<std::vector<float>> bufs(NotesPerBatch);
+    std::atomic<long long> voiceSpl{ 0 };
+    for (int first = 0; first < int(notes.size()); first += NotesPerBatch)
+    {
+        const int count = std::min(NotesPerBatch, int(notes.size()) - first);
+
+        gw5::JobPool::instance().parallelFor(count, [&](int begin, int end)
+        {
+            gw5::ScopedNoDenormals noDenormals;
+            gw5::ResamplerFlt res;
+            res.set_interp(*s.interp);
+            for (int j = begin; j < end; ++j)
+            {
+                const Note& n = notes[size_t(first + j)];
+                const long len = noteLength(n, s);
+                bufs[size_t(j)].assign(size_t(len), 0.0f);
+                renderNote(n, first + j, s, res, bufs[size_t(j)].data(), len);
+                voiceSpl.fetch_add(len, std::memory_order_relaxed);
+            }
+        });
+
+        for (int j = 0; j < count; ++j)
+        {
+            const long at = long(notes[size_t(first + j)].on * opt.sr);
+            const std::vector<float>& b = bufs[size_t(j)];
+            const long n = std::min(long(b.size()), total - at);
+            for (long i = 0; i < n; ++i)
+                mix[size_t(at + i)] += b[size_t(i)];
+        }
+    }
+
+    const auto t2 = Clock::now();
+
+    if (!writeWav(opt.out.c_str(), mix, int(std::lround(opt.sr)), opt.bits))
+    {
+        std::fprintf(stderr, "can't write %s\n", opt.out.c_str());
+        return 1;
+    }
+
+    const double setupSec = std::chrono::duration<double>(t1 - t0).count();
+    const double renderSec = std::chrono::duration<double>(t2 - t1).count();
+    const double audioSec = double(total) / opt.sr;
+    std::printf("notes           %zu\n", notes.size());
+    std::printf("audio           %.2f s @ %.0f Hz, %d bit\n", audioSec, opt.sr, opt.bits);
+    std::printf("threads         %d\n", threads);
+    std::printf("kernels         %s (cpu: %s)\n",
+        gw5::CpuFeatures::getName(gw5::CpuFeatures::getActive()),
+        gw5::CpuFeatures::getName(gw5::CpuFeatures::getDetected()));
+    std::printf("setup           %.3f s (table, MIP-map, MIDI)\n", setupSec);
+    std::printf("render          %.3f s, %.1fx realtime, %.2f M voice samples / s\n",
+        renderSec, renderSec > 0.0 ? audioSec / renderSec : 0.0,
+        renderSec > 0.0 ? double(voiceSpl.load()) / renderSec * 1e-6 : 0.0);
+
+    return 0;
+}
@@ -0,0 +1,233 @@
+// TablePipelineBench.cpp   (headless load generator for the table rebuild pipeline)
+//
+// Drives the Griffin_WaveMaker blend path and AsyncMipBuilder with synthetic
+// Mix sweeps and table loads while a simulated audio thread polls current()
+// once per block. Reports builds/second, superseded commits and the
+// knob-move-to-audible latency distribution.
+//
+// Usage:
+//   TablePipelineBench [--seconds 10] [--knob-rate 30] [--load-rate 0.5]
+//                      [--block 64] [--sr 48000]
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../src/griffinwave5/InterpPack.h"
+#include "../src/griffinwave5/MipMapFlt.hpp"
+#include "../src/griffinwave5/ResamplerFlt.h"
+#include "../src/griffinwave5/AsyncMipBuilder.h"
+#include "../src/griffinwave5/TableBlend.h"
+
+namespace
+{
+    constexpr int FrameSize = 2048;
+    constexpr int MaxFrames = 256;
+    constexpr int MaxSamples = FrameSize * MaxFrames;
+    constexpr int TripledSamples = MaxSamples * 3;
+    constexpr int MipLevels = 12;
+    constexpr int MaxGenerations = 1 << 20;
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        double seconds = 10.0;
+        double knobRate = 30.0;     // Mix changes per second
+        double loadRate = 0.5;      // table loads per second, 0 = never
+        int    block = 64;
+        double sr = 48000.0;
+    };
+
+    Options parseArgs(int argc, char* argv[])
+    {
+        Options o;
+        for (int i = 1; i + 1 < argc; i += 2)
+        {
+            const double v = std::atof(argv[i + 1]);
+            if      (!std::strcmp(argv[i], "--seconds"))   o.seconds = v;
+            else if (!std::strcmp(argv[i], "--knob-rate")) o.knobRate = v;
+            else if (!std::strcmp(argv[i], "--load-rate")) o.loadRate = v;
+            else if (!std::strcmp(argv[i], "--block"))     o.block = std::max(1, int(v));
+            else if (!std::strcmp(argv[i], "--sr"))        o.sr = v;
+            else std::fprintf(stderr, "unknown option %s\n", argv[i]);
+        }
+        return o;
+    }
+
+    int64_t nowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now().time_since_epoch()).count();
+    }
+
+    /* random harmonic content per frame, like a user table */
+    void makeTable(std::vector<float>& t, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> amp(0.0f, 1.0f);
+        const double twoPi = 6.283185307179586;
+        for (int f = 0; f < MaxFrames; ++f)
+        {
+            float a[8];
+            for (float& x : a) x = amp(rng) / 8.0f;
+            float* dst = t.data() + f * FrameSize;
+            for (int i = 0; i < FrameSize; ++i)
+            {
+                float s = 0.0f;
+                for (int h = 0; h < 8; ++h)
+                    s += a[h] * float(std::sin(twoPi * (h + 1) * i / FrameSize));
+                dst[i] = s;
+            }
+        }
+    }
+
+    double percentile(std::vector<double>& v, double p)
+    {
+        if (v.empty()) return 0.0;
+        const size_t idx = std::min(v.size() - 1, size_t(p * double(v.size() - 1) + 0.5));
+        std::nth_element(v.begin(), v.begin() + idx, v.end());
+        return v[idx];
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const Options opt = parseArgs(argc, argv);
+
+    auto& builder = gw5::AsyncMipBuilder::instance();
+    builder.configure(TripledSamples, MipLevels);
+
+    std::vector<float> in0(MaxSamples), in1(MaxSamples);
+    std::mt19937 rng(1234);
+    makeTable(in0, rng);
+    makeTable(in1, rng);
+
+    // knob-move time of every generation, written before the commit
+    std::unique_ptr<std::atomic<int64_t>[]> moveNs(new std::atomic<int64_t>[MaxGenerations]);
+
+    std::atomic<bool> running{ true };
+    const uint64_t genStart = builder.getCommitGeneration();
+    const uint64_t buildStart = builder.getBuildCount();
+    long loads = 0;
+
+    /* --- producer: the WaveMaker worker ----------------------------------- */
+    std::thread producer([&]
+    {
+        const auto t0 = Clock::now();
+        const auto knobPeriod = std::chrono::duration<double>(1.0 / std::max(opt.knobRate, 1e-3));
+        const double loadPeriod = opt.loadRate > 0.0 ? 1.0 / opt.loadRate : 1e30;
+        double nextLoad = loadPeriod;
+        auto next = t0;
+
+        while (running.load())
+        {
+            std::this_thread::sleep_until(next);
+            next += std::chrono::duration_cast<Clock::duration>(knobPeriod);
+
+            const double t = std::chrono::duration<double>(Clock::now() - t0).count();
+            if (t >= nextLoad)
+            {
+                makeTable((loads & 1) ? in1 : in0, rng);
+                ++loads;
+                nextLoad += loadPeriod;
+            }
+
+            // triangle sweep, 2 s period
+            const double ph = std::fmod(t, 2.0);
+            const double mix = ph < 1.0 ? ph : 2.0 - ph;
+
+            const uint64_t gen = builder.getCommitGeneration() + 1;
+            if (gen < uint64_t(MaxGenerations))
+                moveNs[gen].store(nowNs(), std::memory_order_relaxed);
+
+            gw5::TableBlend::Input in[2];
+            in[0].data = in0.data();
+            in[1].data = in1.data();
+            gw5::TableBlend::equalPowerGains(mix, true, true, in[0].gain, in[1].gain);
+
+            auto slot = builder.writeSlot();
+            gw5::TableBlend::blendTripled(slot.data(), in, 2, FrameSize, MaxFrames);
+            slot.commit();
+        }
+    });
+
+    /* --- simulated audio thread ------------------------------------------- */
+    std::vector<double> latencyMs;
+    latencyMs.reserve(1 << 16);
+    uint64_t audible = 0;
+    double maxPollUs = 0.0;
+
+    {
+        gw5::JobPool::instance().noteAudioCore();
+
+        const auto blockDur = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(opt.block / opt.sr));
+        const auto end = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(opt.seconds));
+        const gw5::MipMapFlt* last = builder.current().get();
+        auto next = Clock::now();
+
+        while (next < end)
+        {
+            std::this_thread::sleep_until(next);
+            next += blockDur;
+
+            const int64_t p0 = nowNs();
+            auto mp = builder.current();
+            const int64_t p1 = nowNs();
+            maxPollUs = std::max(maxPollUs, double(p1 - p0) * 1e-3);
+
+            if (mp && mp.get() != last)
+            {
+                last = mp.get();
+                const uint64_t gen = builder.getActiveGeneration();
+                if (gen > genStart && gen < uint64_t(MaxGenerations))
+                {
+                    latencyMs.push_back(double(p1 - moveNs[gen].load(std::memory_order_relaxed)) * 1e-6);
+                    ++audible;
+                }
+            }
+        }
+    }
+
+    running.store(false);
+    producer.join();
+
+    const uint64_t commits = builder.getCommitGeneration() - genStart;
+    const uint64_t builds = builder.getBuildCount() - buildStart;
+
+    std::printf("duration        %.2f s, block %d @ %.0f Hz\n", opt.seconds, opt.block, opt.sr);
+    std::printf("knob rate       %.2f Hz, load rate %.2f Hz (%ld loads)\n", opt.knobRate, opt.loadRate, loads);
+    std::printf("commits         %llu\n", (unsigned long long)commits);
+    std::printf("builds          %llu (%.2f / s)\n", (unsigned long long)builds, double(builds) / opt.seconds);
+    std::printf("audible tables  %llu\n", (unsigned long long)audible);
+    std::printf("superseded      %llu commits never became audible\n",
+        (unsigned long long)(commits > audible ? commits - audible : 0));
+    std::printf("max poll        %.2f us\n", maxPollUs);
+
+    if (!latencyMs.empty())
+    {
+        double sum = 0.0;
+        for (double v : latencyMs) sum += v;
+        std::printf("latency ms      mean %.1f  p50 %.1f  p90 %.1f  p99 %.1f  max %.1f\n",
+            sum / double(latencyMs.size()),
+            percentile(latencyMs, 0.50), percentile(latencyMs, 0.90),
+            percentile(latencyMs, 0.99), percentile(latencyMs, 1.00));
+    }
+    else
+    {
+        std::printf("latency ms      no table became audible\n");
+    }
+
+    return 0;
+}